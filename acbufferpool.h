@@ -0,0 +1,439 @@
+#ifndef _AC_HELPERS_WIN32_LIBRARY_BUFFER_POOL_HEADER_
+#define _AC_HELPERS_WIN32_LIBRARY_BUFFER_POOL_HEADER_
+
+#pragma once
+
+#include "accommon.h"
+#include "acmutex.h"
+
+#if AC_PLATFORM_LINUX
+#include <sys/mman.h>
+#endif
+
+#include <algorithm>
+#include <initializer_list>
+
+namespace ac {
+
+    enum class io_buffer_pages {
+        regular,
+        //
+        // Large pages on Windows need SeLockMemoryPrivilege, and huge
+        // pages on Linux need reserved hugetlb pages. If system does
+        // not give them, slab falls back to regular pages. On Linux it
+        // then asks for transparent huge pages.
+        //
+        huge,
+    };
+
+    class io_buffer_pool;
+
+    //
+    // Buffer from io_buffer_pool. Returns itself to the pool on
+    // destruction. Size is the size of the class buffer came from,
+    // and can be larger than requested.
+    //
+    class io_buffer {
+    public:
+        io_buffer() noexcept {
+        }
+
+        io_buffer(io_buffer const &) = delete;
+
+        io_buffer(io_buffer &&other) noexcept {
+            swap(other);
+        }
+
+        ~io_buffer() noexcept {
+            release();
+        }
+
+        io_buffer &operator=(io_buffer const &) = delete;
+
+        io_buffer &operator=(io_buffer &&other) noexcept {
+            if (this != &other) {
+                release();
+                swap(other);
+            }
+            return *this;
+        }
+
+        void swap(io_buffer &other) noexcept {
+            std::swap(pool_, other.pool_);
+            std::swap(data_, other.data_);
+            std::swap(class_index_, other.class_index_);
+        }
+
+        [[nodiscard]] bool is_valid() const noexcept {
+            return nullptr != data_;
+        }
+
+        explicit operator bool() const noexcept {
+            return is_valid();
+        }
+
+        [[nodiscard]] char *data() const noexcept {
+            return data_;
+        }
+
+        [[nodiscard]] size_t size() const noexcept;
+
+        void release() noexcept;
+
+    private:
+        friend class io_buffer_pool;
+
+        io_buffer(io_buffer_pool *pool, char *data, uint32_t class_index) noexcept
+            : pool_{pool}
+            , data_{data}
+            , class_index_{class_index} {
+        }
+
+        io_buffer_pool *pool_{nullptr};
+        char *data_{nullptr};
+        uint32_t class_index_{0};
+    };
+
+    //
+    // Hands out aligned buffers for unbuffered I/O (O_DIRECT and
+    // FILE_FLAG_NO_BUFFERING) in a few fixed size classes.
+    //
+    // Buffers are carved out of large slabs that are faulted in when
+    // they are allocated, so I/O never waits on a page fault. Each
+    // class keeps a cache per processor, and allocate and release
+    // touch only the cache of the current processor until it runs
+    // empty or overflows. Once slabs cover the peak number of
+    // buffers in flight, pool does not allocate memory.
+    //
+    // Pool must outlive all buffers it handed out. Slabs are freed
+    // only when pool is destroyed.
+    //
+    class io_buffer_pool {
+    public:
+        //
+        // Sizes are rounded up to a multiple of alignment. Alignment
+        // 0 means system page, which is a multiple of any sector size.
+        //
+        explicit io_buffer_pool(std::initializer_list<size_t> size_classes,
+                                size_t slab_size = 4 * 1024 * 1024,
+                                io_buffer_pages pages = io_buffer_pages::regular,
+                                size_t alignment = 0)
+            : alignment_{0 == alignment ? system_page_size() : alignment}
+            , slab_size_{slab_size}
+            , pages_{pages} {
+            AC_THROW_IF(0 == size_classes.size() || 0 != (alignment_ & (alignment_ - 1)) ||
+                            alignment_ > system_page_size(),
+                        ERROR_INVALID_PARAMETER,
+                        "io_buffer_pool");
+            std::vector<size_t> sizes;
+            for (size_t size : size_classes) {
+                AC_THROW_IF(0 == size, ERROR_INVALID_PARAMETER, "io_buffer_pool");
+                sizes.push_back((size + alignment_ - 1) & ~(alignment_ - 1));
+            }
+            std::sort(sizes.begin(), sizes.end());
+            sizes.erase(std::unique(sizes.begin(), sizes.end()), sizes.end());
+            for (size_t size : sizes) {
+                classes_.push_back(std::make_unique<size_class>(size));
+            }
+        }
+
+        io_buffer_pool(io_buffer_pool const &) = delete;
+        io_buffer_pool(io_buffer_pool &&) = delete;
+
+        io_buffer_pool &operator=(io_buffer_pool const &) = delete;
+        io_buffer_pool &operator=(io_buffer_pool &&) = delete;
+
+        ~io_buffer_pool() noexcept {
+            for (slab const &s : slabs_) {
+                free_slab(s);
+            }
+        }
+
+        [[nodiscard]] size_t alignment() const noexcept {
+            return alignment_;
+        }
+
+        [[nodiscard]] size_t max_buffer_size() const noexcept {
+            return classes_.back()->size;
+        }
+
+        [[nodiscard]] size_t slabs_count() const noexcept {
+            fast_mutex::guard guard{&slabs_lock_};
+            return slabs_.size();
+        }
+
+        //
+        // True if at least one slab got huge pages
+        //
+        [[nodiscard]] bool has_huge_pages() const noexcept {
+            return huge_pages_used_.load(std::memory_order_relaxed);
+        }
+
+        //
+        // Returns empty buffer if size is larger than largest class,
+        // or if a new slab cannot be allocated
+        //
+        [[nodiscard]] io_buffer try_allocate(size_t size) noexcept {
+            uint32_t const index{find_class(size)};
+            if (classes_.size() == index) {
+                return io_buffer{};
+            }
+            char *const data{pop(*classes_[index])};
+            if (nullptr == data) {
+                return io_buffer{};
+            }
+            return io_buffer{this, data, index};
+        }
+
+        [[nodiscard]] io_buffer allocate(size_t size) {
+            AC_THROW_IF(size > max_buffer_size(), ERROR_INVALID_PARAMETER, "io_buffer_pool::allocate");
+            io_buffer buffer{try_allocate(size)};
+            AC_THROW_IF(!buffer, ERROR_NOT_ENOUGH_MEMORY, "io_buffer_pool::allocate");
+            return buffer;
+        }
+
+    private:
+        friend class io_buffer;
+
+        static constexpr size_t caches_count{64};
+        static constexpr uint32_t cache_capacity{32};
+        //
+        // Number of buffers moved between a cache and its class at a
+        // time
+        //
+        static constexpr uint32_t batch_size{cache_capacity / 2};
+
+        struct free_entry {
+            free_entry *next;
+        };
+
+        //
+        // Singly linked list threaded through free buffers
+        //
+        struct free_list {
+            void push(free_entry *entry) noexcept {
+                entry->next = head;
+                head = entry;
+                ++count;
+            }
+
+            [[nodiscard]] free_entry *pop() noexcept {
+                free_entry *const entry{head};
+                if (entry) {
+                    head = entry->next;
+                    --count;
+                }
+                return entry;
+            }
+
+            //
+            // Moves up to n entries to the other list
+            //
+            void move_to(free_list &other, uint32_t n) noexcept {
+                while (0 != n-- && nullptr != head) {
+                    other.push(pop());
+                }
+            }
+
+            free_entry *head{nullptr};
+            uint32_t count{0};
+        };
+
+        struct alignas(cache_line_size) processor_cache {
+            fast_mutex lock;
+            free_list buffers;
+        };
+
+        struct size_class {
+            explicit size_class(size_t buffer_size) noexcept
+                : size{buffer_size} {
+            }
+
+            size_t const size;
+            processor_cache caches[caches_count];
+            alignas(cache_line_size) fast_mutex lock;
+            free_list buffers;
+        };
+
+        struct slab {
+            void *base;
+            size_t size;
+        };
+
+        //
+        // Returns index of the smallest class that fits size, or
+        // number of classes if none does
+        //
+        [[nodiscard]] uint32_t find_class(size_t size) const noexcept {
+            uint32_t index{0};
+            while (index < classes_.size() && classes_[index]->size < size) {
+                ++index;
+            }
+            return index;
+        }
+
+        [[nodiscard]] static processor_cache &current_cache(size_class &c) noexcept {
+            return c.caches[current_processor_number() % caches_count];
+        }
+
+        [[nodiscard]] char *pop(size_class &c) noexcept {
+            processor_cache &cache{current_cache(c)};
+            {
+                fast_mutex::guard guard{&cache.lock};
+                if (free_entry *const entry{cache.buffers.pop()}; nullptr != entry) {
+                    return reinterpret_cast<char *>(entry);
+                }
+            }
+            //
+            // Cache is empty, take a batch from the class
+            //
+            free_list batch;
+            {
+                fast_mutex::guard guard{&c.lock};
+                if (0 == c.buffers.count && !grow(c)) {
+                    return nullptr;
+                }
+                c.buffers.move_to(batch, batch_size);
+            }
+            free_entry *const entry{batch.pop()};
+            if (nullptr != batch.head) {
+                fast_mutex::guard guard{&cache.lock};
+                batch.move_to(cache.buffers, batch.count);
+            }
+            return reinterpret_cast<char *>(entry);
+        }
+
+        void push(uint32_t class_index, char *data) noexcept {
+            size_class &c{*classes_[class_index]};
+            processor_cache &cache{current_cache(c)};
+            free_list overflow;
+            {
+                fast_mutex::guard guard{&cache.lock};
+                cache.buffers.push(reinterpret_cast<free_entry *>(data));
+                if (cache.buffers.count > cache_capacity) {
+                    cache.buffers.move_to(overflow, batch_size);
+                }
+            }
+            if (nullptr != overflow.head) {
+                fast_mutex::guard guard{&c.lock};
+                overflow.move_to(c.buffers, overflow.count);
+            }
+        }
+
+        //
+        // Called with class lock held. Carves a new slab into buffers
+        // of the class.
+        //
+        [[nodiscard]] bool grow(size_class &c) noexcept {
+            size_t const size{(std::max)(slab_size_, c.size)};
+            std::optional<slab> const s{allocate_slab(size)};
+            if (!s) {
+                return false;
+            }
+            {
+                fast_mutex::guard guard{&slabs_lock_};
+                try {
+                    slabs_.push_back(*s);
+                } catch (...) {
+                    free_slab(*s);
+                    return false;
+                }
+            }
+            char *const base{static_cast<char *>(s->base)};
+            for (size_t offset = 0; offset + c.size <= s->size; offset += c.size) {
+                c.buffers.push(reinterpret_cast<free_entry *>(base + offset));
+            }
+            return true;
+        }
+
+        [[nodiscard]] std::optional<slab> allocate_slab(size_t size) noexcept {
+            size_t const page_size{system_page_size()};
+            if (io_buffer_pages::huge == pages_) {
+#if AC_PLATFORM_WINDOWS
+                size_t const large_page_size{GetLargePageMinimum()};
+                if (0 != large_page_size) {
+                    size_t const large_size{(size + large_page_size - 1) & ~(large_page_size - 1)};
+                    void *const base{VirtualAlloc(
+                        nullptr, large_size, MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES, PAGE_READWRITE)};
+                    if (nullptr != base) {
+                        huge_pages_used_.store(true, std::memory_order_relaxed);
+                        return slab{base, large_size};
+                    }
+                }
+#else
+                size_t const huge_page_size{2 * 1024 * 1024};
+                size_t const huge_size{(size + huge_page_size - 1) & ~(huge_page_size - 1)};
+                void *const base{::mmap(nullptr,
+                                        huge_size,
+                                        PROT_READ | PROT_WRITE,
+                                        MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB | MAP_POPULATE,
+                                        -1,
+                                        0)};
+                if (MAP_FAILED != base) {
+                    huge_pages_used_.store(true, std::memory_order_relaxed);
+                    return slab{base, huge_size};
+                }
+#endif
+            }
+            size = (size + page_size - 1) & ~(page_size - 1);
+#if AC_PLATFORM_WINDOWS
+            void *const base{VirtualAlloc(nullptr, size, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE)};
+            if (nullptr == base) {
+                return std::nullopt;
+            }
+#else
+            void *const base{
+                ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0)};
+            if (MAP_FAILED == base) {
+                return std::nullopt;
+            }
+            if (io_buffer_pages::huge == pages_) {
+                static_cast<void>(::madvise(base, size, MADV_HUGEPAGE));
+            }
+#endif
+            //
+            // Fault pages in now rather than on the first I/O
+            //
+            for (size_t offset = 0; offset < size; offset += page_size) {
+                static_cast<char volatile *>(base)[offset] = 0;
+            }
+            return slab{base, size};
+        }
+
+        static void free_slab(slab const &s) noexcept {
+#if AC_PLATFORM_WINDOWS
+            AC_CODDING_ERROR_IF_NOT(VirtualFree(s.base, 0, MEM_RELEASE));
+#else
+            AC_CODDING_ERROR_IF_NOT(0 == ::munmap(s.base, s.size));
+#endif
+        }
+
+        size_t const alignment_;
+        size_t const slab_size_;
+        io_buffer_pages const pages_;
+        std::vector<std::unique_ptr<size_class>> classes_;
+        mutable fast_mutex slabs_lock_;
+        std::vector<slab> slabs_;
+        std::atomic<bool> huge_pages_used_{false};
+    };
+
+    inline size_t io_buffer::size() const noexcept {
+        return pool_ ? pool_->classes_[class_index_]->size : 0;
+    }
+
+    inline void io_buffer::release() noexcept {
+        if (nullptr != data_) {
+            pool_->push(class_index_, data_);
+            pool_ = nullptr;
+            data_ = nullptr;
+            class_index_ = 0;
+        }
+    }
+
+    inline void swap(io_buffer &lhs, io_buffer &rhs) noexcept {
+        lhs.swap(rhs);
+    }
+
+} // namespace ac
+
+#endif //_AC_HELPERS_WIN32_LIBRARY_BUFFER_POOL_HEADER_
@@ -1,7 +1,26 @@
 #ifndef _AC_HELPERS_WIN32_LIBRARY_COMMON_HEADER_
 #define _AC_HELPERS_WIN32_LIBRARY_COMMON_HEADER_
 
+#if defined(_WIN32)
+#define AC_PLATFORM_WINDOWS 1
+#define AC_PLATFORM_LINUX 0
+#elif defined(__linux__)
+#define AC_PLATFORM_WINDOWS 0
+#define AC_PLATFORM_LINUX 1
+#else
+#error "Unsupported platform"
+#endif
+
+#if AC_PLATFORM_WINDOWS
 #include <windows.h>
+#else
+#include <errno.h>
+#include <sched.h>
+#include <string.h>
+#include <linux/membarrier.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
 
 #include <chrono>
 #include <memory>
@@ -11,12 +30,68 @@
 #include <exception>
 #include <limits>
 #include <set>
-
+#include <vector>
+#include <string>
+#include <optional>
+#include <system_error>
+#include <cstdint>
+
+#if AC_PLATFORM_LINUX
+//
+// Minimal set of Win32 names used by portable parts of the
+// library. Error codes map to errno values so they can be
+// reported through std::system_category on both platforms.
+//
+using DWORD = std::uint32_t;
+using BOOL = int;
+using UINT = unsigned int;
+using LONGLONG = long long;
+using ULONGLONG = unsigned long long;
+
+#define TRUE 1
+#define FALSE 0
+#define INFINITE 0xFFFFFFFF
+
+#define ERROR_SUCCESS 0
+#define ERROR_INVALID_HANDLE EBADF
+#define ERROR_NOT_ENOUGH_MEMORY ENOMEM
+#define ERROR_INVALID_PARAMETER EINVAL
+#define ERROR_NOT_SUPPORTED ENOTSUP
+#define ERROR_TIMEOUT ETIMEDOUT
+#define ERROR_INVALID_STATE ECANCELED
+#define ERROR_ARITHMETIC_OVERFLOW EOVERFLOW
+#define ERROR_TOO_MANY_POSTS EOVERFLOW
+
+#define WAIT_OBJECT_0 0x00000000
+#define WAIT_ABANDONED_0 0x00000080
+#define WAIT_TIMEOUT 0x00000102
+#define WAIT_FAILED 0xFFFFFFFF
+#define MAXIMUM_WAIT_OBJECTS 64
+
+#define ZeroMemory(P, S) memset((P), 0, (S))
+
+namespace ac::details {
+    class kernel_handle;
+}
+//
+// Kernel objects are reference counted objects in this process,
+// see ackernelobject.h
+//
+using HANDLE = ac::details::kernel_handle *;
+#endif // AC_PLATFORM_LINUX
+
+#if AC_PLATFORM_WINDOWS
 #define AC_PLATFORM_FAIL_FAST(EC) \
     {                             \
         __debugbreak();           \
         __fastfail(EC);           \
     }
+#else
+#define AC_PLATFORM_FAIL_FAST(EC) \
+    {                             \
+        __builtin_trap();         \
+    }
+#endif
 
 #ifndef AC_FAST_FAIL
 #define AC_FAST_FAIL(EC) \
@@ -62,6 +137,17 @@
         AC_THROW(EC, REASON);          \
     }
 
+//
+// Lets empty policy members take no space
+//
+#ifndef AC_NO_UNIQUE_ADDRESS
+#if defined(_MSC_VER)
+#define AC_NO_UNIQUE_ADDRESS [[msvc::no_unique_address]]
+#else
+#define AC_NO_UNIQUE_ADDRESS [[no_unique_address]]
+#endif
+#endif
+
 #ifndef WINBOOL
 #define WINBOOL(E) ((E) ? TRUE : FALSE)
 #endif // WINBOOL
@@ -78,6 +164,123 @@ namespace ac {
     using ucbuffer = std::vector<unsigned char>;
     using wbuffer = std::vector<wchar_t>;
 
+    //
+    // Used to pad hot atomics so they do not share cache line
+    // with unrelated data
+    //
+    inline constexpr size_t cache_line_size{64};
+
+    [[nodiscard]] inline unsigned long current_processor_number() noexcept {
+#if AC_PLATFORM_WINDOWS
+        return GetCurrentProcessorNumber();
+#else
+        int const cpu{sched_getcpu()};
+        return cpu < 0 ? 0 : static_cast<unsigned long>(cpu);
+#endif
+    }
+
+    [[nodiscard]] inline DWORD current_thread_id() noexcept {
+#if AC_PLATFORM_WINDOWS
+        return GetCurrentThreadId();
+#else
+        thread_local DWORD const thread_id{static_cast<DWORD>(syscall(SYS_gettid))};
+        return thread_id;
+#endif
+    }
+
+    [[nodiscard]] inline DWORD system_page_size() noexcept {
+#if AC_PLATFORM_WINDOWS
+        static DWORD const page_size{[]() {
+            SYSTEM_INFO system_info;
+            GetSystemInfo(&system_info);
+            return system_info.dwPageSize;
+        }()};
+#else
+        static DWORD const page_size{static_cast<DWORD>(sysconf(_SC_PAGESIZE))};
+#endif
+        return page_size;
+    }
+
+    //
+    // Hint to the processor that we are in a spin loop
+    //
+    inline void cpu_relax() noexcept {
+#if AC_PLATFORM_WINDOWS
+        YieldProcessor();
+#elif defined(__x86_64__) || defined(__i386__)
+        __builtin_ia32_pause();
+#elif defined(__aarch64__)
+        asm volatile("yield" ::: "memory");
+#else
+        std::atomic_signal_fence(std::memory_order_seq_cst);
+#endif
+    }
+
+    //
+    // Asymmetric memory barrier. Fast side runs often and pays only
+    // for a compiler barrier, slow side runs rarely and forces a full
+    // barrier on every processor that runs a thread of this process.
+    // If the system cannot do that, both sides fall back to a full
+    // fence.
+    //
+    [[nodiscard]] inline bool process_memory_barrier_supported() noexcept {
+#if AC_PLATFORM_WINDOWS
+        return true;
+#else
+        static bool const supported{
+            0 == syscall(SYS_membarrier, MEMBARRIER_CMD_REGISTER_PRIVATE_EXPEDITED, 0, 0)};
+        return supported;
+#endif
+    }
+
+    inline void light_memory_barrier() noexcept {
+        if (process_memory_barrier_supported()) {
+            std::atomic_signal_fence(std::memory_order_seq_cst);
+        } else {
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+        }
+    }
+
+    inline void heavy_memory_barrier() noexcept {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (process_memory_barrier_supported()) {
+#if AC_PLATFORM_WINDOWS
+            FlushProcessWriteBuffers();
+#else
+            syscall(SYS_membarrier, MEMBARRIER_CMD_PRIVATE_EXPEDITED, 0, 0);
+#endif
+        }
+    }
+
+    //
+    // Tracks how much of a wait timeout is left across several
+    // waits that each can wake up early
+    //
+    class wait_deadline {
+    public:
+        explicit wait_deadline(DWORD milliseconds) noexcept
+            : milliseconds_{milliseconds}
+            , start_{INFINITE == milliseconds ? std::chrono::steady_clock::time_point{}
+                                              : std::chrono::steady_clock::now()} {
+        }
+
+        [[nodiscard]] DWORD remaining() const noexcept {
+            if (INFINITE == milliseconds_) {
+                return INFINITE;
+            }
+            long long const elapsed{std::chrono::duration_cast<std::chrono::milliseconds>(
+                                        std::chrono::steady_clock::now() - start_)
+                                        .count()};
+            return elapsed < static_cast<long long>(milliseconds_)
+                       ? static_cast<DWORD>(milliseconds_ - elapsed)
+                       : 0;
+        }
+
+    private:
+        DWORD milliseconds_;
+        std::chrono::steady_clock::time_point start_;
+    };
+
     [[nodiscard]] inline char const *c_str_or_null_if_empty(std::string const &str) {
         return str.empty() ? nullptr : str.c_str();
     }
@@ -157,6 +360,7 @@ namespace ac {
         return s;
     }
 
+#if AC_PLATFORM_WINDOWS
     inline constexpr unsigned long long filetime_ctime_epoch_diff = 116444736000000000ULL;
 
     [[nodiscard]] inline FILETIME system_clock_time_point_to_filetime(
@@ -184,6 +388,8 @@ namespace ac {
             std::chrono::system_clock::time_point::duration{ul}};
     }
 
+#endif // AC_PLATFORM_WINDOWS
+
     [[nodiscard]] inline DWORD try_resize(cbuffer *b, size_t new_size) noexcept {
         return try_resize(*b, new_size);
     }
@@ -343,6 +549,7 @@ namespace ac {
         return err;
     }
 
+#if AC_PLATFORM_WINDOWS
     class cpp_set_lang_guard {
     public:
         explicit cpp_set_lang_guard(wchar_t const *language) noexcept
@@ -607,6 +814,8 @@ namespace ac {
         return value;
     }
 
+#endif // AC_PLATFORM_WINDOWS
+
     template<typename G>
     class scope_guard: private G {
     public:
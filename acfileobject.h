@@ -5,10 +5,59 @@
 
 #include "accommon.h"
 #include "ackernelobject.h"
+
+#if AC_PLATFORM_WINDOWS
 #include "actp.h"
+#else
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#endif
+
+#include <span>
 
 namespace ac {
 
+    //
+    // One buffer of scatter/gather I/O. Data is read into or written
+    // from the caller's buffers in the order of segments, so a record
+    // can be assembled from separate pieces without copying them.
+    //
+    struct io_segment {
+        io_segment() noexcept = default;
+
+        io_segment(void *segment_buffer, DWORD segment_size) noexcept
+            : buffer{segment_buffer}
+            , size{segment_size} {
+        }
+
+        //
+        // Writes do not modify the buffer
+        //
+        io_segment(void const *segment_buffer, DWORD segment_size) noexcept
+            : buffer{const_cast<void *>(segment_buffer)}
+            , size{segment_size} {
+        }
+
+        void *buffer{nullptr};
+        DWORD size{0};
+    };
+
+    namespace details {
+
+        [[nodiscard]] inline DWORD io_segments_size(std::span<io_segment const> segments) {
+            ULONGLONG size{0};
+            for (io_segment const &segment : segments) {
+                size += segment.size;
+            }
+            AC_THROW_IF(size > (std::numeric_limits<DWORD>::max)(), ERROR_ARITHMETIC_OVERFLOW, "io_segments_size");
+            return static_cast<DWORD>(size);
+        }
+
+    } // namespace details
+
+#if AC_PLATFORM_WINDOWS
+
     template<typename>
     struct get_file_info;
     template<>
@@ -188,13 +237,8 @@ namespace ac {
 
         file_object() {
         }
-        //
-        // Duplicates handle
-        //
-        file_object(file_object const &f)
-            : kernel_object(f)
-            , name_(f.name_) {
-        }
+
+        file_object(file_object const &) = delete;
 
         file_object(file_object &&f) noexcept
             : kernel_object(std::move(f))
@@ -211,13 +255,7 @@ namespace ac {
             create(name, desiered_access, share_mode, creation_disposition, flag_and_attributes, security_attributes, template_file);
         }
 
-        const file_object &operator=(file_object const &f) {
-            if (&f != this) {
-                kernel_object::operator=(f);
-                name_ = f.name_;
-            }
-            return *this;
-        };
+        file_object &operator=(file_object const &) = delete;
 
         const file_object &operator=(file_object &&f) noexcept {
             if (&f != this) {
@@ -285,6 +323,21 @@ namespace ac {
             return name_;
         }
 
+        using kernel_object::duplicate;
+
+        //
+        // New handle to the same file. It shares file pointer and
+        // locks with this handle.
+        //
+        [[nodiscard]] file_object duplicate() const {
+            file_object f;
+            if (is_valid()) {
+                f.kernel_object::duplicate(*this);
+                f.name_ = name_;
+            }
+            return f;
+        }
+
         void close() {
             kernel_object::close();
             name_.clear();
@@ -909,11 +962,197 @@ namespace ac {
             return (ERROR_SUCCESS == error);
         }
 
+        //
+        // ReadFileScatter and WriteFileGather need a handle opened with
+        // FILE_FLAG_NO_BUFFERING and FILE_FLAG_OVERLAPPED, and every
+        // segment to be one page aligned on a page boundary
+        //
+        [[nodiscard]] static bool can_scatter_gather(std::span<io_segment const> segments) noexcept {
+            DWORD const page_size{system_page_size()};
+            for (io_segment const &segment : segments) {
+                if (page_size != segment.size ||
+                    0 != (reinterpret_cast<ULONG_PTR>(segment.buffer) & (page_size - 1))) {
+                    return false;
+                }
+            }
+            return !segments.empty();
+        }
+        //
+        // Reads segments one after another at the file pointer.
+        // Returns false if EOF was reached before anything was read.
+        //
+        bool read_vectored(std::span<io_segment const> segments, DWORD *number_of_bytes_read) {
+            DWORD total_bytes_read = 0;
+            static_cast<void>(details::io_segments_size(segments));
+            for (io_segment const &segment : segments) {
+                DWORD segment_bytes_read = 0;
+                if (!read(segment.buffer, segment.size, &segment_bytes_read)) {
+                    break;
+                }
+                total_bytes_read += segment_bytes_read;
+                if (segment_bytes_read < segment.size) {
+                    break;
+                }
+            }
+            *number_of_bytes_read = total_bytes_read;
+            return (total_bytes_read != 0);
+        }
+        //
+        // Returns true if IO completed synchronosly and
+        // false otherwise. Segments must pass can_scatter_gather.
+        //
+        [[nodiscard]] bool read_vectored(std::span<io_segment const> segments, bool *is_eof, OVERLAPPED *o) {
+            AC_CODDING_ERROR_IF_NOT(can_scatter_gather(segments));
+            std::vector<FILE_SEGMENT_ELEMENT> elements{make_segment_elements(segments)};
+            DWORD error = ERROR_SUCCESS;
+
+            if (!ReadFileScatter(
+                    get_handle(), elements.data(), details::io_segments_size(segments), nullptr, o)) {
+                error = GetLastError();
+
+                if (ERROR_HANDLE_EOF == error) {
+                    if (is_eof) {
+                        *is_eof = true;
+                        //
+                        // The IO has completed synchronosly
+                        //
+                        error = ERROR_SUCCESS;
+                    } else {
+                        AC_THROW(error, "ReadFileScatter");
+                    }
+                } else if (ERROR_IO_PENDING != error) {
+                    AC_THROW(error, "ReadFileScatter");
+                }
+            }
+            return (ERROR_SUCCESS == error);
+        }
+        //
+        // Uses ReadFileScatter when segments allow it, and reads
+        // segment by segment otherwise. Returns number of bytes read.
+        //
+        DWORD read_vectored_sync(std::span<io_segment const> segments, LONGLONG offset, bool *is_eof) {
+            DWORD const number_of_bytes_to_read{details::io_segments_size(segments)};
+            DWORD number_of_bytes_read = 0;
+
+            if (!can_scatter_gather(segments)) {
+                for (io_segment const &segment : segments) {
+                    bool segment_eof{false};
+                    number_of_bytes_read +=
+                        read_sync(segment.buffer, offset + number_of_bytes_read, segment.size, &segment_eof);
+                    if (segment_eof) {
+                        break;
+                    }
+                }
+            } else {
+                event e{event::manuel, event::unsignaled};
+
+                OVERLAPPED overlapped = {};
+                overlapped.hEvent = e.get_handle();
+                overlapped.Offset = get_low_dword(offset);
+                overlapped.OffsetHigh = get_high_dword(offset);
+
+                bool eof{false};
+                static_cast<void>(read_vectored(segments, &eof, &overlapped));
+                if (!eof && !CPPBOOL(GetOverlappedResult(
+                                get_handle(), &overlapped, &number_of_bytes_read, TRUE))) {
+                    DWORD const error{GetLastError()};
+                    if (ERROR_HANDLE_EOF != error) {
+                        AC_THROW(error, "ReadFileScatter");
+                    }
+                }
+            }
+            //
+            // If we read less than requested then we've reached EOF
+            //
+            if (is_eof && number_of_bytes_to_read > number_of_bytes_read) {
+                *is_eof = true;
+            }
+
+            return number_of_bytes_read;
+        }
+        //
+        // Writes segments one after another at the file pointer.
+        // Returns number of bytes written to the file
+        //
+        DWORD write_vectored(std::span<io_segment const> segments) {
+            DWORD number_of_bytes_wrote = 0;
+            static_cast<void>(details::io_segments_size(segments));
+            for (io_segment const &segment : segments) {
+                number_of_bytes_wrote += write(segment.buffer, segment.size);
+            }
+            return number_of_bytes_wrote;
+        }
+        //
+        // Returns true if IO completed synchronosly and
+        // false otherwise. Segments must pass can_scatter_gather.
+        //
+        [[nodiscard]] bool write_vectored(std::span<io_segment const> segments, OVERLAPPED *o) {
+            AC_CODDING_ERROR_IF_NOT(can_scatter_gather(segments));
+            std::vector<FILE_SEGMENT_ELEMENT> elements{make_segment_elements(segments)};
+            DWORD error = ERROR_SUCCESS;
+
+            if (!WriteFileGather(
+                    get_handle(), elements.data(), details::io_segments_size(segments), nullptr, o)) {
+                error = GetLastError();
+
+                if (ERROR_IO_PENDING != error) {
+                    AC_THROW(error, "WriteFileGather");
+                }
+            }
+            return (ERROR_SUCCESS == error);
+        }
+        //
+        // Uses WriteFileGather when segments allow it, and writes
+        // segment by segment otherwise. Returns number of bytes
+        // written to the file.
+        //
+        [[nodiscard]] DWORD write_vectored_sync(std::span<io_segment const> segments, LONGLONG offset) {
+            DWORD number_of_bytes_wrote = 0;
+
+            if (!can_scatter_gather(segments)) {
+                static_cast<void>(details::io_segments_size(segments));
+                for (io_segment const &segment : segments) {
+                    number_of_bytes_wrote +=
+                        write_sync(segment.buffer, offset + number_of_bytes_wrote, segment.size);
+                }
+            } else {
+                event e{event::manuel, event::unsignaled};
+
+                OVERLAPPED overlapped = {};
+                overlapped.hEvent = e.get_handle();
+                overlapped.Offset = get_low_dword(offset);
+                overlapped.OffsetHigh = get_high_dword(offset);
+
+                static_cast<void>(write_vectored(segments, &overlapped));
+                if (!CPPBOOL(GetOverlappedResult(
+                        get_handle(), &overlapped, &number_of_bytes_wrote, TRUE))) {
+                    AC_THROW(GetLastError(), "WriteFileGather");
+                }
+            }
+
+            return number_of_bytes_wrote;
+        }
+
         void swap(file_object &other) {
             kernel_object::swap(other);
             std::swap(other.name_, name_);
         }
 
+    private:
+        //
+        // Array is terminated by a null element. I/O manager locks
+        // the pages before the call returns, so array does not need
+        // to outlive it.
+        //
+        [[nodiscard]] static std::vector<FILE_SEGMENT_ELEMENT> make_segment_elements(
+            std::span<io_segment const> segments) {
+            std::vector<FILE_SEGMENT_ELEMENT> elements(segments.size() + 1);
+            for (size_t i = 0; i < segments.size(); ++i) {
+                elements[i].Alignment = static_cast<ULONGLONG>(reinterpret_cast<ULONG_PTR>(segments[i].buffer));
+            }
+            return elements;
+        }
+
     protected:
         std::wstring name_;
     };
@@ -1437,6 +1676,467 @@ namespace ac {
         return result;
     }
 
+#else // AC_PLATFORM_LINUX
+
+    namespace details {
+
+        //
+        // Owns file descriptor. File is never signaled, all I/O on it
+        // completes before the call returns, so waiting on it returns
+        // right away like waiting on a file handle opened without
+        // FILE_FLAG_OVERLAPPED.
+        //
+        class file_handle final : public kernel_handle {
+        public:
+            explicit file_handle(int fd) noexcept
+                : kernel_handle{kernel_object_type::file, kernel_object_kind::in_process, fd} {
+            }
+
+            [[nodiscard]] bool signal() noexcept final {
+                return false;
+            }
+
+            void undo_acquire(DWORD) noexcept final {
+            }
+
+            [[nodiscard]] DWORD try_acquire() noexcept final {
+                return WAIT_OBJECT_0;
+            }
+
+            [[nodiscard]] DWORD wait(DWORD) noexcept final {
+                return WAIT_OBJECT_0;
+            }
+        };
+
+    } // namespace details
+
+    //
+    // File opened with open(2). Duplicates share the descriptor, so
+    // they share file pointer and locks same as duplicated handles
+    // do on Windows.
+    //
+    // read_sync and write_sync use pread and pwrite, they never move
+    // file pointer, so any number of threads can do positional I/O on
+    // one file_object. read and write without offset use and move the
+    // file pointer, same as ReadFile and WriteFile do.
+    //
+    class file_object : public kernel_object {
+    public:
+        [[nodiscard]] static DWORD try_create_directory(char const *name, mode_t mode = 0777) noexcept {
+            if (0 != ::mkdir(name, mode)) {
+                return errno;
+            }
+            return ERROR_SUCCESS;
+        }
+
+        static void create_directory(char const *name, mode_t mode = 0777) {
+            if (0 != ::mkdir(name, mode)) {
+                AC_THROW(errno, "mkdir");
+            }
+        }
+
+        [[nodiscard]] static DWORD try_erase(char const *name) noexcept {
+            if (0 != ::unlink(name)) {
+                return errno;
+            }
+            return ERROR_SUCCESS;
+        }
+
+        static void erase(char const *name) {
+            if (0 != ::unlink(name)) {
+                AC_THROW(errno, "unlink");
+            }
+        }
+
+        file_object() {
+        }
+
+        file_object(file_object const &) = delete;
+
+        file_object(file_object &&f) noexcept
+            : kernel_object(std::move(f))
+            , name_(std::move(f.name_)) {
+        }
+
+        //
+        // Flags are passed to open, O_CLOEXEC is always added
+        //
+        file_object(char const *name, int flags, mode_t mode = 0666) {
+            create(name, flags, mode);
+        }
+
+        file_object &operator=(file_object const &) = delete;
+
+        file_object &operator=(file_object &&f) noexcept {
+            if (&f != this) {
+                kernel_object::operator=(std::move(f));
+                name_ = std::move(f.name_);
+            }
+            return *this;
+        }
+
+        [[nodiscard]] DWORD try_create(char const *name, int flags, mode_t mode = 0666) {
+            close();
+
+            int fd{-1};
+            do {
+                fd = ::open(name, flags | O_CLOEXEC, mode);
+            } while (-1 == fd && EINTR == errno);
+
+            if (-1 == fd) {
+                return errno;
+            }
+
+            attach(new details::file_handle{fd});
+
+            name_ = name;
+
+            return ERROR_SUCCESS;
+        }
+
+        void create(char const *name, int flags, mode_t mode = 0666) {
+            DWORD const error{try_create(name, flags, mode)};
+            if (ERROR_SUCCESS != error) {
+                AC_THROW(error, "open");
+            }
+        }
+
+        std::string const &get_name() const {
+            return name_;
+        }
+
+        using kernel_object::duplicate;
+
+        //
+        // New handle to the same file. It shares file pointer and
+        // locks with this handle.
+        //
+        [[nodiscard]] file_object duplicate() const {
+            file_object f;
+            if (is_valid()) {
+                f.kernel_object::duplicate(*this);
+                f.name_ = name_;
+            }
+            return f;
+        }
+
+        void close() noexcept {
+            kernel_object::close();
+            name_.clear();
+        }
+
+        [[nodiscard]] int get_fd() const noexcept {
+            AC_CODDING_ERROR_IF_NOT(is_valid());
+            return get_handle()->fd();
+        }
+
+        //
+        // Truncates or extends file at the file pointer
+        //
+        void set_end_of_file() {
+            resize(set_file_pointer(0, SEEK_CUR));
+        }
+
+        //
+        // Unlike on Windows file pointer is not moved
+        //
+        void resize(LONGLONG size) {
+            int rc{-1};
+            do {
+                rc = ::ftruncate(get_fd(), static_cast<off_t>(size));
+            } while (-1 == rc && EINTR == errno);
+            if (-1 == rc) {
+                AC_THROW(errno, "ftruncate");
+            }
+        }
+
+        [[nodiscard]] LONGLONG set_file_pointer(LONGLONG pos, int method = SEEK_CUR) {
+            off_t const rc{::lseek(get_fd(), static_cast<off_t>(pos), method)};
+            if (-1 == rc) {
+                AC_THROW(errno, "lseek");
+            }
+            return rc;
+        }
+        //
+        // Returns false if EOF was reached
+        //
+        bool read(void *buffer, DWORD number_of_bytes_to_read, DWORD *number_of_bytes_read) {
+            ssize_t rc{-1};
+            do {
+                rc = ::read(get_fd(), buffer, number_of_bytes_to_read);
+            } while (-1 == rc && EINTR == errno);
+            if (-1 == rc) {
+                AC_THROW(errno, "read");
+            }
+            *number_of_bytes_read = static_cast<DWORD>(rc);
+            return 0 != rc;
+        }
+        //
+        // Reads at the offset until buffer is full or EOF is reached.
+        // Returns number of bytes read.
+        //
+        DWORD read_sync(void *buffer, LONGLONG offset, DWORD number_of_bytes_to_read, bool *is_eof) {
+            DWORD number_of_bytes_read = 0;
+            char *const data{static_cast<char *>(buffer)};
+
+            while (number_of_bytes_read < number_of_bytes_to_read) {
+                ssize_t const rc{::pread(get_fd(),
+                                         data + number_of_bytes_read,
+                                         number_of_bytes_to_read - number_of_bytes_read,
+                                         static_cast<off_t>(offset + number_of_bytes_read))};
+                if (-1 == rc) {
+                    if (EINTR == errno) {
+                        continue;
+                    }
+                    AC_THROW(errno, "pread");
+                }
+                if (0 == rc) {
+                    break;
+                }
+                number_of_bytes_read += static_cast<DWORD>(rc);
+            }
+            //
+            // If we read less than requested then we've reached EOF
+            //
+            if (is_eof && number_of_bytes_to_read > number_of_bytes_read) {
+                *is_eof = true;
+            }
+
+            return number_of_bytes_read;
+        }
+
+        //
+        // Synchronosly writes to the file at the file pointer.
+        // Returns number of bytes written to the file
+        //
+        DWORD write(void const *buffer, DWORD number_of_bytes_to_write) {
+            DWORD number_of_bytes_wrote = 0;
+            char const *const data{static_cast<char const *>(buffer)};
+
+            while (number_of_bytes_wrote < number_of_bytes_to_write) {
+                ssize_t const rc{::write(
+                    get_fd(), data + number_of_bytes_wrote, number_of_bytes_to_write - number_of_bytes_wrote)};
+                if (-1 == rc) {
+                    if (EINTR == errno) {
+                        continue;
+                    }
+                    AC_THROW(errno, "write");
+                }
+                number_of_bytes_wrote += static_cast<DWORD>(rc);
+            }
+
+            return number_of_bytes_wrote;
+        }
+
+        [[nodiscard]] DWORD write_sync(void const *buffer, LONGLONG offset, DWORD number_of_bytes_to_write) {
+            DWORD number_of_bytes_wrote = 0;
+            char const *const data{static_cast<char const *>(buffer)};
+
+            while (number_of_bytes_wrote < number_of_bytes_to_write) {
+                ssize_t const rc{::pwrite(get_fd(),
+                                          data + number_of_bytes_wrote,
+                                          number_of_bytes_to_write - number_of_bytes_wrote,
+                                          static_cast<off_t>(offset + number_of_bytes_wrote))};
+                if (-1 == rc) {
+                    if (EINTR == errno) {
+                        continue;
+                    }
+                    AC_THROW(errno, "pwrite");
+                }
+                number_of_bytes_wrote += static_cast<DWORD>(rc);
+            }
+
+            return number_of_bytes_wrote;
+        }
+
+        LONGLONG get_size() const {
+            struct stat information {};
+            if (0 != ::fstat(get_fd(), &information)) {
+                AC_THROW(errno, "fstat");
+            }
+            return information.st_size;
+        }
+
+        //
+        // Flushes file data, and metadata needed to read it back
+        //
+        void flush() {
+            int rc{-1};
+            do {
+                rc = ::fdatasync(get_fd());
+            } while (-1 == rc && EINTR == errno);
+            if (-1 == rc) {
+                AC_THROW(errno, "fdatasync");
+            }
+        }
+
+        //
+        // Locks belong to the open file, not to the process, so like
+        // on Windows they are released when the last duplicate is
+        // closed, and two file_objects for the same file conflict even
+        // in one process. Returns EAGAIN if range is locked and caller
+        // does not want to wait.
+        //
+        [[nodiscard]] DWORD try_byte_range_lock(ULONGLONG offset,
+                                                ULONGLONG size,
+                                                bool exclusive = true,
+                                                bool wait = false) noexcept {
+            return lock_range(exclusive ? F_WRLCK : F_RDLCK, offset, size, wait ? F_OFD_SETLKW : F_OFD_SETLK);
+        }
+
+        //
+        // Same as LockFile, fails if range is already locked
+        //
+        void byte_range_lock(ULONGLONG offset, ULONGLONG size) {
+            DWORD const error{try_byte_range_lock(offset, size)};
+            if (ERROR_SUCCESS != error) {
+                AC_THROW(error, "fcntl(F_OFD_SETLK)");
+            }
+        }
+
+        void byte_range_unlock(ULONGLONG offset, ULONGLONG size) {
+            DWORD const error{lock_range(F_UNLCK, offset, size, F_OFD_SETLK)};
+            if (ERROR_SUCCESS != error) {
+                AC_THROW(error, "fcntl(F_OFD_SETLK)");
+            }
+        }
+
+        //
+        // Reads segments one after another at the file pointer with
+        // readv. Returns false if EOF was reached before anything was
+        // read.
+        //
+        bool read_vectored(std::span<io_segment const> segments, DWORD *number_of_bytes_read) {
+            *number_of_bytes_read = transfer_segments(segments, [this](iovec const *batch, int count, DWORD) {
+                return ::readv(get_fd(), batch, count);
+            });
+            return (*number_of_bytes_read != 0);
+        }
+        //
+        // Reads at the offset with preadv until segments are full or
+        // EOF is reached. Returns number of bytes read.
+        //
+        DWORD read_vectored_sync(std::span<io_segment const> segments, LONGLONG offset, bool *is_eof) {
+            DWORD const number_of_bytes_to_read{details::io_segments_size(segments)};
+            DWORD const number_of_bytes_read{
+                transfer_segments(segments, [this, offset](iovec const *batch, int count, DWORD done) {
+                    return ::preadv(get_fd(), batch, count, static_cast<off_t>(offset + done));
+                })};
+            //
+            // If we read less than requested then we've reached EOF
+            //
+            if (is_eof && number_of_bytes_to_read > number_of_bytes_read) {
+                *is_eof = true;
+            }
+            return number_of_bytes_read;
+        }
+        //
+        // Writes segments at the file pointer with writev.
+        // Returns number of bytes written to the file
+        //
+        DWORD write_vectored(std::span<io_segment const> segments) {
+            return transfer_segments(segments, [this](iovec const *batch, int count, DWORD) {
+                return ::writev(get_fd(), batch, count);
+            });
+        }
+
+        [[nodiscard]] DWORD write_vectored_sync(std::span<io_segment const> segments, LONGLONG offset) {
+            return transfer_segments(segments, [this, offset](iovec const *batch, int count, DWORD done) {
+                return ::pwritev(get_fd(), batch, count, static_cast<off_t>(offset + done));
+            });
+        }
+
+        void swap(file_object &other) noexcept {
+            kernel_object::swap(other);
+            std::swap(other.name_, name_);
+        }
+
+    private:
+        //
+        // Passes segments to the system call in batches of iovec,
+        // and resumes from the middle of a segment after a short
+        // transfer. Stops at EOF.
+        //
+        template<typename F>
+        [[nodiscard]] static DWORD transfer_segments(std::span<io_segment const> segments, F &&transfer) {
+            static_cast<void>(details::io_segments_size(segments));
+
+            constexpr int batch_capacity{64};
+            iovec batch[batch_capacity];
+            size_t index{0};
+            DWORD consumed{0};
+            DWORD total{0};
+
+            while (index < segments.size()) {
+                int count{0};
+                for (size_t i = index; i < segments.size() && count < batch_capacity; ++i, ++count) {
+                    DWORD const skip{i == index ? consumed : 0};
+                    batch[count].iov_base = static_cast<char *>(segments[i].buffer) + skip;
+                    batch[count].iov_len = segments[i].size - skip;
+                }
+
+                ssize_t const rc{transfer(batch, count, total)};
+                if (-1 == rc) {
+                    if (EINTR == errno) {
+                        continue;
+                    }
+                    AC_THROW(errno, "vectored I/O");
+                }
+                if (0 == rc) {
+                    break;
+                }
+                total += static_cast<DWORD>(rc);
+
+                DWORD remaining{static_cast<DWORD>(rc)};
+                while (0 != remaining) {
+                    DWORD const left{segments[index].size - consumed};
+                    if (remaining < left) {
+                        consumed += remaining;
+                        remaining = 0;
+                    } else {
+                        remaining -= left;
+                        consumed = 0;
+                        ++index;
+                    }
+                }
+            }
+            return total;
+        }
+
+        [[nodiscard]] DWORD lock_range(short type, ULONGLONG offset, ULONGLONG size, int command) noexcept {
+            struct flock range {};
+            range.l_type = type;
+            range.l_whence = SEEK_SET;
+            range.l_start = static_cast<off_t>(offset);
+            range.l_len = static_cast<off_t>(size);
+            //
+            // Must be zero for open file description locks
+            //
+            range.l_pid = 0;
+
+            int rc{-1};
+            do {
+                rc = ::fcntl(get_fd(), command, &range);
+            } while (-1 == rc && EINTR == errno && F_OFD_SETLKW == command);
+            if (-1 == rc) {
+                //
+                // Conflicting lock is reported as either of the two
+                //
+                return EACCES == errno ? EAGAIN : errno;
+            }
+            return ERROR_SUCCESS;
+        }
+
+    protected:
+        std::string name_;
+    };
+
+    inline void swap(file_object &lhs, file_object &rhs) noexcept {
+        lhs.swap(rhs);
+    }
+
+#endif // AC_PLATFORM_LINUX
+
 } // namespace ac
 
 #endif //_AC_HELPERS_WIN32_LIBRARY_FILE_OBJECT_HEADER_
\ No newline at end of file
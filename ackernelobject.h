@@ -3,8 +3,21 @@
 
 #include "accommon.h"
 
+#if AC_PLATFORM_LINUX
+#include "acwaitonaddress.h"
+#include "acmutex.h"
+
+#include <poll.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+
+#include <algorithm>
+#include <climits>
+#endif
+
 namespace ac {
 
+#if AC_PLATFORM_WINDOWS
     inline [[nodiscard]] DWORD wait_single_object(HANDLE h, DWORD milliseconds = INFINITE) {
         AC_CODDING_ERROR_IF(NULL == h);
         DWORD rc = WaitForSingleObject(h, milliseconds);
@@ -21,7 +34,9 @@ namespace ac {
         return rc;
     }
 
-    inline [[nodiscard]] void verify_handles(HANDLE const *h, DWORD handles_count) noexcept {
+#endif // AC_PLATFORM_WINDOWS
+
+    inline void verify_handles(HANDLE const *h, DWORD handles_count) noexcept {
         HANDLE const *cur = h;
         HANDLE const *end = h + handles_count;
         for (; cur != end; ++cur) {
@@ -30,18 +45,12 @@ namespace ac {
     }
 
     template<DWORD N>
-    inline [[nodiscard]] void verify_handles(HANDLE (&h)[N]) noexcept {
+    inline void verify_handles(HANDLE (&h)[N]) noexcept {
         verify_handles(h, N);
     }
 
-    inline [[nodiscard]] size_t wait_result_to_idx(size_t wait_result) {
-#ifdef max
-#define AC_SAVE_MAX max
-#undef max
-        size_t idx = std::numeric_limits<size_t>::max();
-#define max AC_SAVE_MAX
-#undef AC_SAVE_MAX
-#endif // max
+    [[nodiscard]] inline size_t wait_result_to_idx(size_t wait_result) {
+        size_t idx = (std::numeric_limits<size_t>::max)();
 
         if (wait_result != WAIT_TIMEOUT && wait_result != WAIT_FAILED) {
             if (wait_result >= WAIT_ABANDONED_0) {
@@ -53,6 +62,7 @@ namespace ac {
         return idx;
     }
 
+#if AC_PLATFORM_WINDOWS
     inline [[nodiscard]] DWORD wait_multiple_objects(HANDLE const *h,
                                                      DWORD handles_count,
                                                      DWORD milliseconds = INFINITE,
@@ -172,17 +182,12 @@ namespace ac {
             }
         }
 
-        kernel_object(kernel_object const &ko,
-                      DWORD options = DUPLICATE_SAME_ACCESS,
-                      DWORD desired_access = 0,
-                      HANDLE source_process = GetCurrentProcess(),
-                      HANDLE destination_process = GetCurrentProcess(),
-                      bool inheritance = false)
-            : h_(nullptr) {
-            if (ko.is_valid()) {
-                duplicate(ko.h_, options, desired_access, source_process, destination_process, inheritance);
-            }
-        }
+        //
+        // Copying a handle costs DuplicateHandle and CloseHandle, so it
+        // has to be asked for with duplicate(). Use shared_kernel_object
+        // to pass one handle around.
+        //
+        kernel_object(kernel_object const &) = delete;
 
         kernel_object(kernel_object &&ko) noexcept
             : h_(ko.h_) {
@@ -277,6 +282,10 @@ namespace ac {
             duplicate(ko.h_, options, desired_access, source_process, destination_process, inheritance);
         }
 
+        [[nodiscard]] kernel_object duplicate() const {
+            return kernel_object{h_, true};
+        }
+
         [[nodiscard]] DWORD wait(DWORD milliseconds = INFINITE) const noexcept {
             return wait_single_object(h_, milliseconds);
         }
@@ -300,15 +309,7 @@ namespace ac {
             }
         }
 
-        kernel_object &operator=(kernel_object const &ko) {
-            if (&ko != this) {
-                close();
-                if (ko.is_valid()) {
-                    duplicate(ko);
-                }
-            }
-            return *this;
-        }
+        kernel_object &operator=(kernel_object const &) = delete;
 
         void swap(kernel_object &other) noexcept {
             HANDLE h = other.h_;
@@ -349,258 +350,1856 @@ namespace ac {
         HANDLE h_;
     };
 
-    inline void swap(kernel_object &lhs, kernel_object &rhs) noexcept {
-        lhs.swap(rhs);
-    }
+#else // AC_PLATFORM_LINUX
+
+    enum class kernel_object_kind {
+        //
+        // Backed by an eventfd, so it can be waited on together with
+        // other objects and file descriptors
+        //
+        pollable,
+        //
+        // Backed by a futex word. Does not leave user mode when
+        // nobody waits, but can only be waited on alone
+        //
+        in_process,
+    };
 
-    inline bool operator==(kernel_object const &lhs, kernel_object const &rhs) noexcept {
-        return lhs.get_handle() == rhs.get_handle();
-    }
+    enum class kernel_object_type {
+        event,
+        semaphore,
+        mutex,
+        //
+        // See file_object in acfileobject.h
+        //
+        file,
+    };
 
-    inline bool operator!=(kernel_object const &lhs, kernel_object const &rhs) noexcept {
-        return lhs.get_handle() != rhs.get_handle();
-    }
+    namespace details {
 
-    inline bool operator<(kernel_object const &lhs, kernel_object const &rhs) noexcept {
-        return lhs.get_handle() < rhs.get_handle();
-    }
+        [[nodiscard]] inline int create_eventfd(unsigned int initial_value, int flags = 0) {
+            int const fd{eventfd(initial_value, EFD_CLOEXEC | EFD_NONBLOCK | flags)};
+            AC_THROW_IF(-1 == fd, errno, "eventfd");
+            return fd;
+        }
 
-    inline bool operator<=(kernel_object const &lhs, kernel_object const &rhs) noexcept {
-        return lhs.get_handle() <= rhs.get_handle();
-    }
+        //
+        // Returns false if counter is zero
+        //
+        [[nodiscard]] inline bool eventfd_try_read(int fd) noexcept {
+            uint64_t value{0};
+            if (sizeof(value) == ::read(fd, &value, sizeof(value))) {
+                return true;
+            }
+            AC_CODDING_ERROR_IF(EAGAIN != errno);
+            return false;
+        }
 
-    inline bool operator>(kernel_object const &lhs, kernel_object const &rhs) noexcept {
-        return lhs.get_handle() > rhs.get_handle();
-    }
+        inline void eventfd_add(int fd, uint64_t value) noexcept {
+            AC_CODDING_ERROR_IF(sizeof(value) != ::write(fd, &value, sizeof(value)));
+        }
 
-    inline bool operator>=(kernel_object const &lhs, kernel_object const &rhs) noexcept {
-        return lhs.get_handle() >= rhs.get_handle();
-    }
+        //
+        // Returns false on timeout. Signals are reported as a wake,
+        // and callers are expected to recheck.
+        //
+        [[nodiscard]] inline bool poll_readable(int fd, DWORD milliseconds) noexcept {
+            pollfd descriptor{fd, POLLIN, 0};
+            int const timeout{INFINITE == milliseconds
+                                  ? -1
+                                  : static_cast<int>((std::min)(milliseconds, static_cast<DWORD>(INT_MAX)))};
+            int const result{::poll(&descriptor, 1, timeout)};
+            AC_CODDING_ERROR_IF(-1 == result && EINTR != errno);
+            return 0 != result;
+        }
 
-    // Encapsulates operations on event kernel object
-    class event: public kernel_object {
-    public:
+        //
+        // Kernel object on Linux is a reference counted object in
+        // this process. HANDLE is a pointer to it, duplicating a
+        // handle adds a reference, and closing it releases one.
+        //
+        class kernel_handle {
+        public:
+            kernel_handle(kernel_object_type type, kernel_object_kind kind, int fd = -1) noexcept
+                : type_{type}
+                , kind_{kind}
+                , fd_{fd}
+                , id_{next_id()} {
+            }
 
-        enum event_type_t : bool { manuel = true, automatic = false};
-        enum event_state_t : bool { signaled = true, unsignaled = false };
+            kernel_handle(kernel_handle const &) = delete;
+            kernel_handle(kernel_handle &&) = delete;
 
-        event() {
-        }
+            kernel_handle &operator=(kernel_handle const &) = delete;
+            kernel_handle &operator=(kernel_handle &&) = delete;
 
-        // Creates event. Last parameter indicates if object with such a name
-        // already exists
-        explicit event(event_type_t event_type,
-                       event_state_t event_state = unsignaled,
-                       LPCTSTR name = nullptr,
-                       LPSECURITY_ATTRIBUTES security_attributes = nullptr,
-                       bool *exists = nullptr) {
-            bool exists_tmp = !create(event_type, event_state, name, security_attributes);
-            if (exists)
-                *exists = exists_tmp;
-        }
+            virtual ~kernel_handle() noexcept {
+                if (0 <= fd_) {
+                    ::close(fd_);
+                }
+            }
 
-        // Opens existing event
-        explicit event(LPCTSTR name, DWORD desired_access = EVENT_MODIFY_STATE, bool inherit = false) {
-            open(name, desired_access, inherit);
-        }
+            void add_ref() noexcept {
+                references_.fetch_add(1, std::memory_order_relaxed);
+            }
 
-        // Duplicating or taking ownership
-        explicit event(HANDLE h,
-                       bool duplicate_handle = false,
-                       DWORD options = DUPLICATE_SAME_ACCESS,
-                       DWORD desired_access = 0,
-                       HANDLE source_process = GetCurrentProcess(),
-                       HANDLE destination_process = GetCurrentProcess(),
-                       bool inheritance = false)
-            : kernel_object(h, duplicate_handle, options, desired_access, source_process, destination_process, inheritance) {
-        }
+            void release() noexcept {
+                if (1 == references_.fetch_sub(1, std::memory_order_acq_rel)) {
+                    delete this;
+                }
+            }
 
-        event(event const &other)
-            : kernel_object(other) {
-        }
+            [[nodiscard]] kernel_object_type type() const noexcept {
+                return type_;
+            }
 
-        event(event &&other) noexcept 
-            : kernel_object(std::move(other)) {
-        }
+            [[nodiscard]] kernel_object_kind kind() const noexcept {
+                return kind_;
+            }
 
-        event &operator=(event const &other) {
-            kernel_object::operator=(other);
-            return *this;
-        }
+            //
+            // -1 for in process objects other than files
+            //
+            [[nodiscard]] int fd() const noexcept {
+                return fd_;
+            }
 
-        event &operator=(event &&other) noexcept {
-            kernel_object::operator=(std::move(other));
-            return *this;
-        }
+            //
+            // Unique for the lifetime of the process, unlike address
+            // of the object or its file descriptor
+            //
+            [[nodiscard]] uint64_t id() const noexcept {
+                return id_;
+            }
 
-        // Creates event. Function returns false if event with such a name
-        // already exists.
-        bool create(event_type_t event_type = manuel,
-                    event_state_t event_state = unsignaled,
-                    LPCTSTR name = nullptr,
-                    LPSECURITY_ATTRIBUTES security_attributes = nullptr) {
-            close();
-            HANDLE h = CreateEvent(
-                security_attributes, WINBOOL(event_type), WINBOOL(event_state), name);
-            DWORD error = GetLastError();
-            AC_THROW_IF(h == nullptr, error, "CreateEvent");
-            bool rc = (ERROR_ALREADY_EXISTS != error);
-            attach(h);
-            return rc;
-        }
+            //
+            // Same as SignalObjectAndWait does for each type: sets
+            // event, releases one count of semaphore or releases mutex
+            //
+            [[nodiscard]] virtual bool signal() noexcept = 0;
+
+            //
+            // Gives back what try_acquire took, so wait for all objects
+            // can back off when it cannot get them all
+            //
+            virtual void undo_acquire(DWORD acquire_result) noexcept = 0;
+
+            //
+            // Consumes signaled state if object has it. Returns
+            // WAIT_OBJECT_0, WAIT_ABANDONED_0, or WAIT_TIMEOUT if
+            // object is not signaled.
+            //
+            [[nodiscard]] virtual DWORD try_acquire() noexcept = 0;
+
+            //
+            // Pollable objects sleep in poll, and consume signaled
+            // state once eventfd becomes readable
+            //
+            [[nodiscard]] virtual DWORD wait(DWORD milliseconds) noexcept {
+                AC_CODDING_ERROR_IF(fd_ < 0);
+                wait_deadline const deadline{milliseconds};
+                for (;;) {
+                    DWORD const result{try_acquire()};
+                    if (WAIT_TIMEOUT != result) {
+                        return result;
+                    }
+                    DWORD const remaining{deadline.remaining()};
+                    if (0 == remaining) {
+                        return WAIT_TIMEOUT;
+                    }
+                    static_cast<void>(poll_readable(fd_, remaining));
+                }
+            }
 
-        void open(LPCTSTR name, DWORD desired_access = EVENT_MODIFY_STATE, bool inherit = false) {
-            close();
-            HANDLE h = OpenEvent(desired_access, WINBOOL(inherit), name);
-            AC_THROW_IF(h == nullptr, GetLastError(), "OpenEvent failed");
-            attach(h);
-        }
+        private:
+            [[nodiscard]] static uint64_t next_id() noexcept {
+                static std::atomic<uint64_t> last_id{0};
+                return last_id.fetch_add(1, std::memory_order_relaxed) + 1;
+            }
 
-        void pulse() {
-            if (!PulseEvent(get_handle())) {
-                AC_CRASH_APPLICATION();
+            std::atomic<long> references_{1};
+            kernel_object_type type_;
+            kernel_object_kind kind_;
+            int fd_;
+            uint64_t id_;
+        };
+
+        class event_handle : public kernel_handle {
+        public:
+            event_handle(kernel_object_kind kind, bool manual_reset, int fd = -1) noexcept
+                : kernel_handle{kernel_object_type::event, kind, fd}
+                , manual_reset_{manual_reset} {
             }
-        }
 
-        void reset() {
-            if (!ResetEvent(get_handle())) {
-                AC_CRASH_APPLICATION();
+            [[nodiscard]] bool is_manual_reset() const noexcept {
+                return manual_reset_;
             }
-        }
 
-        void set() {
-            if (!SetEvent(get_handle())) {
-                AC_CRASH_APPLICATION();
+            virtual void set() noexcept = 0;
+            virtual void reset() noexcept = 0;
+            virtual void pulse() noexcept = 0;
+
+            [[nodiscard]] bool signal() noexcept final {
+                set();
+                return true;
             }
-        }
-    };
 
-    // Encapsulates mutex kernel object. 
-    class mutex : public kernel_object {
-    public:
-        // Creates object. Last parameter indicates if object with such a name
-        // already exists
-        explicit mutex( bool initial_owner = false,
-                        LPCTSTR name = nullptr,
-                        LPSECURITY_ATTRIBUTES security_attributes = nullptr,
-                        bool *exists = nullptr) {
-            bool exists_tmp = !create( initial_owner, name, security_attributes );
-            if (exists) *exists = exists_tmp;
-        }
+            //
+            // Waiting on a manual reset event does not change it
+            //
+            void undo_acquire(DWORD acquire_result) noexcept final {
+                if (!manual_reset_ && WAIT_TIMEOUT != acquire_result) {
+                    set();
+                }
+            }
 
-        // Opens existing object
-        explicit mutex( LPCTSTR name,
-                        DWORD desired_access = MUTEX_MODIFY_STATE,
-                        bool inherit = false ) {
-            open( name, desired_access, inherit );
-        }
+        private:
+            bool manual_reset_;
+        };
+
+        //
+        // Word holds signaled bit and a generation that pulse bumps,
+        // so threads that were waiting at the time of pulse can tell
+        // it happened. Set and reset do not make a syscall when no
+        // thread waits.
+        //
+        class futex_event_handle final : public event_handle {
+        public:
+            futex_event_handle(bool manual_reset, bool initial_state) noexcept
+                : event_handle{kernel_object_kind::in_process, manual_reset}
+                , state_{initial_state ? signaled_bit : 0} {
+            }
 
-        mutex(mutex const & other)
-            : kernel_object(other) {
-        }
+            void set() noexcept override {
+                uint32_t const previous{state_.fetch_or(signaled_bit, std::memory_order_seq_cst)};
+                if (0 == (previous & signaled_bit)) {
+                    wake_waiters();
+                }
+            }
 
-        mutex(mutex && other) noexcept 
-            : kernel_object(std::move(other)) {
-        }
+            void reset() noexcept override {
+                state_.fetch_and(~signaled_bit, std::memory_order_relaxed);
+            }
 
-        mutex &operator= (mutex const & other) {
-            kernel_object::operator=(other);
-            return *this;
-        }
+            //
+            // Pulse of auto reset event leaves a token that only one of
+            // the threads waiting at the moment of the pulse takes.
+            // All of them are woken up, because a thread that started
+            // waiting after the pulse may be first in the futex queue.
+            // Pulses that come before the token is taken release one
+            // thread, same as several sets do.
+            //
+            void pulse() noexcept override {
+                if (!is_manual_reset()) {
+                    pulse_token_.store(true, std::memory_order_relaxed);
+                }
+                uint32_t state{state_.load(std::memory_order_relaxed)};
+                while (!state_.compare_exchange_weak(state,
+                                                     (state & ~signaled_bit) + generation_increment,
+                                                     std::memory_order_seq_cst,
+                                                     std::memory_order_relaxed)) {
+                }
+                if (0 != waiters_.load(std::memory_order_seq_cst)) {
+                    futex_wake(state_address(), INT_MAX);
+                }
+            }
 
-        mutex &operator= (mutex && other) noexcept {
-            kernel_object::operator=(std::move(other));
-            return *this;
-        }
+            [[nodiscard]] DWORD try_acquire() noexcept override {
+                uint32_t state{state_.load(std::memory_order_acquire)};
+                if (is_manual_reset()) {
+                    return (state & signaled_bit) ? WAIT_OBJECT_0 : WAIT_TIMEOUT;
+                }
+                while (state & signaled_bit) {
+                    if (state_.compare_exchange_weak(
+                            state, state & ~signaled_bit, std::memory_order_acquire, std::memory_order_relaxed)) {
+                        return WAIT_OBJECT_0;
+                    }
+                }
+                return WAIT_TIMEOUT;
+            }
 
-        // Creates object. Function returns false if event with such a name already
-        // exists.
-        bool create( bool initial_owner = false,
-                     LPCTSTR name = nullptr,
-                     LPSECURITY_ATTRIBUTES security_attributes = nullptr) {
-            close( );
-            HANDLE h = CreateMutex( security_attributes, WINBOOL( initial_owner ), name );
-            DWORD error = GetLastError( );
-            AC_THROW_IF( h == nullptr, error, "CreateMutex" );
-            bool rc = (error != ERROR_ALREADY_EXISTS);
-            attach( h );
-            return rc;
-        }
+            [[nodiscard]] DWORD wait(DWORD milliseconds) noexcept override {
+                wait_deadline const deadline{milliseconds};
+                uint32_t generation{state_.load(std::memory_order_acquire) & ~signaled_bit};
+                for (;;) {
+                    if (WAIT_OBJECT_0 == try_acquire()) {
+                        return WAIT_OBJECT_0;
+                    }
+                    waiters_.fetch_add(1, std::memory_order_seq_cst);
+                    uint32_t const state{state_.load(std::memory_order_seq_cst)};
+                    DWORD const remaining{deadline.remaining()};
+                    if (state & signaled_bit) {
+                        waiters_.fetch_sub(1, std::memory_order_relaxed);
+                        continue;
+                    }
+                    if (generation != state) {
+                        //
+                        // Event was pulsed. Waiter that did not get the
+                        // token of auto reset event waits for the next
+                        // pulse.
+                        //
+                        waiters_.fetch_sub(1, std::memory_order_relaxed);
+                        if (is_manual_reset() || pulse_token_.exchange(false, std::memory_order_acquire)) {
+                            return WAIT_OBJECT_0;
+                        }
+                        generation = state;
+                        continue;
+                    }
+                    if (0 == remaining) {
+                        waiters_.fetch_sub(1, std::memory_order_relaxed);
+                        return WAIT_TIMEOUT;
+                    }
+                    static_cast<void>(futex_wait(state_address(), state, remaining));
+                    waiters_.fetch_sub(1, std::memory_order_relaxed);
+                }
+            }
 
-        void open( LPCTSTR name,
-                   DWORD desired_access = MUTEX_MODIFY_STATE,
-                   bool inherit = false ) {
-            close( );
-            HANDLE h = OpenMutex( desired_access, WINBOOL( inherit ), name );
-            AC_THROW_IF( h == nullptr, GetLastError( ), "OpenMutex" );
-            attach( h );
-        }
+        private:
+            static constexpr uint32_t signaled_bit{1};
+            static constexpr uint32_t generation_increment{2};
 
-        void release( ) {
-            if (!ReleaseMutex( get_handle( ) )) {
-                AC_CRASH_APPLICATION();
+            void wake_waiters() noexcept {
+                if (0 != waiters_.load(std::memory_order_seq_cst)) {
+                    futex_wake(state_address(), is_manual_reset() ? INT_MAX : 1);
+                }
             }
-        }
-    };
 
-    // Encapsulates operations on semaphore kernel object. 
-    class semaphore : public kernel_object {
-    public:
-        // Creates object. Last parameter indicates if object with such a name
-        // already exists
-        explicit semaphore( long initial_count,
-                            long max_count,
-                            LPCTSTR name = nullptr,
-                            LPSECURITY_ATTRIBUTES security_attributes = nullptr,
-                            bool *exists = nullptr) {
-            bool exists_tmp = !create( initial_count, max_count, name, security_attributes );
-            if (exists) *exists = exists_tmp;
-        }
+            uint32_t const volatile *state_address() const noexcept {
+                return reinterpret_cast<uint32_t const volatile *>(&state_);
+            }
 
-        // Opens existing object
-        explicit semaphore( LPCTSTR name,
-                            DWORD desired_access = SEMAPHORE_MODIFY_STATE,
-                            bool inherit = false ) {
-            open( name, desired_access, inherit );
-        }
+            std::atomic<uint32_t> state_;
+            std::atomic<uint32_t> waiters_{0};
+            std::atomic<bool> pulse_token_{false};
+        };
+
+        //
+        // Event state is kept under the lock, and eventfd is readable
+        // while event is signaled or while a thread that waited at the
+        // time of a pulse has not seen the pulse yet. Poll and epoll
+        // only wake up on the eventfd, and waiter checks the state.
+        //
+        // Pulse bumps generation the same way as in
+        // futex_event_handle. Waiting for multiple objects does not
+        // register thread as a waiter, so it is not released by pulse.
+        //
+        class eventfd_event_handle final : public event_handle {
+        public:
+            eventfd_event_handle(bool manual_reset, bool initial_state)
+                : event_handle{kernel_object_kind::pollable,
+                               manual_reset,
+                               create_eventfd(initial_state ? 1 : 0)}
+                , signaled_{initial_state}
+                , is_readable_{initial_state} {
+            }
 
-        // Creates object. Function returns false if event with such a name already
-        // exists.
-        bool create( long initial_count,
-                     long max_count,
-                     LPCTSTR name = nullptr,
-                     LPSECURITY_ATTRIBUTES security_attributes = nullptr) {
-            close( );
-            HANDLE h = CreateSemaphore( security_attributes, initial_count, max_count, name );
-            DWORD error = GetLastError( );
-            AC_THROW_IF( h == nullptr, error, "CreateSemaphore" );
-            bool rc = (error != ERROR_ALREADY_EXISTS);
-            attach( h );
-            return rc;
-        }
+            void set() noexcept override {
+                fast_mutex::guard const guard{&lock_};
+                signaled_ = true;
+                update_readable();
+            }
 
-        void open( LPCTSTR name,
-                   DWORD desired_access = SEMAPHORE_MODIFY_STATE,
-                   bool inherit = false ) {
-            close( );
-            HANDLE h = OpenSemaphore( desired_access, WINBOOL( inherit ), name );
-            AC_THROW_IF( h == nullptr, GetLastError( ), "OpenSemaphore" );
-            attach( h );
-        }
+            void reset() noexcept override {
+                fast_mutex::guard const guard{&lock_};
+                signaled_ = false;
+                update_readable();
+            }
 
-        bool release( long release_count = 1, long* prev_count = nullptr) {
-            long prev = 0;
-            BOOL rc = ReleaseSemaphore( get_handle( ), release_count, &prev );
-            if (prev_count) {
-                *prev_count = prev;
+            void pulse() noexcept override {
+                fast_mutex::guard const guard{&lock_};
+                signaled_ = false;
+                if (0 != waiters_) {
+                    ++generation_;
+                    unseen_pulse_waiters_ = waiters_;
+                    pulse_token_ = !is_manual_reset();
+                }
+                update_readable();
             }
-            if (!rc) {
-                AC_CRASH_APPLICATION();
+
+            [[nodiscard]] DWORD try_acquire() noexcept override {
+                fast_mutex::guard const guard{&lock_};
+                return try_acquire_locked() ? WAIT_OBJECT_0 : WAIT_TIMEOUT;
+            }
+
+            [[nodiscard]] DWORD wait(DWORD milliseconds) noexcept override {
+                wait_deadline const deadline{milliseconds};
+                fast_mutex::guard guard{&lock_};
+                if (try_acquire_locked()) {
+                    return WAIT_OBJECT_0;
+                }
+                ++waiters_;
+                uint32_t generation{generation_};
+                DWORD result{WAIT_TIMEOUT};
+                for (;;) {
+                    DWORD const remaining{deadline.remaining()};
+                    if (0 == remaining) {
+                        break;
+                    }
+                    guard.release();
+                    static_cast<void>(poll_readable(fd(), remaining));
+                    guard.acquire(&lock_);
+                    if (generation != generation_) {
+                        //
+                        // Event was pulsed. Waiter that did not get the
+                        // token of auto reset event waits for the next
+                        // pulse.
+                        //
+                        generation = generation_;
+                        --unseen_pulse_waiters_;
+                        update_readable();
+                        if (is_manual_reset() || std::exchange(pulse_token_, false)) {
+                            result = WAIT_OBJECT_0;
+                            break;
+                        }
+                    }
+                    if (try_acquire_locked()) {
+                        result = WAIT_OBJECT_0;
+                        break;
+                    }
+                }
+                --waiters_;
+                return result;
+            }
+
+        private:
+            [[nodiscard]] bool try_acquire_locked() noexcept {
+                if (!signaled_) {
+                    return false;
+                }
+                if (!is_manual_reset()) {
+                    signaled_ = false;
+                    update_readable();
+                }
+                return true;
+            }
+
+            void update_readable() noexcept {
+                bool const readable{signaled_ || 0 != unseen_pulse_waiters_};
+                if (readable == is_readable_) {
+                    return;
+                }
+                if (readable) {
+                    eventfd_add(fd(), 1);
+                } else {
+                    static_cast<void>(eventfd_try_read(fd()));
+                }
+                is_readable_ = readable;
+            }
+
+            fast_mutex lock_;
+            bool signaled_;
+            bool is_readable_;
+            bool pulse_token_{false};
+            uint32_t generation_{0};
+            uint32_t waiters_{0};
+            uint32_t unseen_pulse_waiters_{0};
+        };
+
+        class semaphore_handle : public kernel_handle {
+        public:
+            semaphore_handle(kernel_object_kind kind, long max_count, int fd = -1) noexcept
+                : kernel_handle{kernel_object_type::semaphore, kind, fd}
+                , max_count_{max_count} {
+            }
+
+            [[nodiscard]] long max_count() const noexcept {
+                return max_count_;
+            }
+
+            //
+            // Fails with ERROR_TOO_MANY_POSTS if count would go above
+            // the maximum
+            //
+            [[nodiscard]] virtual bool release(long release_count, long *previous_count) noexcept = 0;
+
+            [[nodiscard]] bool signal() noexcept final {
+                return release(1, nullptr);
+            }
+
+            void undo_acquire(DWORD acquire_result) noexcept final {
+                if (WAIT_TIMEOUT != acquire_result) {
+                    static_cast<void>(release(1, nullptr));
+                }
+            }
+
+        protected:
+            //
+            // Adds release count to the counter unless that goes above
+            // the maximum
+            //
+            template<typename C>
+            [[nodiscard]] bool try_add(std::atomic<C> &count, long release_count, long *previous_count) noexcept {
+                AC_CODDING_ERROR_IF(release_count <= 0);
+                C current{count.load(std::memory_order_relaxed)};
+                do {
+                    if (release_count > max_count_ - static_cast<long>(current)) {
+                        errno = ERROR_TOO_MANY_POSTS;
+                        return false;
+                    }
+                } while (!count.compare_exchange_weak(current,
+                                                      static_cast<C>(current + release_count),
+                                                      std::memory_order_seq_cst,
+                                                      std::memory_order_relaxed));
+                if (previous_count) {
+                    *previous_count = static_cast<long>(current);
+                }
+                return true;
+            }
+
+        private:
+            long max_count_;
+        };
+
+        class futex_semaphore_handle final : public semaphore_handle {
+        public:
+            futex_semaphore_handle(long initial_count, long max_count) noexcept
+                : semaphore_handle{kernel_object_kind::in_process, max_count}
+                , count_{static_cast<uint32_t>(initial_count)} {
+            }
+
+            [[nodiscard]] bool release(long release_count, long *previous_count) noexcept override {
+                if (!try_add(count_, release_count, previous_count)) {
+                    return false;
+                }
+                if (0 != waiters_.load(std::memory_order_seq_cst)) {
+                    futex_wake(count_address(), static_cast<int>((std::min)(release_count, static_cast<long>(INT_MAX))));
+                }
+                return true;
+            }
+
+            [[nodiscard]] DWORD try_acquire() noexcept override {
+                uint32_t count{count_.load(std::memory_order_relaxed)};
+                while (0 < count) {
+                    if (count_.compare_exchange_weak(
+                            count, count - 1, std::memory_order_acquire, std::memory_order_relaxed)) {
+                        return WAIT_OBJECT_0;
+                    }
+                }
+                return WAIT_TIMEOUT;
+            }
+
+            [[nodiscard]] DWORD wait(DWORD milliseconds) noexcept override {
+                wait_deadline const deadline{milliseconds};
+                for (;;) {
+                    if (WAIT_OBJECT_0 == try_acquire()) {
+                        return WAIT_OBJECT_0;
+                    }
+                    waiters_.fetch_add(1, std::memory_order_seq_cst);
+                    uint32_t const count{count_.load(std::memory_order_seq_cst)};
+                    DWORD const remaining{deadline.remaining()};
+                    if (0 == count && 0 != remaining) {
+                        static_cast<void>(futex_wait(count_address(), 0, remaining));
+                    }
+                    waiters_.fetch_sub(1, std::memory_order_relaxed);
+                    if (0 == count && 0 == remaining) {
+                        return WAIT_TIMEOUT;
+                    }
+                }
+            }
+
+        private:
+            uint32_t const volatile *count_address() const noexcept {
+                return reinterpret_cast<uint32_t const volatile *>(&count_);
+            }
+
+            std::atomic<uint32_t> count_;
+            std::atomic<uint32_t> waiters_{0};
+        };
+
+        //
+        // Eventfd in semaphore mode, each read takes one count. Counter
+        // is mirrored in user mode to enforce the maximum count.
+        //
+        class eventfd_semaphore_handle final : public semaphore_handle {
+        public:
+            eventfd_semaphore_handle(long initial_count, long max_count)
+                : semaphore_handle{kernel_object_kind::pollable,
+                                   max_count,
+                                   create_eventfd(static_cast<unsigned int>(initial_count), EFD_SEMAPHORE)}
+                , count_{initial_count} {
+            }
+
+            [[nodiscard]] bool release(long release_count, long *previous_count) noexcept override {
+                if (!try_add(count_, release_count, previous_count)) {
+                    return false;
+                }
+                eventfd_add(fd(), static_cast<uint64_t>(release_count));
+                return true;
+            }
+
+            [[nodiscard]] DWORD try_acquire() noexcept override {
+                if (!eventfd_try_read(fd())) {
+                    return WAIT_TIMEOUT;
+                }
+                count_.fetch_sub(1, std::memory_order_relaxed);
+                return WAIT_OBJECT_0;
+            }
+
+        private:
+            std::atomic<long> count_;
+        };
+
+        class mutex_handle;
+
+        //
+        // Mutexes owned by a thread. If thread exits without
+        // releasing them, they are abandoned, and the next owner
+        // gets WAIT_ABANDONED_0.
+        //
+        class owned_mutexes {
+        public:
+            owned_mutexes() noexcept {
+            }
+
+            owned_mutexes(owned_mutexes const &) = delete;
+            owned_mutexes &operator=(owned_mutexes const &) = delete;
+
+            ~owned_mutexes() noexcept;
+
+            void push(mutex_handle *mutex) noexcept;
+
+            void remove(mutex_handle *mutex) noexcept;
+
+            [[nodiscard]] static owned_mutexes &current() noexcept {
+                thread_local owned_mutexes mutexes;
+                return mutexes;
+            }
+
+        private:
+            mutex_handle *head_{nullptr};
+        };
+
+        //
+        // Recursive mutex owned by a thread. Derived classes provide
+        // the lock, this class tracks ownership.
+        //
+        class mutex_handle : public kernel_handle {
+        public:
+            explicit mutex_handle(kernel_object_kind kind, int fd = -1) noexcept
+                : kernel_handle{kernel_object_type::mutex, kind, fd} {
+            }
+
+            [[nodiscard]] DWORD try_acquire() noexcept final {
+                DWORD const thread_id{current_thread_id()};
+                if (thread_id == owner_.load(std::memory_order_relaxed)) {
+                    ++recursion_;
+                    return WAIT_OBJECT_0;
+                }
+                if (!try_lock()) {
+                    return WAIT_TIMEOUT;
+                }
+                return acquired(thread_id);
+            }
+
+            [[nodiscard]] DWORD wait(DWORD milliseconds) noexcept final {
+                DWORD const thread_id{current_thread_id()};
+                if (thread_id == owner_.load(std::memory_order_relaxed)) {
+                    ++recursion_;
+                    return WAIT_OBJECT_0;
+                }
+                if (!lock(milliseconds)) {
+                    return WAIT_TIMEOUT;
+                }
+                return acquired(thread_id);
+            }
+
+            //
+            // Fails if calling thread does not own the mutex
+            //
+            [[nodiscard]] bool release() noexcept {
+                if (current_thread_id() != owner_.load(std::memory_order_relaxed)) {
+                    errno = EPERM;
+                    return false;
+                }
+                if (0 == --recursion_) {
+                    release_ownership();
+                }
+                return true;
+            }
+
+            [[nodiscard]] bool is_owned_by_current_thread() const noexcept {
+                return current_thread_id() == owner_.load(std::memory_order_relaxed);
+            }
+
+            [[nodiscard]] bool signal() noexcept final {
+                return release();
+            }
+
+            //
+            // Next owner still needs to learn that mutex was abandoned
+            //
+            void undo_acquire(DWORD acquire_result) noexcept final {
+                if (WAIT_TIMEOUT == acquire_result) {
+                    return;
+                }
+                if (1 == recursion_ && WAIT_ABANDONED_0 == acquire_result) {
+                    abandoned_ = true;
+                }
+                static_cast<void>(release());
+            }
+
+        protected:
+            [[nodiscard]] virtual bool try_lock() noexcept = 0;
+            [[nodiscard]] virtual bool lock(DWORD milliseconds) noexcept = 0;
+            virtual void unlock() noexcept = 0;
+
+        private:
+            friend class owned_mutexes;
+
+            //
+            // Mutex holds a reference to itself while it is owned,
+            // so owner can close its handle and still release it,
+            // or abandon it on exit
+            //
+            [[nodiscard]] DWORD acquired(DWORD thread_id) noexcept {
+                owner_.store(thread_id, std::memory_order_relaxed);
+                recursion_ = 1;
+                add_ref();
+                owned_mutexes::current().push(this);
+                if (abandoned_) {
+                    abandoned_ = false;
+                    return WAIT_ABANDONED_0;
+                }
+                return WAIT_OBJECT_0;
+            }
+
+            void release_ownership() noexcept {
+                owned_mutexes::current().remove(this);
+                owner_.store(0, std::memory_order_relaxed);
+                unlock();
+                kernel_handle::release();
+            }
+
+            void abandon() noexcept {
+                abandoned_ = true;
+                recursion_ = 0;
+                release_ownership();
+            }
+
+            std::atomic<DWORD> owner_{0};
+            //
+            // Changed only by the owner
+            //
+            uint32_t recursion_{0};
+            bool abandoned_{false};
+            mutex_handle *next_owned_{nullptr};
+            mutex_handle *previous_owned_{nullptr};
+        };
+
+        inline owned_mutexes::~owned_mutexes() noexcept {
+            while (head_) {
+                head_->abandon();
+            }
+        }
+
+        inline void owned_mutexes::push(mutex_handle *mutex) noexcept {
+            mutex->previous_owned_ = nullptr;
+            mutex->next_owned_ = head_;
+            if (head_) {
+                head_->previous_owned_ = mutex;
+            }
+            head_ = mutex;
+        }
+
+        inline void owned_mutexes::remove(mutex_handle *mutex) noexcept {
+            if (mutex->previous_owned_) {
+                mutex->previous_owned_->next_owned_ = mutex->next_owned_;
+            } else {
+                head_ = mutex->next_owned_;
+            }
+            if (mutex->next_owned_) {
+                mutex->next_owned_->previous_owned_ = mutex->previous_owned_;
+            }
+            mutex->next_owned_ = nullptr;
+            mutex->previous_owned_ = nullptr;
+        }
+
+        //
+        // 0 - unlocked, 1 - locked, 2 - locked and there might be
+        // waiters
+        //
+        class futex_mutex_handle final : public mutex_handle {
+        public:
+            futex_mutex_handle() noexcept
+                : mutex_handle{kernel_object_kind::in_process} {
+            }
+
+        protected:
+            [[nodiscard]] bool try_lock() noexcept override {
+                uint32_t expected{0};
+                return state_.compare_exchange_strong(
+                    expected, 1, std::memory_order_acquire, std::memory_order_relaxed);
+            }
+
+            [[nodiscard]] bool lock(DWORD milliseconds) noexcept override {
+                if (try_lock()) {
+                    return true;
+                }
+                wait_deadline const deadline{milliseconds};
+                while (0 != state_.exchange(2, std::memory_order_acquire)) {
+                    DWORD const remaining{deadline.remaining()};
+                    if (0 == remaining) {
+                        return false;
+                    }
+                    static_cast<void>(futex_wait(state_address(), 2, remaining));
+                }
+                return true;
+            }
+
+            void unlock() noexcept override {
+                if (2 == state_.exchange(0, std::memory_order_release)) {
+                    futex_wake(state_address(), 1);
+                }
+            }
+
+        private:
+            uint32_t const volatile *state_address() const noexcept {
+                return reinterpret_cast<uint32_t const volatile *>(&state_);
+            }
+
+            std::atomic<uint32_t> state_{0};
+        };
+
+        //
+        // Eventfd in semaphore mode with a single count
+        //
+        class eventfd_mutex_handle final : public mutex_handle {
+        public:
+            eventfd_mutex_handle()
+                : mutex_handle{kernel_object_kind::pollable, create_eventfd(1, EFD_SEMAPHORE)} {
+            }
+
+        protected:
+            [[nodiscard]] bool try_lock() noexcept override {
+                return eventfd_try_read(fd());
+            }
+
+            [[nodiscard]] bool lock(DWORD milliseconds) noexcept override {
+                wait_deadline const deadline{milliseconds};
+                for (;;) {
+                    if (try_lock()) {
+                        return true;
+                    }
+                    DWORD const remaining{deadline.remaining()};
+                    if (0 == remaining) {
+                        return false;
+                    }
+                    static_cast<void>(poll_readable(fd(), remaining));
+                }
+            }
+
+            void unlock() noexcept override {
+                eventfd_add(fd(), 1);
+            }
+        };
+
+    } // namespace details
+
+    [[nodiscard]] inline DWORD wait_single_object(HANDLE h, DWORD milliseconds = INFINITE) {
+        AC_CODDING_ERROR_IF(nullptr == h);
+        return h->wait(milliseconds);
+    }
+
+    //
+    // There are no APCs on Linux, so alertable wait is the same as
+    // a regular wait
+    //
+    [[nodiscard]] inline DWORD wait_single_object_ex(HANDLE h,
+                                                     DWORD milliseconds = INFINITE,
+                                                     bool alertable = true) {
+        (void)alertable;
+        return wait_single_object(h, milliseconds);
+    }
+
+    //
+    // Set of pollable objects registered with an epoll instance
+    // once, so waits on the same objects do not register them with
+    // the kernel again. Caller keeps objects open while they are in
+    // the set, same as handles passed to WaitForMultipleObjects.
+    //
+    // Wait for any object returns the lowest index among signaled
+    // objects. Wait for all objects acquires all or nothing. When it
+    // cannot get them all it gives back what it took and sleeps on
+    // the object that was not signaled, so other waiters can see
+    // an auto reset event or a semaphore briefly taken.
+    //
+    class wait_set {
+    public:
+        wait_set()
+            : epoll_fd_{::epoll_create1(EPOLL_CLOEXEC)} {
+            AC_THROW_IF(-1 == epoll_fd_, errno, "epoll_create1");
+        }
+
+        wait_set(HANDLE const *h, DWORD handles_count)
+            : wait_set{} {
+            assign(h, handles_count);
+        }
+
+        template<DWORD N>
+        explicit wait_set(HANDLE (&h)[N])
+            : wait_set{h, N} {
+        }
+
+        wait_set(wait_set const &) = delete;
+        wait_set(wait_set &&) = delete;
+
+        wait_set &operator=(wait_set const &) = delete;
+        wait_set &operator=(wait_set &&) = delete;
+
+        ~wait_set() noexcept {
+            ::close(epoll_fd_);
+        }
+
+        void assign(HANDLE const *h, DWORD handles_count) {
+            clear();
+            for (DWORD index = 0; index < handles_count; ++index) {
+                add(h[index]);
+            }
+        }
+
+        //
+        // Returns index of the object in the set
+        //
+        DWORD add(HANDLE h) {
+            AC_CODDING_ERROR_IF(nullptr == h);
+            AC_CODDING_ERROR_IF_NOT(kernel_object_kind::pollable == h->kind());
+            AC_THROW_IF(MAXIMUM_WAIT_OBJECTS <= entries_.size(), ERROR_INVALID_PARAMETER, "wait_set");
+            DWORD const index{static_cast<DWORD>(entries_.size())};
+            entries_.push_back(entry{h, h->id(), h->fd()});
+            epoll_event event{};
+            event.events = EPOLLIN;
+            event.data.u32 = index;
+            if (-1 == ::epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, h->fd(), &event)) {
+                int const error{errno};
+                entries_.pop_back();
+                AC_THROW(error, "epoll_ctl");
+            }
+            return index;
+        }
+
+        void clear() noexcept {
+            for (entry const &e : entries_) {
+                //
+                // Descriptor of an object that was closed is already
+                // gone from the set
+                //
+                static_cast<void>(::epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, e.fd, nullptr));
+            }
+            entries_.clear();
+        }
+
+        [[nodiscard]] DWORD size() const noexcept {
+            return static_cast<DWORD>(entries_.size());
+        }
+
+        //
+        // True if set has exactly these objects in this order
+        //
+        [[nodiscard]] bool is_same(HANDLE const *h, DWORD handles_count) const noexcept {
+            if (handles_count != entries_.size()) {
+                return false;
+            }
+            for (DWORD index = 0; index < handles_count; ++index) {
+                if (h[index] != entries_[index].h || h[index]->id() != entries_[index].id) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        //
+        // Returns WAIT_OBJECT_0 + index, WAIT_ABANDONED_0 + index or
+        // WAIT_TIMEOUT, same as WaitForMultipleObjects
+        //
+        [[nodiscard]] DWORD wait(DWORD milliseconds = INFINITE, bool wait_all = false) noexcept {
+            AC_CODDING_ERROR_IF(entries_.empty());
+            return wait_all ? wait_for_all(milliseconds) : wait_for_any(milliseconds);
+        }
+
+    private:
+        struct entry {
+            HANDLE h;
+            uint64_t id;
+            int fd;
+        };
+
+        //
+        // Readiness only wakes us up. Owned mutex is not readable even
+        // for its owner, and another thread can consume a signal between
+        // the wake and our attempt, so every pass tries all objects in
+        // index order and the lowest one that is signaled wins.
+        //
+        [[nodiscard]] DWORD wait_for_any(DWORD milliseconds) noexcept {
+            wait_deadline const deadline{milliseconds};
+            epoll_event events[MAXIMUM_WAIT_OBJECTS];
+            DWORD const handles_count{size()};
+            for (;;) {
+                for (DWORD index = 0; index < handles_count; ++index) {
+                    DWORD const result{entries_[index].h->try_acquire()};
+                    if (WAIT_TIMEOUT != result) {
+                        return result + index;
+                    }
+                }
+                DWORD const remaining{deadline.remaining()};
+                if (0 == remaining) {
+                    return WAIT_TIMEOUT;
+                }
+                int const timeout{INFINITE == remaining
+                                      ? -1
+                                      : static_cast<int>((std::min)(remaining, static_cast<DWORD>(INT_MAX)))};
+                int const events_count{::epoll_wait(epoll_fd_, events, MAXIMUM_WAIT_OBJECTS, timeout)};
+                AC_CODDING_ERROR_IF(-1 == events_count && EINTR != errno);
+            }
+        }
+
+        [[nodiscard]] DWORD wait_for_all(DWORD milliseconds) noexcept {
+            wait_deadline const deadline{milliseconds};
+            DWORD results[MAXIMUM_WAIT_OBJECTS];
+            DWORD const handles_count{size()};
+            for (;;) {
+                DWORD index{0};
+                for (; index < handles_count; ++index) {
+                    results[index] = entries_[index].h->try_acquire();
+                    if (WAIT_TIMEOUT == results[index]) {
+                        break;
+                    }
+                }
+                if (handles_count == index) {
+                    for (DWORD i = 0; i < handles_count; ++i) {
+                        if (WAIT_ABANDONED_0 == results[i]) {
+                            return WAIT_ABANDONED_0 + i;
+                        }
+                    }
+                    return WAIT_OBJECT_0;
+                }
+                DWORD const missing{index};
+                while (0 < index) {
+                    --index;
+                    entries_[index].h->undo_acquire(results[index]);
+                }
+                DWORD const remaining{deadline.remaining()};
+                if (0 == remaining) {
+                    return WAIT_TIMEOUT;
+                }
+                static_cast<void>(details::poll_readable(entries_[missing].fd, remaining));
+            }
+        }
+
+        int epoll_fd_;
+        std::vector<entry> entries_;
+    };
+
+    //
+    // Objects have to be pollable unless there is only one of them.
+    // Each thread keeps the set it waited on last time, so a loop
+    // that waits on the same array reuses it.
+    //
+    [[nodiscard]] inline DWORD wait_multiple_objects(HANDLE const *h,
+                                                     DWORD handles_count,
+                                                     DWORD milliseconds = INFINITE,
+                                                     bool wait_all = false) {
+        verify_handles(h, handles_count);
+        AC_CODDING_ERROR_IF(0 == handles_count || MAXIMUM_WAIT_OBJECTS < handles_count);
+        if (1 == handles_count) {
+            return wait_single_object(h[0], milliseconds);
+        }
+        thread_local wait_set last_wait_set;
+        if (!last_wait_set.is_same(h, handles_count)) {
+            last_wait_set.assign(h, handles_count);
+        }
+        return last_wait_set.wait(milliseconds, wait_all);
+    }
+
+    template<DWORD N>
+    [[nodiscard]] inline DWORD wait_multiple_objects(HANDLE (&h)[N],
+                                                     DWORD milliseconds = INFINITE,
+                                                     bool wait_all = false) {
+        return wait_multiple_objects(h, N, milliseconds, wait_all);
+    }
+
+    [[nodiscard]] inline DWORD wait_multiple_objects_ex(HANDLE const *h,
+                                                        DWORD handles_count,
+                                                        DWORD milliseconds = INFINITE,
+                                                        bool wait_all = false,
+                                                        bool alertable = true) {
+        (void)alertable;
+        return wait_multiple_objects(h, handles_count, milliseconds, wait_all);
+    }
+
+    template<DWORD N>
+    [[nodiscard]] inline DWORD wait_multiple_objects_ex(HANDLE (&h)[N],
+                                                        DWORD milliseconds = INFINITE,
+                                                        bool wait_all = false,
+                                                        bool alertable = true) {
+        return wait_multiple_objects_ex(h, N, milliseconds, wait_all, alertable);
+    }
+
+    //
+    // Signal and wait are two steps, unlike SignalObjectAndWait
+    //
+    [[nodiscard]] inline DWORD signale_and_wait(HANDLE signal_handle,
+                                                HANDLE wait_handle,
+                                                DWORD milliseconds = INFINITE,
+                                                bool alertable = true) {
+        AC_CODDING_ERROR_IF(nullptr == signal_handle);
+        AC_CODDING_ERROR_IF(nullptr == wait_handle);
+        AC_CODDING_ERROR_IF_NOT(signal_handle->signal());
+        return wait_single_object_ex(wait_handle, milliseconds, alertable);
+    }
+
+    class kernel_object {
+    public:
+        kernel_object() noexcept
+            : h_{nullptr} {
+        }
+
+        explicit kernel_object(HANDLE h, bool duplicate_handle = false)
+            : h_(nullptr) {
+            if (duplicate_handle) {
+                if (h != nullptr) {
+                    duplicate(h);
+                }
+            } else {
+                attach(h);
+            }
+        }
+
+        //
+        // Same as on Windows, copies are made with duplicate(), and
+        // shared_kernel_object passes one reference around
+        //
+        kernel_object(kernel_object const &) = delete;
+
+        kernel_object(kernel_object &&ko) noexcept
+            : h_(ko.h_) {
+            ko.h_ = nullptr;
+        }
+
+        virtual ~kernel_object() noexcept {
+            close();
+        }
+
+        kernel_object &operator=(kernel_object &&ko) noexcept {
+            if (this != &ko) {
+                close();
+                h_ = ko.h_;
+                ko.h_ = nullptr;
+            }
+            return *this;
+        }
+
+        kernel_object &operator=(kernel_object const &) = delete;
+
+        void close() noexcept {
+            if (is_valid()) {
+                h_->release();
+                h_ = nullptr;
+            }
+        }
+
+        [[nodiscard]] bool is_valid() const noexcept {
+            return h_ != nullptr;
+        }
+
+        explicit operator bool() const noexcept {
+            return is_valid();
+        }
+
+        [[nodiscard]] HANDLE get_handle() const noexcept {
+            return h_;
+        }
+
+        [[nodiscard]] HANDLE get_handle() noexcept {
+            return h_;
+        }
+
+        void attach(HANDLE h) noexcept {
+            close();
+            h_ = h;
+        }
+
+        [[nodiscard]] HANDLE detach() noexcept {
+            HANDLE th = h_;
+            h_ = nullptr;
+            return th;
+        }
+
+        //
+        // Duplicate refers to the same object, same as a duplicated
+        // handle on Windows
+        //
+        void duplicate(HANDLE h) noexcept {
+            AC_CODDING_ERROR_IF(nullptr == h);
+            h->add_ref();
+            close();
+            h_ = h;
+        }
+
+        void duplicate(kernel_object const &ko) noexcept {
+            duplicate(ko.h_);
+        }
+
+        [[nodiscard]] kernel_object duplicate() const noexcept {
+            return kernel_object{h_, true};
+        }
+
+        [[nodiscard]] DWORD wait(DWORD milliseconds = INFINITE) const noexcept {
+            return wait_single_object(h_, milliseconds);
+        }
+
+        [[nodiscard]] DWORD wait_ex(DWORD milliseconds = INFINITE,
+                                    bool alertable = true) const noexcept {
+            return wait_single_object_ex(h_, milliseconds, alertable);
+        }
+
+        [[nodiscard]] bool is_pollable() const noexcept {
+            return is_valid() && kernel_object_kind::pollable == h_->kind();
+        }
+
+        void swap(kernel_object &other) noexcept {
+            HANDLE h = other.h_;
+            other.h_ = h_;
+            h_ = h;
+        }
+
+        bool is_same_object(HANDLE h) const noexcept {
+            return h_ == h;
+        }
+
+        bool is_same_object(kernel_object const &rhs) const noexcept {
+            return h_ == rhs.h_;
+        }
+
+    private:
+        HANDLE h_;
+    };
+
+#endif // AC_PLATFORM_LINUX
+
+    inline void swap(kernel_object &lhs, kernel_object &rhs) noexcept {
+        lhs.swap(rhs);
+    }
+
+    inline bool operator==(kernel_object const &lhs, kernel_object const &rhs) noexcept {
+        return lhs.get_handle() == rhs.get_handle();
+    }
+
+    inline bool operator!=(kernel_object const &lhs, kernel_object const &rhs) noexcept {
+        return lhs.get_handle() != rhs.get_handle();
+    }
+
+    inline bool operator<(kernel_object const &lhs, kernel_object const &rhs) noexcept {
+        return lhs.get_handle() < rhs.get_handle();
+    }
+
+    inline bool operator<=(kernel_object const &lhs, kernel_object const &rhs) noexcept {
+        return lhs.get_handle() <= rhs.get_handle();
+    }
+
+    inline bool operator>(kernel_object const &lhs, kernel_object const &rhs) noexcept {
+        return lhs.get_handle() > rhs.get_handle();
+    }
+
+    inline bool operator>=(kernel_object const &lhs, kernel_object const &rhs) noexcept {
+        return lhs.get_handle() >= rhs.get_handle();
+    }
+
+#if AC_PLATFORM_WINDOWS
+    // Encapsulates operations on event kernel object
+    class event: public kernel_object {
+    public:
+
+        enum event_type_t : bool { manuel = true, automatic = false};
+        enum event_state_t : bool { signaled = true, unsignaled = false };
+
+        event() {
+        }
+
+        // Creates event. Last parameter indicates if object with such a name
+        // already exists
+        explicit event(event_type_t event_type,
+                       event_state_t event_state = unsignaled,
+                       LPCTSTR name = nullptr,
+                       LPSECURITY_ATTRIBUTES security_attributes = nullptr,
+                       bool *exists = nullptr) {
+            bool exists_tmp = !create(event_type, event_state, name, security_attributes);
+            if (exists)
+                *exists = exists_tmp;
+        }
+
+        // Opens existing event
+        explicit event(LPCTSTR name, DWORD desired_access = EVENT_MODIFY_STATE, bool inherit = false) {
+            open(name, desired_access, inherit);
+        }
+
+        // Duplicating or taking ownership
+        explicit event(HANDLE h,
+                       bool duplicate_handle = false,
+                       DWORD options = DUPLICATE_SAME_ACCESS,
+                       DWORD desired_access = 0,
+                       HANDLE source_process = GetCurrentProcess(),
+                       HANDLE destination_process = GetCurrentProcess(),
+                       bool inheritance = false)
+            : kernel_object(h, duplicate_handle, options, desired_access, source_process, destination_process, inheritance) {
+        }
+
+        event(event &&other) noexcept 
+            : kernel_object(std::move(other)) {
+        }
+
+        event &operator=(event &&other) noexcept {
+            kernel_object::operator=(std::move(other));
+            return *this;
+        }
+
+        using kernel_object::duplicate;
+
+        [[nodiscard]] event duplicate() const {
+            return event{get_handle(), true};
+        }
+
+        // Creates event. Function returns false if event with such a name
+        // already exists.
+        bool create(event_type_t event_type = manuel,
+                    event_state_t event_state = unsignaled,
+                    LPCTSTR name = nullptr,
+                    LPSECURITY_ATTRIBUTES security_attributes = nullptr) {
+            close();
+            HANDLE h = CreateEvent(
+                security_attributes, WINBOOL(event_type), WINBOOL(event_state), name);
+            DWORD error = GetLastError();
+            AC_THROW_IF(h == nullptr, error, "CreateEvent");
+            bool rc = (ERROR_ALREADY_EXISTS != error);
+            attach(h);
+            return rc;
+        }
+
+        void open(LPCTSTR name, DWORD desired_access = EVENT_MODIFY_STATE, bool inherit = false) {
+            close();
+            HANDLE h = OpenEvent(desired_access, WINBOOL(inherit), name);
+            AC_THROW_IF(h == nullptr, GetLastError(), "OpenEvent failed");
+            attach(h);
+        }
+
+        void pulse() {
+            if (!PulseEvent(get_handle())) {
+                AC_CRASH_APPLICATION();
+            }
+        }
+
+        void reset() {
+            if (!ResetEvent(get_handle())) {
+                AC_CRASH_APPLICATION();
+            }
+        }
+
+        void set() {
+            if (!SetEvent(get_handle())) {
+                AC_CRASH_APPLICATION();
+            }
+        }
+    };
+
+    // Encapsulates mutex kernel object. 
+    class mutex : public kernel_object {
+    public:
+        // Creates object. Last parameter indicates if object with such a name
+        // already exists
+        explicit mutex( bool initial_owner = false,
+                        LPCTSTR name = nullptr,
+                        LPSECURITY_ATTRIBUTES security_attributes = nullptr,
+                        bool *exists = nullptr) {
+            bool exists_tmp = !create( initial_owner, name, security_attributes );
+            if (exists) *exists = exists_tmp;
+        }
+
+        // Opens existing object
+        explicit mutex( LPCTSTR name,
+                        DWORD desired_access = MUTEX_MODIFY_STATE,
+                        bool inherit = false ) {
+            open( name, desired_access, inherit );
+        }
+
+        // Duplicating or taking ownership
+        explicit mutex( HANDLE h,
+                        bool duplicate_handle = false,
+                        DWORD options = DUPLICATE_SAME_ACCESS,
+                        DWORD desired_access = 0,
+                        HANDLE source_process = GetCurrentProcess( ),
+                        HANDLE destination_process = GetCurrentProcess( ),
+                        bool inheritance = false )
+            : kernel_object( h, duplicate_handle, options, desired_access, source_process, destination_process, inheritance ) {
+        }
+
+        mutex(mutex && other) noexcept 
+            : kernel_object(std::move(other)) {
+        }
+
+        mutex &operator= (mutex && other) noexcept {
+            kernel_object::operator=(std::move(other));
+            return *this;
+        }
+
+        using kernel_object::duplicate;
+
+        [[nodiscard]] mutex duplicate( ) const {
+            return mutex{ get_handle( ), true };
+        }
+
+        // Creates object. Function returns false if event with such a name already
+        // exists.
+        bool create( bool initial_owner = false,
+                     LPCTSTR name = nullptr,
+                     LPSECURITY_ATTRIBUTES security_attributes = nullptr) {
+            close( );
+            HANDLE h = CreateMutex( security_attributes, WINBOOL( initial_owner ), name );
+            DWORD error = GetLastError( );
+            AC_THROW_IF( h == nullptr, error, "CreateMutex" );
+            bool rc = (error != ERROR_ALREADY_EXISTS);
+            attach( h );
+            return rc;
+        }
+
+        void open( LPCTSTR name,
+                   DWORD desired_access = MUTEX_MODIFY_STATE,
+                   bool inherit = false ) {
+            close( );
+            HANDLE h = OpenMutex( desired_access, WINBOOL( inherit ), name );
+            AC_THROW_IF( h == nullptr, GetLastError( ), "OpenMutex" );
+            attach( h );
+        }
+
+        void release( ) {
+            if (!ReleaseMutex( get_handle( ) )) {
+                AC_CRASH_APPLICATION();
+            }
+        }
+    };
+
+    // Encapsulates operations on semaphore kernel object. 
+    class semaphore : public kernel_object {
+    public:
+        // Creates object. Last parameter indicates if object with such a name
+        // already exists
+        explicit semaphore( long initial_count,
+                            long max_count,
+                            LPCTSTR name = nullptr,
+                            LPSECURITY_ATTRIBUTES security_attributes = nullptr,
+                            bool *exists = nullptr) {
+            bool exists_tmp = !create( initial_count, max_count, name, security_attributes );
+            if (exists) *exists = exists_tmp;
+        }
+
+        // Opens existing object
+        explicit semaphore( LPCTSTR name,
+                            DWORD desired_access = SEMAPHORE_MODIFY_STATE,
+                            bool inherit = false ) {
+            open( name, desired_access, inherit );
+        }
+
+        // Duplicating or taking ownership
+        explicit semaphore( HANDLE h,
+                            bool duplicate_handle = false,
+                            DWORD options = DUPLICATE_SAME_ACCESS,
+                            DWORD desired_access = 0,
+                            HANDLE source_process = GetCurrentProcess( ),
+                            HANDLE destination_process = GetCurrentProcess( ),
+                            bool inheritance = false )
+            : kernel_object( h, duplicate_handle, options, desired_access, source_process, destination_process, inheritance ) {
+        }
+
+        semaphore(semaphore && other) noexcept 
+            : kernel_object(std::move(other)) {
+        }
+
+        semaphore &operator= (semaphore && other) noexcept {
+            kernel_object::operator=(std::move(other));
+            return *this;
+        }
+
+        using kernel_object::duplicate;
+
+        [[nodiscard]] semaphore duplicate( ) const {
+            return semaphore{ get_handle( ), true };
+        }
+
+        // Creates object. Function returns false if event with such a name already
+        // exists.
+        bool create( long initial_count,
+                     long max_count,
+                     LPCTSTR name = nullptr,
+                     LPSECURITY_ATTRIBUTES security_attributes = nullptr) {
+            close( );
+            HANDLE h = CreateSemaphore( security_attributes, initial_count, max_count, name );
+            DWORD error = GetLastError( );
+            AC_THROW_IF( h == nullptr, error, "CreateSemaphore" );
+            bool rc = (error != ERROR_ALREADY_EXISTS);
+            attach( h );
+            return rc;
+        }
+
+        void open( LPCTSTR name,
+                   DWORD desired_access = SEMAPHORE_MODIFY_STATE,
+                   bool inherit = false ) {
+            close( );
+            HANDLE h = OpenSemaphore( desired_access, WINBOOL( inherit ), name );
+            AC_THROW_IF( h == nullptr, GetLastError( ), "OpenSemaphore" );
+            attach( h );
+        }
+
+        bool release( long release_count = 1, long* prev_count = nullptr) {
+            long prev = 0;
+            BOOL rc = ReleaseSemaphore( get_handle( ), release_count, &prev );
+            if (prev_count) {
+                *prev_count = prev;
+            }
+            if (!rc) {
+                AC_CRASH_APPLICATION();
             }
             return CPPBOOL( rc );
         }
     };
 
+#else // AC_PLATFORM_LINUX
+
+    //
+    // Event, mutex and semaphore exist only in this process, there
+    // are no named objects. Pollable objects can be waited on together
+    // with other objects, in process ones cost no syscalls while
+    // nobody waits.
+    //
+    class event : public kernel_object {
+    public:
+        enum event_type_t : bool { manuel = true, automatic = false };
+        enum event_state_t : bool { signaled = true, unsignaled = false };
+
+        event() {
+        }
+
+        explicit event(event_type_t event_type,
+                       event_state_t event_state = unsignaled,
+                       kernel_object_kind kind = kernel_object_kind::pollable) {
+            create(event_type, event_state, kind);
+        }
+
+        // Duplicating or taking ownership
+        explicit event(HANDLE h, bool duplicate_handle = false)
+            : kernel_object(h, duplicate_handle) {
+            AC_CODDING_ERROR_IF(is_valid() && kernel_object_type::event != get_handle()->type());
+        }
+
+        event(event &&other) noexcept
+            : kernel_object(std::move(other)) {
+        }
+
+        event &operator=(event &&other) noexcept {
+            kernel_object::operator=(std::move(other));
+            return *this;
+        }
+
+        using kernel_object::duplicate;
+
+        [[nodiscard]] event duplicate() const noexcept {
+            return event{get_handle(), true};
+        }
+
+        // Always returns true, there are no named objects
+        bool create(event_type_t event_type = manuel,
+                    event_state_t event_state = unsignaled,
+                    kernel_object_kind kind = kernel_object_kind::pollable) {
+            close();
+            if (kernel_object_kind::pollable == kind) {
+                attach(new details::eventfd_event_handle{CPPBOOL(event_type), CPPBOOL(event_state)});
+            } else {
+                attach(new details::futex_event_handle{CPPBOOL(event_type), CPPBOOL(event_state)});
+            }
+            return true;
+        }
+
+        void pulse() noexcept {
+            handle()->pulse();
+        }
+
+        void reset() noexcept {
+            handle()->reset();
+        }
+
+        void set() noexcept {
+            handle()->set();
+        }
+
+    private:
+        [[nodiscard]] details::event_handle *handle() const noexcept {
+            AC_CODDING_ERROR_IF_NOT(is_valid());
+            return static_cast<details::event_handle *>(get_handle());
+        }
+    };
+
+    // Recursive mutex owned by a thread. If owner exits without
+    // releasing it, next wait returns WAIT_ABANDONED_0.
+    class mutex : public kernel_object {
+    public:
+        explicit mutex(bool initial_owner = false, kernel_object_kind kind = kernel_object_kind::pollable) {
+            create(initial_owner, kind);
+        }
+
+        // Duplicating or taking ownership
+        explicit mutex(HANDLE h, bool duplicate_handle = false)
+            : kernel_object(h, duplicate_handle) {
+            AC_CODDING_ERROR_IF(is_valid() && kernel_object_type::mutex != get_handle()->type());
+        }
+
+        mutex(mutex &&other) noexcept
+            : kernel_object(std::move(other)) {
+        }
+
+        mutex &operator=(mutex &&other) noexcept {
+            kernel_object::operator=(std::move(other));
+            return *this;
+        }
+
+        using kernel_object::duplicate;
+
+        [[nodiscard]] mutex duplicate() const noexcept {
+            return mutex{get_handle(), true};
+        }
+
+        // Always returns true, there are no named objects
+        bool create(bool initial_owner = false, kernel_object_kind kind = kernel_object_kind::pollable) {
+            close();
+            if (kernel_object_kind::pollable == kind) {
+                attach(new details::eventfd_mutex_handle{});
+            } else {
+                attach(new details::futex_mutex_handle{});
+            }
+            if (initial_owner) {
+                AC_CODDING_ERROR_IF_NOT(WAIT_OBJECT_0 == wait(0));
+            }
+            return true;
+        }
+
+        void release() noexcept {
+            if (!handle()->release()) {
+                AC_CRASH_APPLICATION();
+            }
+        }
+
+    private:
+        [[nodiscard]] details::mutex_handle *handle() const noexcept {
+            AC_CODDING_ERROR_IF_NOT(is_valid());
+            return static_cast<details::mutex_handle *>(get_handle());
+        }
+    };
+
+    class semaphore : public kernel_object {
+    public:
+        explicit semaphore(long initial_count,
+                           long max_count,
+                           kernel_object_kind kind = kernel_object_kind::pollable) {
+            create(initial_count, max_count, kind);
+        }
+
+        // Duplicating or taking ownership
+        explicit semaphore(HANDLE h, bool duplicate_handle = false)
+            : kernel_object(h, duplicate_handle) {
+            AC_CODDING_ERROR_IF(is_valid() && kernel_object_type::semaphore != get_handle()->type());
+        }
+
+        semaphore(semaphore &&other) noexcept
+            : kernel_object(std::move(other)) {
+        }
+
+        semaphore &operator=(semaphore &&other) noexcept {
+            kernel_object::operator=(std::move(other));
+            return *this;
+        }
+
+        using kernel_object::duplicate;
+
+        [[nodiscard]] semaphore duplicate() const noexcept {
+            return semaphore{get_handle(), true};
+        }
+
+        // Always returns true, there are no named objects
+        bool create(long initial_count,
+                    long max_count,
+                    kernel_object_kind kind = kernel_object_kind::pollable) {
+            AC_THROW_IF(initial_count < 0 || max_count <= 0 || initial_count > max_count || max_count > INT_MAX,
+                        ERROR_INVALID_PARAMETER,
+                        "semaphore");
+            close();
+            if (kernel_object_kind::pollable == kind) {
+                attach(new details::eventfd_semaphore_handle{initial_count, max_count});
+            } else {
+                attach(new details::futex_semaphore_handle{initial_count, max_count});
+            }
+            return true;
+        }
+
+        bool release(long release_count = 1, long *prev_count = nullptr) noexcept {
+            long prev = 0;
+            bool const rc{handle()->release(release_count, &prev)};
+            if (prev_count) {
+                *prev_count = prev;
+            }
+            if (!rc) {
+                AC_CRASH_APPLICATION();
+            }
+            return rc;
+        }
+
+    private:
+        [[nodiscard]] details::semaphore_handle *handle() const noexcept {
+            AC_CODDING_ERROR_IF_NOT(is_valid());
+            return static_cast<details::semaphore_handle *>(get_handle());
+        }
+    };
+
+#endif // AC_PLATFORM_LINUX
+
+    template<typename T>
+    class shared_kernel_object;
+
+    template<typename T, typename... A>
+    [[nodiscard]] shared_kernel_object<T> make_shared_kernel_object(A &&...args);
+
+    //
+    // Reference counted owner of a kernel object. Copies refer to the
+    // same handle and cost one atomic increment, handle is closed when
+    // the last copy goes away. Call duplicate() on the object when an
+    // independent handle is needed, for instance to pass it to another
+    // process or to change access.
+    //
+    template<typename T = kernel_object>
+    class shared_kernel_object {
+    public:
+        static_assert(std::is_base_of_v<kernel_object, T>, "T must derive from kernel_object");
+
+        using object_type = T;
+
+        shared_kernel_object() noexcept = default;
+
+        //
+        // Takes ownership of the object's handle
+        //
+        explicit shared_kernel_object(T &&object)
+            : block_{new control_block{std::move(object)}} {
+        }
+
+        shared_kernel_object(shared_kernel_object const &other) noexcept
+            : block_{other.block_} {
+            add_ref();
+        }
+
+        shared_kernel_object(shared_kernel_object &&other) noexcept
+            : block_{other.block_} {
+            other.block_ = nullptr;
+        }
+
+        ~shared_kernel_object() noexcept {
+            release();
+        }
+
+        shared_kernel_object &operator=(shared_kernel_object const &other) noexcept {
+            shared_kernel_object{other}.swap(*this);
+            return *this;
+        }
+
+        shared_kernel_object &operator=(shared_kernel_object &&other) noexcept {
+            shared_kernel_object{std::move(other)}.swap(*this);
+            return *this;
+        }
+
+        void reset() noexcept {
+            release();
+            block_ = nullptr;
+        }
+
+        void swap(shared_kernel_object &other) noexcept {
+            std::swap(block_, other.block_);
+        }
+
+        [[nodiscard]] T *get() const noexcept {
+            return block_ ? &block_->object : nullptr;
+        }
+
+        T *operator->() const noexcept {
+            AC_CODDING_ERROR_IF(nullptr == block_);
+            return &block_->object;
+        }
+
+        T &operator*() const noexcept {
+            AC_CODDING_ERROR_IF(nullptr == block_);
+            return block_->object;
+        }
+
+        [[nodiscard]] HANDLE get_handle() const noexcept {
+            return block_ ? block_->object.get_handle() : nullptr;
+        }
+
+        [[nodiscard]] bool is_valid() const noexcept {
+            return nullptr != get_handle();
+        }
+
+        explicit operator bool() const noexcept {
+            return is_valid();
+        }
+
+        [[nodiscard]] DWORD wait(DWORD milliseconds = INFINITE) const noexcept {
+            return (*this)->wait(milliseconds);
+        }
+
+        //
+        // Can be stale by the time caller looks at it
+        //
+        [[nodiscard]] long use_count() const noexcept {
+            return block_ ? block_->references.load(std::memory_order_relaxed) : 0;
+        }
+
+    private:
+        template<typename U, typename... A>
+        friend shared_kernel_object<U> make_shared_kernel_object(A &&...args);
+
+        struct control_block {
+            template<typename... A>
+            explicit control_block(A &&...args)
+                : object(std::forward<A>(args)...) {
+            }
+
+            std::atomic<long> references{1};
+            T object;
+        };
+
+        void add_ref() noexcept {
+            if (block_) {
+                block_->references.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+
+        void release() noexcept {
+            if (block_ && 1 == block_->references.fetch_sub(1, std::memory_order_acq_rel)) {
+                delete block_;
+            }
+        }
+
+        control_block *block_{nullptr};
+    };
+
+    //
+    // Creates object and its reference count in one allocation
+    //
+    template<typename T, typename... A>
+    [[nodiscard]] shared_kernel_object<T> make_shared_kernel_object(A &&...args) {
+        shared_kernel_object<T> object;
+        object.block_ = new typename shared_kernel_object<T>::control_block{std::forward<A>(args)...};
+        return object;
+    }
+
+    template<typename T>
+    inline void swap(shared_kernel_object<T> &lhs, shared_kernel_object<T> &rhs) noexcept {
+        lhs.swap(rhs);
+    }
+
 } // namespace ac
 
 #endif //_AC_HELPERS_WIN32_LIBRARY_KERNEL_OBJECT_HEADER_
\ No newline at end of file
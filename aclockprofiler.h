@@ -0,0 +1,423 @@
+#ifndef _AC_HELPERS_WIN32_LIBRARY_LOCK_PROFILER_HEADER_
+#define _AC_HELPERS_WIN32_LIBRARY_LOCK_PROFILER_HEADER_
+
+#pragma once
+
+#include "accommon.h"
+#include "acresourceowner.h"
+
+#include <algorithm>
+#include <cstdio>
+
+namespace ac {
+
+    //
+    // Histogram of durations with power of two buckets. Bucket i
+    // counts durations in [2^(i-1), 2^i) nanoseconds, bucket 0 counts
+    // zero durations. Updates are relaxed atomic increments, so many
+    // threads can record into it without a lock.
+    //
+    class log2_histogram {
+    public:
+        static constexpr size_t buckets_count{48};
+
+        log2_histogram() noexcept {
+        }
+
+        log2_histogram(log2_histogram const &) = delete;
+        log2_histogram &operator=(log2_histogram const &) = delete;
+
+        void record(uint64_t nanoseconds) noexcept {
+            buckets_[bucket_for(nanoseconds)].fetch_add(1, std::memory_order_relaxed);
+            total_.fetch_add(nanoseconds, std::memory_order_relaxed);
+            uint64_t current{max_.load(std::memory_order_relaxed)};
+            while (current < nanoseconds &&
+                   !max_.compare_exchange_weak(
+                       current, nanoseconds, std::memory_order_relaxed, std::memory_order_relaxed)) {
+            }
+        }
+
+        [[nodiscard]] uint64_t count() const noexcept {
+            uint64_t result{0};
+            for (auto const &bucket : buckets_) {
+                result += bucket.load(std::memory_order_relaxed);
+            }
+            return result;
+        }
+
+        [[nodiscard]] uint64_t total() const noexcept {
+            return total_.load(std::memory_order_relaxed);
+        }
+
+        [[nodiscard]] uint64_t maximum() const noexcept {
+            return max_.load(std::memory_order_relaxed);
+        }
+
+        //
+        // Upper bound of the bucket that holds given percentile
+        //
+        [[nodiscard]] uint64_t percentile(double p) const noexcept {
+            uint64_t const samples{count()};
+            if (0 == samples) {
+                return 0;
+            }
+            uint64_t const rank{static_cast<uint64_t>(static_cast<double>(samples) * p / 100.0)};
+            uint64_t seen{0};
+            for (size_t i = 0; i < buckets_count; ++i) {
+                seen += buckets_[i].load(std::memory_order_relaxed);
+                if (seen > rank) {
+                    return 0 == i ? 0 : (uint64_t{1} << i);
+                }
+            }
+            return maximum();
+        }
+
+        void reset() noexcept {
+            for (auto &bucket : buckets_) {
+                bucket.store(0, std::memory_order_relaxed);
+            }
+            total_.store(0, std::memory_order_relaxed);
+            max_.store(0, std::memory_order_relaxed);
+        }
+
+    private:
+        [[nodiscard]] static size_t bucket_for(uint64_t nanoseconds) noexcept {
+            size_t bucket{0};
+            while (nanoseconds && bucket < buckets_count - 1) {
+                nanoseconds >>= 1;
+                ++bucket;
+            }
+            return bucket;
+        }
+
+        std::atomic<uint64_t> buckets_[buckets_count]{};
+        std::atomic<uint64_t> total_{0};
+        std::atomic<uint64_t> max_{0};
+    };
+
+    struct lock_profile_snapshot {
+        void const *lock{nullptr};
+        char const *name{nullptr};
+        uint64_t acquires{0};
+        uint64_t contended_acquires{0};
+        uint64_t total_wait_ns{0};
+        uint64_t max_wait_ns{0};
+        uint64_t p50_wait_ns{0};
+        uint64_t p99_wait_ns{0};
+        uint64_t total_hold_ns{0};
+        uint64_t max_hold_ns{0};
+        uint64_t p50_hold_ns{0};
+        uint64_t p99_hold_ns{0};
+    };
+
+    //
+    // Statistics of a single lock
+    //
+    struct alignas(cache_line_size) lock_profile {
+        std::atomic<void const *> lock{nullptr};
+        std::atomic<char const *> name{nullptr};
+        std::atomic<uint64_t> acquires{0};
+        std::atomic<uint64_t> contended_acquires{0};
+        log2_histogram wait;
+        log2_histogram hold;
+
+        [[nodiscard]] lock_profile_snapshot snapshot() const noexcept {
+            lock_profile_snapshot result;
+            result.lock = lock.load(std::memory_order_acquire);
+            result.name = name.load(std::memory_order_acquire);
+            result.acquires = acquires.load(std::memory_order_relaxed);
+            result.contended_acquires = contended_acquires.load(std::memory_order_relaxed);
+            result.total_wait_ns = wait.total();
+            result.max_wait_ns = wait.maximum();
+            result.p50_wait_ns = wait.percentile(50);
+            result.p99_wait_ns = wait.percentile(99);
+            result.total_hold_ns = hold.total();
+            result.max_hold_ns = hold.maximum();
+            result.p50_hold_ns = hold.percentile(50);
+            result.p99_hold_ns = hold.percentile(99);
+            return result;
+        }
+    };
+
+    //
+    // Process wide table of lock profiles keyed by lock address.
+    // Profile is created on the first profiled acquire and lives till
+    // the end of the process. If a lock is destroyed and another one
+    // is created at the same address, they share the profile.
+    //
+    class lock_profiler {
+    public:
+        static constexpr size_t locks_count{1024};
+
+        [[nodiscard]] static lock_profiler &instance() noexcept {
+            static lock_profiler profiler;
+            return profiler;
+        }
+
+        lock_profiler(lock_profiler const &) = delete;
+        lock_profiler &operator=(lock_profiler const &) = delete;
+
+        //
+        // Name must outlive the profiler, use string literals
+        //
+        void name_lock(void const *lock, char const *name) noexcept {
+            lock_profile *profile{find(lock)};
+            if (profile) {
+                profile->name.store(name, std::memory_order_release);
+            }
+        }
+
+        //
+        // Returns nullptr if table is full
+        //
+        [[nodiscard]] lock_profile *find(void const *lock) noexcept {
+            size_t index{hash(lock)};
+            for (size_t probe = 0; probe < locks_count; ++probe, index = (index + 1) % locks_count) {
+                lock_profile &profile{profiles_[index]};
+                void const *key{profile.lock.load(std::memory_order_acquire)};
+                if (key == lock) {
+                    return &profile;
+                }
+                if (nullptr == key) {
+                    if (profile.lock.compare_exchange_strong(
+                            key, lock, std::memory_order_acq_rel, std::memory_order_acquire) ||
+                        key == lock) {
+                        return &profile;
+                    }
+                }
+            }
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+            return nullptr;
+        }
+
+        //
+        // Locks sorted by number of contended acquires, and then by
+        // total time spent waiting
+        //
+        [[nodiscard]] std::vector<lock_profile_snapshot> top_contended(size_t count) const {
+            std::vector<lock_profile_snapshot> result;
+            for (lock_profile const &profile : profiles_) {
+                if (profile.lock.load(std::memory_order_acquire)) {
+                    result.push_back(profile.snapshot());
+                }
+            }
+            std::sort(result.begin(),
+                      result.end(),
+                      [](lock_profile_snapshot const &l, lock_profile_snapshot const &r) {
+                          if (l.contended_acquires != r.contended_acquires) {
+                              return l.contended_acquires > r.contended_acquires;
+                          }
+                          return l.total_wait_ns > r.total_wait_ns;
+                      });
+            if (result.size() > count) {
+                result.resize(count);
+            }
+            return result;
+        }
+
+        void dump_report(FILE *out, size_t count) const {
+            fprintf(out,
+                    "%-32s %12s %12s %12s %12s %12s %12s %12s\n",
+                    "lock",
+                    "acquires",
+                    "contended",
+                    "wait p50 ns",
+                    "wait p99 ns",
+                    "wait max ns",
+                    "hold p99 ns",
+                    "hold max ns");
+            for (lock_profile_snapshot const &s : top_contended(count)) {
+                char address[32];
+                snprintf(address, sizeof(address), "%p", s.lock);
+                fprintf(out,
+                        "%-32s %12llu %12llu %12llu %12llu %12llu %12llu %12llu\n",
+                        s.name ? s.name : address,
+                        static_cast<unsigned long long>(s.acquires),
+                        static_cast<unsigned long long>(s.contended_acquires),
+                        static_cast<unsigned long long>(s.p50_wait_ns),
+                        static_cast<unsigned long long>(s.p99_wait_ns),
+                        static_cast<unsigned long long>(s.max_wait_ns),
+                        static_cast<unsigned long long>(s.p99_hold_ns),
+                        static_cast<unsigned long long>(s.max_hold_ns));
+            }
+            uint64_t const dropped{dropped_.load(std::memory_order_relaxed)};
+            if (dropped) {
+                fprintf(out, "%llu acquires were not profiled, table is full\n",
+                        static_cast<unsigned long long>(dropped));
+            }
+        }
+
+        //
+        // Clears counters but keeps locks and their names
+        //
+        void reset() noexcept {
+            for (lock_profile &profile : profiles_) {
+                profile.acquires.store(0, std::memory_order_relaxed);
+                profile.contended_acquires.store(0, std::memory_order_relaxed);
+                profile.wait.reset();
+                profile.hold.reset();
+            }
+            dropped_.store(0, std::memory_order_relaxed);
+        }
+
+        [[nodiscard]] static uint64_t now() noexcept {
+            return static_cast<uint64_t>(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    std::chrono::steady_clock::now().time_since_epoch())
+                    .count());
+        }
+
+    private:
+        lock_profiler() noexcept {
+        }
+
+        [[nodiscard]] static size_t hash(void const *lock) noexcept {
+            uint64_t const key{reinterpret_cast<uintptr_t>(lock)};
+            return static_cast<size_t>((key * 0x9E3779B97F4A7C15ULL) >> 40) % locks_count;
+        }
+
+        lock_profile profiles_[locks_count];
+        std::atomic<uint64_t> dropped_{0};
+    };
+
+    namespace details {
+
+        //
+        // Locks this thread holds through profiled traits, and when
+        // it got them. Traits are stateless, so this is where hold
+        // time is measured from. Holds nested deeper than the stack
+        // are not timed.
+        //
+        struct lock_hold_stack {
+            static constexpr size_t depth{16};
+
+            struct entry {
+                void const *lock;
+                lock_profile *profile;
+                uint64_t acquired_at;
+            };
+
+            entry entries[depth];
+            size_t size{0};
+
+            void push(void const *lock, lock_profile *profile, uint64_t acquired_at) noexcept {
+                if (size < depth) {
+                    entries[size++] = entry{lock, profile, acquired_at};
+                }
+            }
+
+            void pop(void const *lock, uint64_t released_at) noexcept {
+                for (size_t i = size; i > 0; --i) {
+                    if (entries[i - 1].lock == lock) {
+                        entries[i - 1].profile->hold.record(released_at - entries[i - 1].acquired_at);
+                        for (size_t j = i; j < size; ++j) {
+                            entries[j - 1] = entries[j];
+                        }
+                        --size;
+                        return;
+                    }
+                }
+            }
+        };
+
+        [[nodiscard]] inline lock_hold_stack &current_lock_hold_stack() noexcept {
+            thread_local lock_hold_stack stack;
+            return stack;
+        }
+
+        //
+        // Shared by all profiled traits. A is the traits class that
+        // does the actual locking. Acquire first tries without
+        // waiting, and only if that fails counts acquire as contended
+        // and measures the wait.
+        //
+        template<typename T, typename A>
+        class profiled_traits_base {
+        public:
+            static void acquire(T *v) {
+                lock_profile *profile{lock_profiler::instance().find(v)};
+                if (!profile) {
+                    A::acquire(v);
+                    return;
+                }
+                uint64_t acquired_at{lock_profiler::now()};
+                if (!A::try_acquire(v)) {
+                    uint64_t const wait_start{acquired_at};
+                    A::acquire(v);
+                    acquired_at = lock_profiler::now();
+                    profile->contended_acquires.fetch_add(1, std::memory_order_relaxed);
+                    profile->wait.record(acquired_at - wait_start);
+                } else {
+                    profile->wait.record(0);
+                }
+                acquired(v, profile, acquired_at);
+            }
+
+            [[nodiscard]] static bool try_acquire(T *v) {
+                if (!A::try_acquire(v)) {
+                    return false;
+                }
+                lock_profile *profile{lock_profiler::instance().find(v)};
+                if (profile) {
+                    acquired(v, profile, lock_profiler::now());
+                }
+                return true;
+            }
+
+            template<typename... P>
+            [[nodiscard]] static bool try_acquire(T *v, P... param) {
+                if (!A::try_acquire(v, param...)) {
+                    return false;
+                }
+                lock_profile *profile{lock_profiler::instance().find(v)};
+                if (profile) {
+                    acquired(v, profile, lock_profiler::now());
+                }
+                return true;
+            }
+
+            static void release(T *v) noexcept {
+                details::current_lock_hold_stack().pop(v, lock_profiler::now());
+                A::release(v);
+            }
+
+        private:
+            static void acquired(T *v, lock_profile *profile, uint64_t acquired_at) noexcept {
+                profile->acquires.fetch_add(1, std::memory_order_relaxed);
+                details::current_lock_hold_stack().push(v, profile, acquired_at);
+            }
+        };
+    } // namespace details
+
+    //
+    // Drop in replacements for acquire traits that record wait time,
+    // hold time and contended acquires of each lock in the
+    // lock_profiler. To profile a lock change the guard typedef, e.g.
+    //
+    //   using exclusive_lock_guard =
+    //       resource_owner<srw_lock, profiled_acquire_exclusive_traits<srw_lock>>;
+    //
+    template<typename T>
+    class profiled_acquire_traits final
+        : public details::profiled_traits_base<T, acquire_traits<T>> {};
+
+    template<typename T>
+    class profiled_acquire_shared_traits final
+        : public details::profiled_traits_base<T, acquire_shared_traits<T>> {};
+
+    template<typename T>
+    class profiled_acquire_exclusive_traits final
+        : public details::profiled_traits_base<T, acquire_exclusive_traits<T>> {};
+
+    template<typename T>
+    using profiled_shared_lock_guard = resource_owner<T, profiled_acquire_shared_traits<T>>;
+
+    template<typename T>
+    using profiled_exclusive_lock_guard = resource_owner<T, profiled_acquire_exclusive_traits<T>>;
+
+    template<typename T>
+    using profiled_lock_guard = resource_owner<T, profiled_acquire_traits<T>>;
+
+} // namespace ac
+
+#endif //_AC_HELPERS_WIN32_LIBRARY_LOCK_PROFILER_HEADER_
@@ -0,0 +1,437 @@
+#ifndef _AC_HELPERS_WIN32_LIBRARY_MAPPED_FILE_HEADER_
+#define _AC_HELPERS_WIN32_LIBRARY_MAPPED_FILE_HEADER_
+
+#pragma once
+
+#include "accommon.h"
+#include "acfileobject.h"
+
+#if AC_PLATFORM_LINUX
+#include <sys/mman.h>
+#endif
+
+namespace ac {
+
+    enum class map_access : bool {
+        read_only = false,
+        read_write = true,
+    };
+
+    //
+    // Hints applied to a view each time it is mapped, so a sliding
+    // window keeps them as it moves
+    //
+    enum class view_advice : unsigned {
+        normal = 0,
+        //
+        // View is read front to back. Linux reads ahead aggressively
+        // and drops pages behind, Windows prefetches whole window.
+        //
+        sequential = 1,
+        //
+        // Turns read ahead off
+        //
+        random = 2,
+        //
+        // Back view with transparent huge pages where file system
+        // supports it. Windows has no large pages for file views, and
+        // ignores this hint.
+        //
+        huge_pages = 4,
+    };
+
+    [[nodiscard]] inline constexpr view_advice operator|(view_advice lhs, view_advice rhs) noexcept {
+        return static_cast<view_advice>(static_cast<unsigned>(lhs) | static_cast<unsigned>(rhs));
+    }
+
+    [[nodiscard]] inline constexpr bool has_advice(view_advice advice, view_advice flag) noexcept {
+        return 0 != (static_cast<unsigned>(advice) & static_cast<unsigned>(flag));
+    }
+
+    class file_view;
+
+    //
+    // File that can be mapped into memory. Views let parser walk the
+    // file in place instead of copying it into a buffer.
+    //
+    // On Windows this is a file mapping object. On Linux mmap needs
+    // only the descriptor, so this keeps a duplicate of the file.
+    // Views stay valid after mapped_file is destroyed or moved, but
+    // sliding a view needs mapped_file it came from to stay in place.
+    //
+    class mapped_file {
+    public:
+        mapped_file() noexcept {
+        }
+
+        //
+        // Size 0 maps the whole file. Read-write mapping larger than
+        // the file extends it.
+        //
+        explicit mapped_file(file_object const &file,
+                             map_access access = map_access::read_only,
+                             LONGLONG size = 0) {
+            create(file, access, size);
+        }
+
+        mapped_file(mapped_file const &) = delete;
+        mapped_file(mapped_file &&other) noexcept
+#if AC_PLATFORM_WINDOWS
+            : section_{std::move(other.section_)}
+#else
+            : file_{std::move(other.file_)}
+#endif
+            , access_{other.access_}
+            , size_{std::exchange(other.size_, 0)} {
+        }
+
+        mapped_file &operator=(mapped_file const &) = delete;
+
+        mapped_file &operator=(mapped_file &&other) noexcept {
+            if (this != &other) {
+#if AC_PLATFORM_WINDOWS
+                section_ = std::move(other.section_);
+#else
+                file_ = std::move(other.file_);
+#endif
+                access_ = other.access_;
+                size_ = std::exchange(other.size_, 0);
+            }
+            return *this;
+        }
+
+        //
+        // Offset of a view must be a multiple of this
+        //
+        [[nodiscard]] static DWORD view_alignment() noexcept {
+#if AC_PLATFORM_WINDOWS
+            static DWORD const allocation_granularity{[]() {
+                SYSTEM_INFO system_info;
+                GetSystemInfo(&system_info);
+                return system_info.dwAllocationGranularity;
+            }()};
+            return allocation_granularity;
+#else
+            return system_page_size();
+#endif
+        }
+
+        void create(file_object const &file, map_access access = map_access::read_only, LONGLONG size = 0) {
+            close();
+            AC_THROW_IF(!file.is_valid() || size < 0, ERROR_INVALID_PARAMETER, "mapped_file");
+
+            LONGLONG const file_size{file.get_size()};
+            if (0 == size) {
+                size = file_size;
+            }
+#if AC_PLATFORM_WINDOWS
+            HANDLE h = CreateFileMappingW(file.get_handle(),
+                                          nullptr,
+                                          map_access::read_write == access ? PAGE_READWRITE : PAGE_READONLY,
+                                          get_high_dword(size),
+                                          get_low_dword(size),
+                                          nullptr);
+            AC_THROW_IF(h == nullptr, GetLastError(), "CreateFileMapping");
+            section_.attach(h);
+#else
+            AC_THROW_IF(0 == size, ERROR_INVALID_PARAMETER, "mapped_file");
+            file_ = file.duplicate();
+            if (size > file_size) {
+                //
+                // Pages past the end of file cannot be touched, so
+                // grow it the same way CreateFileMapping does
+                //
+                AC_THROW_IF(map_access::read_only == access, ERROR_INVALID_PARAMETER, "mapped_file");
+                file_.resize(size);
+            }
+#endif
+            access_ = access;
+            size_ = size;
+        }
+
+        void close() {
+#if AC_PLATFORM_WINDOWS
+            section_.close();
+#else
+            file_.close();
+#endif
+            size_ = 0;
+        }
+
+        [[nodiscard]] bool is_valid() const noexcept {
+            return 0 != size_;
+        }
+
+        explicit operator bool() const noexcept {
+            return is_valid();
+        }
+
+        [[nodiscard]] map_access get_access() const noexcept {
+            return access_;
+        }
+
+        [[nodiscard]] LONGLONG get_size() const noexcept {
+            return size_;
+        }
+
+        //
+        // Offset does not need to be aligned, view maps from aligned
+        // offset below it and data() points at the requested byte.
+        // Size 0 maps up to the end of the mapping.
+        //
+        [[nodiscard]] file_view map(LONGLONG offset,
+                                    size_t size = 0,
+                                    view_advice advice = view_advice::normal) const;
+
+    private:
+        friend class file_view;
+
+#if AC_PLATFORM_WINDOWS
+        kernel_object section_;
+#else
+        file_object file_;
+#endif
+        map_access access_{map_access::read_only};
+        LONGLONG size_{0};
+    };
+
+    //
+    // Window of mapped_file. Unmaps it on destruction.
+    //
+    class file_view {
+    public:
+        file_view() noexcept {
+        }
+
+        file_view(file_view const &) = delete;
+
+        file_view(file_view &&other) noexcept {
+            swap(other);
+        }
+
+        ~file_view() noexcept {
+            unmap();
+        }
+
+        file_view &operator=(file_view const &) = delete;
+
+        file_view &operator=(file_view &&other) noexcept {
+            if (this != &other) {
+                unmap();
+                swap(other);
+            }
+            return *this;
+        }
+
+        void swap(file_view &other) noexcept {
+            std::swap(file_, other.file_);
+            std::swap(base_, other.base_);
+            std::swap(mapped_size_, other.mapped_size_);
+            std::swap(delta_, other.delta_);
+            std::swap(size_, other.size_);
+            std::swap(offset_, other.offset_);
+            std::swap(advice_, other.advice_);
+        }
+
+        [[nodiscard]] bool is_valid() const noexcept {
+            return nullptr != base_;
+        }
+
+        explicit operator bool() const noexcept {
+            return is_valid();
+        }
+
+        //
+        // Writing through a read-only view crashes the process
+        //
+        [[nodiscard]] char *data() const noexcept {
+            return static_cast<char *>(base_) + delta_;
+        }
+
+        [[nodiscard]] size_t size() const noexcept {
+            return size_;
+        }
+
+        //
+        // Offset of data() in the file
+        //
+        [[nodiscard]] LONGLONG offset() const noexcept {
+            return offset_;
+        }
+
+        [[nodiscard]] bool contains(LONGLONG offset, size_t size) const noexcept {
+            return offset >= offset_ && offset - offset_ + static_cast<LONGLONG>(size) <= static_cast<LONGLONG>(size_);
+        }
+
+        //
+        // Moves window to another part of the same mapping. Mapping
+        // the view came from has to be alive.
+        //
+        void slide(LONGLONG offset, size_t size = 0) {
+            AC_CODDING_ERROR_IF(nullptr == file_);
+            mapped_file const *file{file_};
+            view_advice const advice{advice_};
+            unmap();
+            map(*file, offset, size, advice);
+        }
+
+        void advise(view_advice advice) {
+            advice_ = advice;
+            apply_advice();
+        }
+
+        //
+        // Asks system to read pages in ahead of the parser. Range is
+        // relative to data() and is clipped to the view.
+        //
+        void prefetch(size_t offset = 0, size_t size = (std::numeric_limits<size_t>::max)()) noexcept {
+            if (!is_valid() || offset >= size_) {
+                return;
+            }
+            size = (std::min)(size, size_ - offset);
+#if AC_PLATFORM_WINDOWS
+            WIN32_MEMORY_RANGE_ENTRY range{data() + offset, size};
+            //
+            // Only a hint, failure is not an error
+            //
+            static_cast<void>(PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0));
+#else
+            advise_range(data() + offset, size, MADV_WILLNEED);
+#endif
+        }
+
+        //
+        // Writes dirty pages of the view to the file
+        //
+        void flush() {
+            if (!is_valid()) {
+                return;
+            }
+#if AC_PLATFORM_WINDOWS
+            if (!FlushViewOfFile(base_, mapped_size_)) {
+                AC_THROW(GetLastError(), "FlushViewOfFile");
+            }
+#else
+            if (0 != ::msync(base_, mapped_size_, MS_SYNC)) {
+                AC_THROW(errno, "msync");
+            }
+#endif
+        }
+
+        void unmap() noexcept {
+            if (is_valid()) {
+#if AC_PLATFORM_WINDOWS
+                AC_CODDING_ERROR_IF_NOT(UnmapViewOfFile(base_));
+#else
+                AC_CODDING_ERROR_IF_NOT(0 == ::munmap(base_, mapped_size_));
+#endif
+            }
+            file_ = nullptr;
+            base_ = nullptr;
+            mapped_size_ = 0;
+            delta_ = 0;
+            size_ = 0;
+            offset_ = 0;
+            advice_ = view_advice::normal;
+        }
+
+    private:
+        friend class mapped_file;
+
+        void map(mapped_file const &file, LONGLONG offset, size_t size, view_advice advice) {
+            AC_THROW_IF(!file.is_valid() || offset < 0 || offset >= file.size_, ERROR_INVALID_PARAMETER, "file_view");
+            LONGLONG const available{file.size_ - offset};
+            if (0 == size || static_cast<ULONGLONG>(size) > static_cast<ULONGLONG>(available)) {
+                AC_THROW_IF(0 != size, ERROR_INVALID_PARAMETER, "file_view");
+                AC_THROW_IF(static_cast<ULONGLONG>(available) > (std::numeric_limits<size_t>::max)(),
+                            ERROR_NOT_ENOUGH_MEMORY,
+                            "file_view");
+                size = static_cast<size_t>(available);
+            }
+
+            LONGLONG const aligned_offset{offset - offset % mapped_file::view_alignment()};
+            size_t const delta{static_cast<size_t>(offset - aligned_offset)};
+            size_t const mapped_size{size + delta};
+#if AC_PLATFORM_WINDOWS
+            void *base = MapViewOfFile(file.section_.get_handle(),
+                                       map_access::read_write == file.access_ ? FILE_MAP_WRITE : FILE_MAP_READ,
+                                       get_high_dword(aligned_offset),
+                                       get_low_dword(aligned_offset),
+                                       mapped_size);
+            AC_THROW_IF(nullptr == base, GetLastError(), "MapViewOfFile");
+#else
+            void *base = ::mmap(nullptr,
+                                mapped_size,
+                                map_access::read_write == file.access_ ? PROT_READ | PROT_WRITE : PROT_READ,
+                                MAP_SHARED,
+                                file.file_.get_fd(),
+                                static_cast<off_t>(aligned_offset));
+            AC_THROW_IF(MAP_FAILED == base, errno, "mmap");
+#endif
+            file_ = &file;
+            base_ = base;
+            mapped_size_ = mapped_size;
+            delta_ = delta;
+            size_ = size;
+            offset_ = offset;
+            advice_ = advice;
+            apply_advice();
+        }
+
+        void apply_advice() noexcept {
+            if (!is_valid()) {
+                return;
+            }
+#if AC_PLATFORM_WINDOWS
+            if (has_advice(advice_, view_advice::sequential)) {
+                prefetch();
+            }
+#else
+            if (has_advice(advice_, view_advice::sequential)) {
+                advise_range(base_, mapped_size_, MADV_SEQUENTIAL);
+            } else if (has_advice(advice_, view_advice::random)) {
+                advise_range(base_, mapped_size_, MADV_RANDOM);
+            } else {
+                advise_range(base_, mapped_size_, MADV_NORMAL);
+            }
+            if (has_advice(advice_, view_advice::huge_pages)) {
+                advise_range(base_, mapped_size_, MADV_HUGEPAGE);
+            }
+#endif
+        }
+
+#if AC_PLATFORM_LINUX
+        //
+        // Advice is only a hint. madvise wants page aligned start, and
+        // kernels without huge page support for files reject it.
+        //
+        static void advise_range(void *address, size_t size, int advice) noexcept {
+            uintptr_t const page_mask{system_page_size() - 1u};
+            uintptr_t const start{reinterpret_cast<uintptr_t>(address) & ~page_mask};
+            size += reinterpret_cast<uintptr_t>(address) - start;
+            static_cast<void>(::madvise(reinterpret_cast<void *>(start), size, advice));
+        }
+#endif
+
+        mapped_file const *file_{nullptr};
+        void *base_{nullptr};
+        size_t mapped_size_{0};
+        size_t delta_{0};
+        size_t size_{0};
+        LONGLONG offset_{0};
+        view_advice advice_{view_advice::normal};
+    };
+
+    inline file_view mapped_file::map(LONGLONG offset, size_t size, view_advice advice) const {
+        file_view view;
+        view.map(*this, offset, size, advice);
+        return view;
+    }
+
+    inline void swap(file_view &lhs, file_view &rhs) noexcept {
+        lhs.swap(rhs);
+    }
+
+} // namespace ac
+
+#endif //_AC_HELPERS_WIN32_LIBRARY_MAPPED_FILE_HEADER_
@@ -0,0 +1,174 @@
+#ifndef _AC_HELPERS_WIN32_LIBRARY_MUTEX_HEADER_
+#define _AC_HELPERS_WIN32_LIBRARY_MUTEX_HEADER_
+
+#pragma once
+
+#include "accommon.h"
+#include "acparkinglot.h"
+#include "acresourceowner.h"
+
+#include <algorithm>
+
+namespace ac {
+
+    enum class fast_mutex_policy {
+        //
+        // Released lock is free for grabs, and woken up thread
+        // competes with running threads. Best throughput.
+        //
+        barging,
+        //
+        // Released lock is passed directly to the longest waiting
+        // thread. No starvation, but every contended release costs
+        // a context switch.
+        //
+        fair_handoff,
+    };
+
+    //
+    // User mode mutex that takes a single byte. Uncontended acquire
+    // and release are one CAS each. Contended acquire spins for a
+    // while, and then parks on the parking lot.
+    //
+    // Each mutex adapts how long it spins from how long recent
+    // acquirers had to spin before the lock became free, which
+    // follows how long the lock is usually held. Locks that are held
+    // for long stop burning CPU, and locks that are held for a few
+    // instructions rarely park.
+    //
+    class fast_mutex final {
+    public:
+        using guard = resource_owner<fast_mutex>;
+
+        explicit fast_mutex(fast_mutex_policy policy = fast_mutex_policy::barging) noexcept
+            : policy_{policy} {
+        }
+
+        fast_mutex(fast_mutex const &) = delete;
+        fast_mutex(fast_mutex &&) = delete;
+
+        fast_mutex &operator=(fast_mutex const &) = delete;
+        fast_mutex &operator=(fast_mutex &&) = delete;
+
+        ~fast_mutex() noexcept {
+            AC_CODDING_ERROR_IF(state_.load(std::memory_order_relaxed));
+        }
+
+        void acquire() noexcept {
+            uint8_t expected{0};
+            if (!state_.compare_exchange_weak(
+                    expected, locked, std::memory_order_acquire, std::memory_order_relaxed)) {
+                acquire_contended();
+            }
+        }
+
+        [[nodiscard]] bool try_acquire() noexcept {
+            uint8_t state{state_.load(std::memory_order_relaxed)};
+            while (0 == (state & locked)) {
+                if (state_.compare_exchange_weak(
+                        state, state | locked, std::memory_order_acquire, std::memory_order_relaxed)) {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        void release() noexcept {
+            uint8_t expected{locked};
+            if (!state_.compare_exchange_strong(
+                    expected, 0, std::memory_order_release, std::memory_order_relaxed)) {
+                release_contended();
+            }
+        }
+
+        [[nodiscard]] bool is_locked() const noexcept {
+            return 0 != (state_.load(std::memory_order_relaxed) & locked);
+        }
+
+        [[nodiscard]] fast_mutex_policy policy() const noexcept {
+            return policy_;
+        }
+
+    private:
+        static constexpr uint8_t locked{1};
+        static constexpr uint8_t parked{2};
+        static constexpr uint32_t max_spin_count{1000};
+        static constexpr uintptr_t handoff_token{1};
+
+        void acquire_contended() noexcept {
+            uint32_t const spin_limit{
+                (std::min)(max_spin_count, spin_estimate_.load(std::memory_order_relaxed) * 2 + 10)};
+            uint32_t spins{0};
+            for (;;) {
+                uint8_t state{state_.load(std::memory_order_relaxed)};
+                if (0 == (state & locked)) {
+                    if (state_.compare_exchange_weak(
+                            state, state | locked, std::memory_order_acquire, std::memory_order_relaxed)) {
+                        update_spin_estimate(spins);
+                        return;
+                    }
+                    continue;
+                }
+                if (0 == (state & parked) && spins < spin_limit) {
+                    ++spins;
+                    cpu_relax();
+                    continue;
+                }
+                if (0 == (state & parked)) {
+                    if (!state_.compare_exchange_weak(
+                            state, state | parked, std::memory_order_relaxed, std::memory_order_relaxed)) {
+                        continue;
+                    }
+                }
+                //
+                // Releasing thread sees parked bit, and unparks us under
+                // the bucket lock, so we park only if bit is still set
+                //
+                uintptr_t token{0};
+                park_result const result{parking_lot::park(
+                    &state_,
+                    [this]() noexcept {
+                        return (locked | parked) == state_.load(std::memory_order_relaxed);
+                    },
+                    INFINITE,
+                    0,
+                    &token)};
+                if (park_result::unparked == result && handoff_token == token) {
+                    //
+                    // Lock was handed to us and stayed locked
+                    //
+                    return;
+                }
+                spins = 0;
+            }
+        }
+
+        void release_contended() noexcept {
+            parking_lot::unpark_one(&state_, [this](unpark_result result) noexcept -> uintptr_t {
+                if (0 < result.unparked_count && fast_mutex_policy::fair_handoff == policy_) {
+                    state_.store(result.have_more ? (locked | parked) : locked, std::memory_order_release);
+                    return handoff_token;
+                }
+                state_.store(result.have_more ? parked : 0, std::memory_order_release);
+                return 0;
+            });
+        }
+
+        //
+        // Exponentially weighted moving average with weight 1/8
+        //
+        void update_spin_estimate(uint32_t spins) noexcept {
+            int32_t const estimate{static_cast<int32_t>(spin_estimate_.load(std::memory_order_relaxed))};
+            spin_estimate_.store(
+                static_cast<uint32_t>(estimate + (static_cast<int32_t>(spins) - estimate) / 8),
+                std::memory_order_relaxed);
+        }
+
+        std::atomic<uint8_t> state_{0};
+        fast_mutex_policy policy_;
+        std::atomic<uint32_t> spin_estimate_{0};
+    };
+
+} // namespace ac
+
+#endif //_AC_HELPERS_WIN32_LIBRARY_MUTEX_HEADER_
@@ -0,0 +1,369 @@
+#ifndef _AC_HELPERS_WIN32_LIBRARY_PARKING_LOT_HEADER_
+#define _AC_HELPERS_WIN32_LIBRARY_PARKING_LOT_HEADER_
+
+#pragma once
+
+#include "accommon.h"
+#include "acwaitonaddress.h"
+
+namespace ac {
+
+    //
+    // Parking lot keeps queues of threads waiting on arbitrary
+    // addresses in a global hash table, so a synchronization
+    // primitive does not need anything besides its state word.
+    // It can be a single byte, and all the bookkeeping of waiters
+    // lives on stacks of the parked threads.
+    //
+    // Each parked thread sleeps on a private word using
+    // wait_on_address, so unparking one thread wakes exactly that
+    // thread. Waiters of the same address are kept in FIFO order.
+    //
+    enum class park_result {
+        unparked,
+        invalid,
+        timed_out,
+    };
+
+    enum class unpark_filter_result {
+        unpark,
+        skip,
+        stop,
+    };
+
+    struct unpark_result {
+        size_t unparked_count{0};
+        bool have_more{false};
+    };
+
+    namespace details {
+
+        //
+        // Lock that protects a bucket. 0 - unlocked, 1 - locked,
+        // 2 - locked and there might be threads waiting for it.
+        // Critical sections under it are a few pointer updates,
+        // so we spin a little before going to sleep.
+        //
+        class parking_lot_word_lock {
+        public:
+            parking_lot_word_lock() noexcept {
+            }
+
+            parking_lot_word_lock(parking_lot_word_lock const &) = delete;
+            parking_lot_word_lock &operator=(parking_lot_word_lock const &) = delete;
+
+            void lock() noexcept {
+                uint32_t expected{0};
+                if (state_.compare_exchange_strong(
+                        expected, 1, std::memory_order_acquire, std::memory_order_relaxed)) {
+                    return;
+                }
+                lock_contended();
+            }
+
+            void unlock() noexcept {
+                if (2 == state_.exchange(0, std::memory_order_release)) {
+                    wait_on_address::wake_single(state_address());
+                }
+            }
+
+        private:
+            static constexpr int spin_count{40};
+
+            uint32_t const volatile *state_address() noexcept {
+                return reinterpret_cast<uint32_t const volatile *>(&state_);
+            }
+
+            void lock_contended() noexcept {
+                for (int i = 0; i < spin_count; ++i) {
+                    uint32_t expected{0};
+                    if (state_.compare_exchange_weak(
+                            expected, 1, std::memory_order_acquire, std::memory_order_relaxed)) {
+                        return;
+                    }
+                }
+                while (0 != state_.exchange(2, std::memory_order_acquire)) {
+                    static_cast<void>(wait_on_address::try_wait(state_address(), uint32_t{2}));
+                }
+            }
+
+            std::atomic<uint32_t> state_{0};
+        };
+
+        struct parking_lot_waiter {
+            void const volatile *address{nullptr};
+            parking_lot_waiter *next{nullptr};
+            uintptr_t park_token{0};
+            uintptr_t unpark_token{0};
+            //
+            // 0 - parked, 1 - unparked. Parked thread sleeps on it.
+            //
+            std::atomic<uint32_t> unparked{0};
+        };
+
+        struct alignas(cache_line_size) parking_lot_bucket {
+            parking_lot_word_lock lock;
+            parking_lot_waiter *head{nullptr};
+            parking_lot_waiter *tail{nullptr};
+
+            void enqueue(parking_lot_waiter *waiter) noexcept {
+                waiter->next = nullptr;
+                if (tail) {
+                    tail->next = waiter;
+                } else {
+                    head = waiter;
+                }
+                tail = waiter;
+            }
+
+            //
+            // Returns false if waiter is not in the queue anymore
+            //
+            bool remove(parking_lot_waiter *waiter) noexcept {
+                parking_lot_waiter *prev{nullptr};
+                for (parking_lot_waiter *cur = head; cur; prev = cur, cur = cur->next) {
+                    if (cur == waiter) {
+                        unlink(prev, cur);
+                        return true;
+                    }
+                }
+                return false;
+            }
+
+            void unlink(parking_lot_waiter *prev, parking_lot_waiter *waiter) noexcept {
+                if (prev) {
+                    prev->next = waiter->next;
+                } else {
+                    head = waiter->next;
+                }
+                if (tail == waiter) {
+                    tail = prev;
+                }
+                waiter->next = nullptr;
+            }
+
+            [[nodiscard]] bool has_waiters_for(void const volatile *address) const noexcept {
+                for (parking_lot_waiter const *cur = head; cur; cur = cur->next) {
+                    if (cur->address == address) {
+                        return true;
+                    }
+                }
+                return false;
+            }
+        };
+
+        inline constexpr size_t parking_lot_buckets_count{256};
+
+        [[nodiscard]] inline parking_lot_bucket &parking_lot_bucket_for(
+            void const volatile *address) noexcept {
+            static parking_lot_bucket buckets[parking_lot_buckets_count];
+            uintptr_t const key{reinterpret_cast<uintptr_t>(address)};
+            return buckets[(static_cast<uint64_t>(key) * 0x9E3779B97F4A7C15ULL >> 56) %
+                           parking_lot_buckets_count];
+        }
+    } // namespace details
+
+    class parking_lot {
+    public:
+        parking_lot() = delete;
+        parking_lot(parking_lot &) = delete;
+        parking_lot(parking_lot &&) = delete;
+        parking_lot &operator=(parking_lot &) = delete;
+        parking_lot &operator=(parking_lot &&) = delete;
+
+        //
+        // validate is called under the bucket lock, and thread
+        // parks only if it returns true. Any thread that changes
+        // state validate depends on, and then calls one of the
+        // unpark methods, will find this thread in the queue.
+        //
+        // If thread was unparked with a token, it is returned
+        // through unpark_token.
+        //
+        template<typename V>
+        [[nodiscard]] static park_result park(void const volatile *address,
+                                              V &&validate,
+                                              DWORD milliseconds = INFINITE,
+                                              uintptr_t park_token = 0,
+                                              uintptr_t *unpark_token = nullptr) noexcept {
+            details::parking_lot_bucket &bucket{details::parking_lot_bucket_for(address)};
+            details::parking_lot_waiter waiter;
+            waiter.address = address;
+            waiter.park_token = park_token;
+
+            bucket.lock.lock();
+            if (!validate()) {
+                bucket.lock.unlock();
+                return park_result::invalid;
+            }
+            bucket.enqueue(&waiter);
+            bucket.lock.unlock();
+
+            park_result result{park_result::unparked};
+            if (!sleep(&waiter, milliseconds)) {
+                //
+                // Timed out. If we are still in the queue then nobody
+                // is going to wake us up. Otherwise unpark is already
+                // on its way, and we have to wait for it since waiter
+                // lives on our stack.
+                //
+                bucket.lock.lock();
+                bool const removed{bucket.remove(&waiter)};
+                bucket.lock.unlock();
+                if (removed) {
+                    result = park_result::timed_out;
+                } else {
+                    static_cast<void>(sleep(&waiter, INFINITE));
+                }
+            }
+            if (park_result::unparked == result && unpark_token) {
+                *unpark_token = waiter.unpark_token;
+            }
+            return result;
+        }
+
+        template<typename V>
+        [[nodiscard]] static park_result park(void const volatile *address,
+                                              V &&validate,
+                                              std::chrono::milliseconds timeout) noexcept {
+            return park(address, std::forward<V>(validate), static_cast<DWORD>(timeout.count()));
+        }
+
+        //
+        // Unparks the longest waiting thread. callback is called under
+        // the bucket lock with the result, before thread is woken up,
+        // and returns a token that is handed off to that thread.
+        // Use it to transfer ownership directly to the woken thread,
+        // or to update state to reflect whether there are more waiters.
+        //
+        template<typename C>
+        static unpark_result unpark_one(void const volatile *address, C &&callback) noexcept {
+            bool done{false};
+            return unpark_impl(
+                address,
+                [&done](uintptr_t) noexcept {
+                    if (done) {
+                        return unpark_filter_result::stop;
+                    }
+                    done = true;
+                    return unpark_filter_result::unpark;
+                },
+                std::forward<C>(callback));
+        }
+
+        static unpark_result unpark_one(void const volatile *address) noexcept {
+            return unpark_one(address, [](unpark_result) noexcept -> uintptr_t { return 0; });
+        }
+
+        static size_t unpark_all(void const volatile *address, uintptr_t unpark_token = 0) noexcept {
+            return unpark_impl(
+                       address,
+                       [](uintptr_t) noexcept { return unpark_filter_result::unpark; },
+                       [unpark_token](unpark_result) noexcept { return unpark_token; })
+                .unparked_count;
+        }
+
+        //
+        // filter is called under the bucket lock for each thread parked
+        // on the address, in FIFO order, with the token that thread
+        // passed to park, and decides whether to unpark it, skip it or
+        // stop scanning.
+        //
+        template<typename F>
+        static unpark_result unpark_filter(void const volatile *address,
+                                           F &&filter,
+                                           uintptr_t unpark_token = 0) noexcept {
+            return unpark_impl(address, std::forward<F>(filter), [unpark_token](unpark_result) noexcept {
+                return unpark_token;
+            });
+        }
+
+    private:
+        //
+        // Returns false if timed out
+        //
+        static bool sleep(details::parking_lot_waiter *waiter, DWORD milliseconds) noexcept {
+            uint32_t const volatile *address{
+                reinterpret_cast<uint32_t const volatile *>(&waiter->unparked)};
+            if (INFINITE == milliseconds) {
+                while (0 == waiter->unparked.load(std::memory_order_acquire)) {
+                    static_cast<void>(wait_on_address::try_wait(address, uint32_t{0}));
+                }
+                return true;
+            }
+            auto const deadline{std::chrono::steady_clock::now() +
+                                std::chrono::milliseconds{milliseconds}};
+            while (0 == waiter->unparked.load(std::memory_order_acquire)) {
+                auto const now{std::chrono::steady_clock::now()};
+                if (now >= deadline) {
+                    return false;
+                }
+                auto const left{
+                    std::chrono::ceil<std::chrono::milliseconds>(deadline - now).count()};
+                static_cast<void>(
+                    wait_on_address::try_wait(address, uint32_t{0}, static_cast<DWORD>(left)));
+            }
+            return true;
+        }
+
+        template<typename F, typename C>
+        static unpark_result unpark_impl(void const volatile *address, F &&filter, C &&callback) noexcept {
+            details::parking_lot_bucket &bucket{details::parking_lot_bucket_for(address)};
+            details::parking_lot_waiter *unparked_head{nullptr};
+            details::parking_lot_waiter *unparked_tail{nullptr};
+            unpark_result result;
+
+            bucket.lock.lock();
+            details::parking_lot_waiter *prev{nullptr};
+            details::parking_lot_waiter *cur{bucket.head};
+            while (cur) {
+                details::parking_lot_waiter *next{cur->next};
+                if (cur->address == address) {
+                    unpark_filter_result const decision{filter(cur->park_token)};
+                    if (unpark_filter_result::stop == decision) {
+                        break;
+                    }
+                    if (unpark_filter_result::unpark == decision) {
+                        bucket.unlink(prev, cur);
+                        if (unparked_tail) {
+                            unparked_tail->next = cur;
+                        } else {
+                            unparked_head = cur;
+                        }
+                        unparked_tail = cur;
+                        ++result.unparked_count;
+                        cur = next;
+                        continue;
+                    }
+                }
+                prev = cur;
+                cur = next;
+            }
+            result.have_more = bucket.has_waiters_for(address);
+            uintptr_t const unpark_token{callback(result)};
+            for (details::parking_lot_waiter *w = unparked_head; w; w = w->next) {
+                w->unpark_token = unpark_token;
+            }
+            bucket.lock.unlock();
+
+            //
+            // Waiter can return from park and go away as soon as it
+            // observes unparked flag, so read next before setting it.
+            // Waking an address that is not waited on anymore is
+            // harmless.
+            //
+            while (unparked_head) {
+                details::parking_lot_waiter *next{unparked_head->next};
+                uint32_t const volatile *unparked{
+                    reinterpret_cast<uint32_t const volatile *>(&unparked_head->unparked)};
+                unparked_head->unparked.store(1, std::memory_order_release);
+                wait_on_address::wake_single(unparked);
+                unparked_head = next;
+            }
+            return result;
+        }
+    };
+
+} // namespace ac
+
+#endif //_AC_HELPERS_WIN32_LIBRARY_PARKING_LOT_HEADER_
@@ -0,0 +1,350 @@
+#ifndef _AC_HELPERS_WIN32_LIBRARY_QUEUE_HEADER_
+#define _AC_HELPERS_WIN32_LIBRARY_QUEUE_HEADER_
+
+#pragma once
+
+#include "accommon.h"
+#include "acwaitonaddress.h"
+
+#include <new>
+#include <thread>
+#include <type_traits>
+
+namespace ac {
+
+    namespace details {
+
+        //
+        // Eventcount that lets consumers sleep while queue is empty.
+        // Producers pay a load of the waiters count after each push,
+        // and touch the sequence word only when someone is waiting.
+        //
+        class queue_waiters {
+        public:
+            [[nodiscard]] uint32_t prepare_wait() noexcept {
+                waiters_.fetch_add(1, std::memory_order_seq_cst);
+                return sequence_.load(std::memory_order_seq_cst);
+            }
+
+            void cancel_wait() noexcept {
+                waiters_.fetch_sub(1, std::memory_order_relaxed);
+            }
+
+            bool commit_wait(uint32_t sequence, DWORD milliseconds) noexcept {
+                bool const woken{wait_on_address::try_wait(sequence_address(), sequence, milliseconds)};
+                waiters_.fetch_sub(1, std::memory_order_relaxed);
+                return woken;
+            }
+
+            //
+            // Caller must order its push before this call with a
+            // sequentially consistent operation
+            //
+            void notify_one() noexcept {
+                if (0 != waiters_.load(std::memory_order_seq_cst)) {
+                    sequence_.fetch_add(1, std::memory_order_seq_cst);
+                    wait_on_address::wake_single(sequence_address());
+                }
+            }
+
+        private:
+            uint32_t const volatile *sequence_address() const noexcept {
+                return reinterpret_cast<uint32_t const volatile *>(&sequence_);
+            }
+
+            std::atomic<uint32_t> waiters_{0};
+            std::atomic<uint32_t> sequence_{0};
+        };
+
+    } // namespace details
+
+    //
+    // Base class for elements of mpsc_queue
+    //
+    struct mpsc_queue_entry {
+        std::atomic<mpsc_queue_entry *> next{nullptr};
+    };
+
+    //
+    // Intrusive unbounded queue with many producers and a single
+    // consumer. Push is one exchange and one store, and never fails.
+    // Queue does not own elements, element must stay alive until it
+    // is popped.
+    //
+    // If producer is preempted between the exchange and the store,
+    // consumer cannot see elements behind it until producer resumes.
+    // try_pop returns nullptr in that case, and pop keeps retrying.
+    //
+    template<typename T>
+    class mpsc_queue {
+    public:
+        static_assert(std::is_base_of_v<mpsc_queue_entry, T>, "T must derive from mpsc_queue_entry");
+
+        mpsc_queue() noexcept
+            : head_{&stub_}
+            , tail_{&stub_} {
+        }
+
+        mpsc_queue(mpsc_queue const &) = delete;
+        mpsc_queue(mpsc_queue &&) = delete;
+
+        mpsc_queue &operator=(mpsc_queue const &) = delete;
+        mpsc_queue &operator=(mpsc_queue &&) = delete;
+
+        //
+        // Can be called by any thread
+        //
+        void push(T *entry) noexcept {
+            push_entry(entry);
+            waiters_.notify_one();
+        }
+
+        //
+        // Can be called only by the consumer thread
+        //
+        [[nodiscard]] T *try_pop() noexcept {
+            mpsc_queue_entry *tail{tail_};
+            mpsc_queue_entry *next{tail->next.load(std::memory_order_acquire)};
+            if (&stub_ == tail) {
+                if (nullptr == next) {
+                    return nullptr;
+                }
+                tail_ = next;
+                tail = next;
+                next = next->next.load(std::memory_order_acquire);
+            }
+            if (nullptr != next) {
+                tail_ = next;
+                return static_cast<T *>(tail);
+            }
+            if (tail != head_.load(std::memory_order_acquire)) {
+                //
+                // Producer is in the middle of a push
+                //
+                return nullptr;
+            }
+            //
+            // Tail is the last element. Put stub behind it so we can
+            // hand the element out.
+            //
+            push_entry(&stub_);
+            next = tail->next.load(std::memory_order_acquire);
+            if (nullptr != next) {
+                tail_ = next;
+                return static_cast<T *>(tail);
+            }
+            return nullptr;
+        }
+
+        //
+        // Can be called only by the consumer thread. Returns nullptr
+        // on timeout.
+        //
+        [[nodiscard]] T *pop(DWORD milliseconds = INFINITE) noexcept {
+            wait_deadline const deadline{milliseconds};
+            for (;;) {
+                if (T *entry{try_pop()}; nullptr != entry) {
+                    return entry;
+                }
+                uint32_t const sequence{waiters_.prepare_wait()};
+                if (!is_empty()) {
+                    //
+                    // Push is in progress, wait for the producer
+                    // to link the element
+                    //
+                    waiters_.cancel_wait();
+                    std::this_thread::yield();
+                    continue;
+                }
+                DWORD const remaining{deadline.remaining()};
+                if (0 == remaining) {
+                    waiters_.cancel_wait();
+                    return nullptr;
+                }
+                waiters_.commit_wait(sequence, remaining);
+            }
+        }
+
+    private:
+        void push_entry(mpsc_queue_entry *entry) noexcept {
+            entry->next.store(nullptr, std::memory_order_relaxed);
+            mpsc_queue_entry *const previous{head_.exchange(entry, std::memory_order_seq_cst)};
+            previous->next.store(entry, std::memory_order_release);
+        }
+
+        //
+        // Can be called only by the consumer thread. Stub is pushed
+        // only when tail is not the stub, so if both ends point to it
+        // there is nothing else in the list.
+        //
+        [[nodiscard]] bool is_empty() const noexcept {
+            return &stub_ == tail_ && &stub_ == head_.load(std::memory_order_seq_cst);
+        }
+
+        alignas(cache_line_size) std::atomic<mpsc_queue_entry *> head_;
+        alignas(cache_line_size) mpsc_queue_entry *tail_;
+        mpsc_queue_entry stub_;
+        alignas(cache_line_size) details::queue_waiters waiters_;
+    };
+
+    //
+    // Bounded queue with many producers and many consumers. Each
+    // slot has a sequence number that tells whether it is ready for
+    // the producer or for the consumer of the current lap, so push
+    // and pop are a single CAS on the position when uncontended.
+    //
+    // N must be a power of two. Push fails when queue is full.
+    // Consumers can block while queue is empty.
+    //
+    template<typename T, size_t N>
+    class mpmc_ring {
+    public:
+        static_assert(N >= 2 && 0 == (N & (N - 1)), "ring capacity must be a power of two");
+        static_assert(std::is_nothrow_move_constructible_v<T>, "T must be nothrow move constructible");
+        static_assert(std::is_nothrow_move_assignable_v<T>, "T must be nothrow move assignable");
+
+        using value_type = T;
+
+        static constexpr size_t capacity{N};
+
+        mpmc_ring() noexcept {
+            for (size_t i = 0; i < N; ++i) {
+                cells_[i].sequence.store(i, std::memory_order_relaxed);
+            }
+        }
+
+        mpmc_ring(mpmc_ring const &) = delete;
+        mpmc_ring(mpmc_ring &&) = delete;
+
+        mpmc_ring &operator=(mpmc_ring const &) = delete;
+        mpmc_ring &operator=(mpmc_ring &&) = delete;
+
+        ~mpmc_ring() noexcept {
+            size_t const end{enqueue_position_.load(std::memory_order_relaxed)};
+            for (size_t position = dequeue_position_.load(std::memory_order_relaxed); position != end;
+                 ++position) {
+                cells_[position & mask].value()->~T();
+            }
+        }
+
+        [[nodiscard]] bool try_push(T const &value) {
+            //
+            // Copy can throw, so make it before a slot is claimed
+            //
+            T copy{value};
+            return try_push(std::move(copy));
+        }
+
+        [[nodiscard]] bool try_push(T &&value) noexcept {
+            size_t position{enqueue_position_.load(std::memory_order_relaxed)};
+            cell *c{nullptr};
+            for (;;) {
+                c = &cells_[position & mask];
+                size_t const sequence{c->sequence.load(std::memory_order_acquire)};
+                intptr_t const difference{static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position)};
+                if (0 == difference) {
+                    if (enqueue_position_.compare_exchange_weak(
+                            position, position + 1, std::memory_order_relaxed, std::memory_order_relaxed)) {
+                        break;
+                    }
+                } else if (difference < 0) {
+                    return false;
+                } else {
+                    position = enqueue_position_.load(std::memory_order_relaxed);
+                }
+            }
+            new (c->storage) T{std::move(value)};
+            c->sequence.store(position + 1, std::memory_order_release);
+            //
+            // Pairs with the fence in pop
+            //
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            waiters_.notify_one();
+            return true;
+        }
+
+        [[nodiscard]] bool try_pop(T &value) noexcept {
+            size_t position{dequeue_position_.load(std::memory_order_relaxed)};
+            cell *c{nullptr};
+            for (;;) {
+                c = &cells_[position & mask];
+                size_t const sequence{c->sequence.load(std::memory_order_acquire)};
+                intptr_t const difference{static_cast<intptr_t>(sequence) -
+                                          static_cast<intptr_t>(position + 1)};
+                if (0 == difference) {
+                    if (dequeue_position_.compare_exchange_weak(
+                            position, position + 1, std::memory_order_relaxed, std::memory_order_relaxed)) {
+                        break;
+                    }
+                } else if (difference < 0) {
+                    return false;
+                } else {
+                    position = dequeue_position_.load(std::memory_order_relaxed);
+                }
+            }
+            T *const stored{c->value()};
+            value = std::move(*stored);
+            stored->~T();
+            c->sequence.store(position + mask + 1, std::memory_order_release);
+            return true;
+        }
+
+        //
+        // Returns false on timeout
+        //
+        [[nodiscard]] bool pop(T &value, DWORD milliseconds = INFINITE) noexcept {
+            wait_deadline const deadline{milliseconds};
+            for (;;) {
+                if (try_pop(value)) {
+                    return true;
+                }
+                uint32_t const sequence{waiters_.prepare_wait()};
+                //
+                // Either producer sees us in the waiters count, or we
+                // see its element
+                //
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+                if (try_pop(value)) {
+                    waiters_.cancel_wait();
+                    return true;
+                }
+                DWORD const remaining{deadline.remaining()};
+                if (0 == remaining) {
+                    waiters_.cancel_wait();
+                    return false;
+                }
+                waiters_.commit_wait(sequence, remaining);
+            }
+        }
+
+        //
+        // Approximate number of elements, can be stale by the time
+        // caller looks at it
+        //
+        [[nodiscard]] size_t size() const noexcept {
+            size_t const dequeue_position{dequeue_position_.load(std::memory_order_relaxed)};
+            size_t const enqueue_position{enqueue_position_.load(std::memory_order_relaxed)};
+            return enqueue_position > dequeue_position ? enqueue_position - dequeue_position : 0;
+        }
+
+    private:
+        static constexpr size_t mask{N - 1};
+
+        struct cell {
+            std::atomic<size_t> sequence;
+            alignas(T) unsigned char storage[sizeof(T)];
+
+            T *value() noexcept {
+                return std::launder(reinterpret_cast<T *>(storage));
+            }
+        };
+
+        alignas(cache_line_size) std::atomic<size_t> enqueue_position_{0};
+        alignas(cache_line_size) std::atomic<size_t> dequeue_position_{0};
+        alignas(cache_line_size) details::queue_waiters waiters_;
+        alignas(cache_line_size) cell cells_[N];
+    };
+
+} // namespace ac
+
+#endif //_AC_HELPERS_WIN32_LIBRARY_QUEUE_HEADER_
@@ -3,6 +3,13 @@
 
 #pragma once
 
+#include "accommon.h"
+#if AC_PLATFORM_LINUX
+#include "acwaitonaddress.h"
+#endif
+
+#include <thread>
+
 namespace ac {
 
     template<typename T>
@@ -146,7 +153,7 @@ namespace ac {
         template<typename... P>
         explicit resource_owner(resource_t *resource, P... param)
             : resource_(nullptr) {
-            try_acquire(resource, param...);
+            static_cast<void>(try_acquire(resource, param...));
         }
 
         void acquire(resource_t *resource) {
@@ -301,6 +308,7 @@ namespace ac {
         return resource_owner<T, typename T::acqiure_exclusive_traits_t>{&resource, param...};
     }
 
+#if AC_PLATFORM_WINDOWS
     class srw_lock final {
     public:
         using acqiure_shared_traits_t = acquire_shared_traits<srw_lock>;
@@ -359,6 +367,300 @@ namespace ac {
 
         SRWLOCK lock_;
     };
+#else
+
+    //
+    // Reader/writer lock on a futex. State word keeps number of
+    // readers, with all reader bits set meaning write locked, and two
+    // flags for waiting readers and writers. Writers wait on a
+    // separate notification word, so releasing the lock can wake
+    // a single writer without waking up readers.
+    //
+    // Writers are preferred. Once a writer is waiting new readers
+    // queue up behind it, and when the lock is released with both
+    // readers and writers waiting only a writer is woken up.
+    //
+    // Both acquire paths spin a little before going to sleep.
+    //
+    class srw_lock final {
+    public:
+        using acqiure_shared_traits_t = acquire_shared_traits<srw_lock>;
+        using acqiure_exclusive_traits_t = acquire_exclusive_traits<srw_lock>;
+        using anti_acquire_shared_traits_t = anti_acquire_shared_traits<srw_lock>;
+        using anti_acquire_exclusive_traits_t = anti_acquire_exclusive_traits<srw_lock>;
+
+        using shared_lock_guard =
+            resource_owner<srw_lock, srw_lock::acqiure_shared_traits_t>;
+        using exclusive_lock_guard =
+            resource_owner<srw_lock, srw_lock::acqiure_exclusive_traits_t>;
+        using anti_shared_lock_guard =
+            resource_owner<srw_lock, srw_lock::anti_acquire_shared_traits_t>;
+        using anti_exclusive_lock_guard =
+            resource_owner<srw_lock, srw_lock::anti_acquire_exclusive_traits_t>;
+
+        srw_lock() noexcept {
+        }
+
+        srw_lock(srw_lock const &) = delete;
+        srw_lock(srw_lock &&) = delete;
+
+        srw_lock &operator=(srw_lock const &) = delete;
+        srw_lock &operator=(srw_lock &&) = delete;
+
+        ~srw_lock() noexcept {
+        }
+
+        void acquire_exclusive() noexcept {
+            uint32_t expected{0};
+            if (!state_.compare_exchange_strong(
+                    expected, write_locked, std::memory_order_acquire, std::memory_order_relaxed)) {
+                acquire_exclusive_contended();
+            }
+        }
+
+        [[nodiscard]] bool try_acquire_exclusive() noexcept {
+            uint32_t state{state_.load(std::memory_order_relaxed)};
+            while (is_unlocked(state)) {
+                if (state_.compare_exchange_weak(
+                        state, state + write_locked, std::memory_order_acquire, std::memory_order_relaxed)) {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        void release_exclusive() noexcept {
+            uint32_t const state{state_.fetch_sub(write_locked, std::memory_order_release) - write_locked};
+            if (has_readers_waiting(state) || has_writers_waiting(state)) {
+                wake_writer_or_readers(state);
+            }
+        }
+
+        void acquire_shared() noexcept {
+            uint32_t state{state_.load(std::memory_order_relaxed)};
+            if (!is_read_lockable(state) ||
+                !state_.compare_exchange_weak(
+                    state, state + read_locked, std::memory_order_acquire, std::memory_order_relaxed)) {
+                acquire_shared_contended();
+            }
+        }
+
+        [[nodiscard]] bool try_acquire_shared() noexcept {
+            uint32_t state{state_.load(std::memory_order_relaxed)};
+            while (is_read_lockable(state)) {
+                if (state_.compare_exchange_weak(
+                        state, state + read_locked, std::memory_order_acquire, std::memory_order_relaxed)) {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        void release_shared() noexcept {
+            uint32_t const state{state_.fetch_sub(read_locked, std::memory_order_release) - read_locked};
+            //
+            // Readers wait only while lock is write locked or a writer
+            // is waiting, so last reader needs to care only about
+            // writers
+            //
+            if (is_unlocked(state) && has_writers_waiting(state)) {
+                wake_writer_or_readers(state);
+            }
+        }
+
+    private:
+        friend class condition_variable;
+
+        static constexpr uint32_t read_locked{1};
+        static constexpr uint32_t mask{(1U << 30) - 1};
+        static constexpr uint32_t write_locked{mask};
+        static constexpr uint32_t max_readers{mask - 1};
+        static constexpr uint32_t readers_waiting{1U << 30};
+        static constexpr uint32_t writers_waiting{1U << 31};
+        static constexpr int spin_count{100};
+
+        [[nodiscard]] static constexpr bool is_unlocked(uint32_t state) noexcept {
+            return 0 == (state & mask);
+        }
+
+        [[nodiscard]] static constexpr bool is_write_locked(uint32_t state) noexcept {
+            return write_locked == (state & mask);
+        }
+
+        [[nodiscard]] static constexpr bool has_readers_waiting(uint32_t state) noexcept {
+            return 0 != (state & readers_waiting);
+        }
+
+        [[nodiscard]] static constexpr bool has_writers_waiting(uint32_t state) noexcept {
+            return 0 != (state & writers_waiting);
+        }
+
+        [[nodiscard]] static constexpr bool is_read_lockable(uint32_t state) noexcept {
+            return (state & mask) < max_readers && !has_readers_waiting(state) &&
+                   !has_writers_waiting(state);
+        }
+
+        template<typename P>
+        [[nodiscard]] uint32_t spin_until(P &&predicate) noexcept {
+            uint32_t state{state_.load(std::memory_order_relaxed)};
+            for (int i = 0; i < spin_count && !predicate(state); ++i) {
+                cpu_relax();
+                state = state_.load(std::memory_order_relaxed);
+            }
+            return state;
+        }
+
+        void acquire_shared_contended() noexcept {
+            uint32_t state{spin_until([](uint32_t state) {
+                return !is_write_locked(state) || has_readers_waiting(state) ||
+                       has_writers_waiting(state);
+            })};
+            for (;;) {
+                if (is_read_lockable(state)) {
+                    if (state_.compare_exchange_weak(
+                            state, state + read_locked, std::memory_order_acquire, std::memory_order_relaxed)) {
+                        return;
+                    }
+                    continue;
+                }
+                AC_CODDING_ERROR_IF(max_readers == (state & mask));
+                if (!has_readers_waiting(state)) {
+                    if (!state_.compare_exchange_weak(
+                            state, state | readers_waiting, std::memory_order_relaxed, std::memory_order_relaxed)) {
+                        continue;
+                    }
+                }
+                static_cast<void>(details::futex_wait(
+                    reinterpret_cast<uint32_t const volatile *>(&state_), state | readers_waiting, INFINITE));
+                state = spin_until([](uint32_t state) {
+                    return !is_write_locked(state) || has_readers_waiting(state) ||
+                           has_writers_waiting(state);
+                });
+            }
+        }
+
+        //
+        // Condition variable requeues its waiters onto the writers
+        // notification word, and they come back here already
+        // counted as waiting writers
+        //
+        void acquire_exclusive_contended(uint32_t other_writers_waiting = 0) noexcept {
+            uint32_t state{spin_until(
+                [](uint32_t state) { return is_unlocked(state) || has_writers_waiting(state); })};
+            //
+            // Once we have waited we do not know whether other writers
+            // are still waiting, so we keep the flag set when we take
+            // the lock and let the release wake them up
+            //
+            for (;;) {
+                if (is_unlocked(state)) {
+                    if (state_.compare_exchange_weak(state,
+                                                     state | write_locked | other_writers_waiting,
+                                                     std::memory_order_acquire,
+                                                     std::memory_order_relaxed)) {
+                        return;
+                    }
+                    continue;
+                }
+                if (!has_writers_waiting(state)) {
+                    if (!state_.compare_exchange_weak(
+                            state, state | writers_waiting, std::memory_order_relaxed, std::memory_order_relaxed)) {
+                        continue;
+                    }
+                }
+                other_writers_waiting = writers_waiting;
+                //
+                // Sample notification sequence before we check state
+                // one last time, so a release that happens in between
+                // makes futex wait fail
+                //
+                uint32_t const sequence{writer_notify_.load(std::memory_order_acquire)};
+                state = state_.load(std::memory_order_relaxed);
+                if (is_unlocked(state) || !has_writers_waiting(state)) {
+                    continue;
+                }
+                static_cast<void>(details::futex_wait(
+                    reinterpret_cast<uint32_t const volatile *>(&writer_notify_), sequence, INFINITE));
+                state = spin_until(
+                    [](uint32_t state) { return is_unlocked(state) || has_writers_waiting(state); });
+            }
+        }
+
+        void acquire_exclusive_requeued() noexcept {
+            acquire_exclusive_contended(writers_waiting);
+        }
+
+        //
+        // Called after condition variable moved its waiters to the
+        // writers notification word. If lock is held its release will
+        // wake one of them, otherwise wake one now.
+        //
+        void writers_requeued() noexcept {
+            uint32_t const state{state_.fetch_or(writers_waiting, std::memory_order_relaxed)};
+            if (is_unlocked(state)) {
+                wake_writer();
+            }
+        }
+
+        [[nodiscard]] uint32_t const volatile *writer_notify_address() const noexcept {
+            return reinterpret_cast<uint32_t const volatile *>(&writer_notify_);
+        }
+
+        //
+        // Returns false if there was nobody sleeping on the futex,
+        // which means a writer that is about to wait will see new
+        // sequence, or we have raced with a writer that just took
+        // the lock.
+        //
+        bool wake_writer() noexcept {
+            writer_notify_.fetch_add(1, std::memory_order_release);
+            return 0 < details::futex_wake(reinterpret_cast<uint32_t const volatile *>(&writer_notify_), 1);
+        }
+
+        //
+        // Lock is unlocked. If somebody locks it while we are here,
+        // then it is up to that thread to wake up waiters when it
+        // releases the lock.
+        //
+        void wake_writer_or_readers(uint32_t state) noexcept {
+            AC_CODDING_ERROR_IF_NOT(is_unlocked(state));
+
+            if (writers_waiting == state) {
+                if (state_.compare_exchange_strong(
+                        state, 0, std::memory_order_relaxed, std::memory_order_relaxed)) {
+                    wake_writer();
+                    return;
+                }
+            }
+            //
+            // Prefer writers, readers keep waiting. If no writer was
+            // asleep we cannot tell whether one was notified, so wake
+            // up readers as well.
+            //
+            if ((readers_waiting | writers_waiting) == state) {
+                if (!state_.compare_exchange_strong(
+                        state, readers_waiting, std::memory_order_relaxed, std::memory_order_relaxed)) {
+                    return;
+                }
+                if (wake_writer()) {
+                    return;
+                }
+                state = readers_waiting;
+            }
+
+            if (readers_waiting == state) {
+                if (state_.compare_exchange_strong(
+                        state, 0, std::memory_order_relaxed, std::memory_order_relaxed)) {
+                    details::futex_wake(reinterpret_cast<uint32_t const volatile *>(&state_), INT_MAX);
+                }
+            }
+        }
+
+        std::atomic<uint32_t> state_{0};
+        std::atomic<uint32_t> writer_notify_{0};
+    };
+
+#endif // AC_PLATFORM_WINDOWS
 
     class rw_lock final {
     public:
@@ -382,7 +684,7 @@ namespace ac {
 
         ~rw_lock() noexcept {
             if (0 != exclusive_owner_ || 0 != readers_count_) {
-                __fastfail(1);
+                AC_FAST_FAIL(1);
             }
         }
 
@@ -423,7 +725,7 @@ namespace ac {
         }
 
         [[nodiscard]] bool i_have_lock() const noexcept {
-            return (exclusive_owner_.load(std::memory_order_acquire) == GetCurrentThreadId());
+            return (exclusive_owner_.load(std::memory_order_acquire) == current_thread_id());
         }
 
     private:
@@ -431,28 +733,28 @@ namespace ac {
 
         void dbg_release_shared() noexcept {
             if (0 >= readers_count_.fetch_add(-1, std::memory_order_relaxed)) {
-                __fastfail(1);
+                AC_FAST_FAIL(1);
             }
         }
 
         void dbg_acquire_shared() noexcept {
             if (0 > readers_count_.fetch_add(1, std::memory_order_relaxed)) {
-                __fastfail(1);
+                AC_FAST_FAIL(1);
             }
         }
 
         void dbg_release_exclusive() noexcept {
             DWORD prev_owner = exclusive_owner_.exchange(0, std::memory_order_acq_rel);
-            if (prev_owner != GetCurrentThreadId()) {
-                __fastfail(1);
+            if (prev_owner != current_thread_id()) {
+                AC_FAST_FAIL(1);
             }
         }
 
         void dbg_acquire_exclusive() noexcept {
             DWORD prev_owner = exclusive_owner_.exchange(
-                GetCurrentThreadId(), std::memory_order_release);
+                current_thread_id(), std::memory_order_release);
             if (prev_owner != 0) {
-                __fastfail(1);
+                AC_FAST_FAIL(1);
             }
         }
 
@@ -461,8 +763,515 @@ namespace ac {
         // Following two fields are here just to help with debugging
         //
         std::atomic<DWORD> exclusive_owner_;
-        std::atomic<LONG> readers_count_;
+        std::atomic<long> readers_count_;
+    };
+
+    //
+    // Condition variable that works with srw_lock and rw_lock held
+    // either shared or exclusive. All waiters must use the same lock.
+    // Waits can wake up spuriously, so use predicate overloads or
+    // recheck the condition.
+    //
+    // On Linux exclusive and shared waiters sleep on separate futex
+    // words. notify_all wakes all shared waiters, since they can hold
+    // the lock together, but wakes only one exclusive waiter and moves
+    // the rest to the lock, so they are woken one by one as the lock
+    // is released instead of all of them running into it at once.
+    //
+    class condition_variable final {
+    public:
+        condition_variable() noexcept {
+#if AC_PLATFORM_WINDOWS
+            InitializeConditionVariable(&cv_);
+#endif
+        }
+
+        condition_variable(condition_variable const &) = delete;
+        condition_variable(condition_variable &&) = delete;
+
+        condition_variable &operator=(condition_variable const &) = delete;
+        condition_variable &operator=(condition_variable &&) = delete;
+
+        ~condition_variable() noexcept {
+        }
+
+        //
+        // Returns false if wait timed out
+        //
+        [[nodiscard]] bool try_wait_exclusive(srw_lock &lock, DWORD milliseconds = INFINITE) noexcept {
+#if AC_PLATFORM_WINDOWS
+            return sleep(lock, milliseconds, 0);
+#else
+            lock_.store(&lock, std::memory_order_relaxed);
+            exclusive_waiters_.fetch_add(1, std::memory_order_seq_cst);
+            uint32_t const sequence{exclusive_sequence_.load(std::memory_order_seq_cst)};
+            lock.release_exclusive();
+            bool const woken{details::futex_wait(
+                reinterpret_cast<uint32_t const volatile *>(&exclusive_sequence_), sequence, milliseconds)};
+            exclusive_waiters_.fetch_sub(1, std::memory_order_relaxed);
+            lock.acquire_exclusive_requeued();
+            return woken;
+#endif
+        }
+
+        [[nodiscard]] bool try_wait_shared(srw_lock &lock, DWORD milliseconds = INFINITE) noexcept {
+#if AC_PLATFORM_WINDOWS
+            return sleep(lock, milliseconds, CONDITION_VARIABLE_LOCKMODE_SHARED);
+#else
+            shared_waiters_.fetch_add(1, std::memory_order_seq_cst);
+            uint32_t const sequence{shared_sequence_.load(std::memory_order_seq_cst)};
+            lock.release_shared();
+            bool const woken{details::futex_wait(
+                reinterpret_cast<uint32_t const volatile *>(&shared_sequence_), sequence, milliseconds)};
+            shared_waiters_.fetch_sub(1, std::memory_order_relaxed);
+            lock.acquire_shared();
+            return woken;
+#endif
+        }
+
+        [[nodiscard]] bool try_wait_exclusive(rw_lock &lock, DWORD milliseconds = INFINITE) noexcept {
+            lock.dbg_release_exclusive();
+            bool const woken{try_wait_exclusive(lock.lock_, milliseconds)};
+            lock.dbg_acquire_exclusive();
+            return woken;
+        }
+
+        [[nodiscard]] bool try_wait_shared(rw_lock &lock, DWORD milliseconds = INFINITE) noexcept {
+            lock.dbg_release_shared();
+            bool const woken{try_wait_shared(lock.lock_, milliseconds)};
+            lock.dbg_acquire_shared();
+            return woken;
+        }
+
+        template<typename L>
+        void wait_exclusive(L &lock) noexcept {
+            static_cast<void>(try_wait_exclusive(lock, INFINITE));
+        }
+
+        template<typename L>
+        void wait_shared(L &lock) noexcept {
+            static_cast<void>(try_wait_shared(lock, INFINITE));
+        }
+
+        template<typename L, typename P>
+        void wait_exclusive(L &lock, P &&predicate) {
+            while (!predicate()) {
+                wait_exclusive(lock);
+            }
+        }
+
+        template<typename L, typename P>
+        void wait_shared(L &lock, P &&predicate) {
+            while (!predicate()) {
+                wait_shared(lock);
+            }
+        }
+
+        //
+        // Returns value of the predicate, which is false only if
+        // wait timed out
+        //
+        template<typename L, typename P>
+        [[nodiscard]] bool try_wait_exclusive(L &lock, P &&predicate, DWORD milliseconds) {
+            return wait_until(predicate, milliseconds, [this, &lock](DWORD left) {
+                return try_wait_exclusive(lock, left);
+            });
+        }
+
+        template<typename L, typename P>
+        [[nodiscard]] bool try_wait_shared(L &lock, P &&predicate, DWORD milliseconds) {
+            return wait_until(predicate, milliseconds, [this, &lock](DWORD left) {
+                return try_wait_shared(lock, left);
+            });
+        }
+
+        void notify_one() noexcept {
+#if AC_PLATFORM_WINDOWS
+            WakeConditionVariable(&cv_);
+#else
+            //
+            // If exclusive waiter has not gone to sleep yet then
+            // changing sequence is what wakes it up, and we cannot
+            // tell, so wake up a shared waiter as well
+            //
+            if (0 != exclusive_waiters_.load(std::memory_order_seq_cst)) {
+                exclusive_sequence_.fetch_add(1, std::memory_order_seq_cst);
+                if (0 < details::futex_wake(
+                            reinterpret_cast<uint32_t const volatile *>(&exclusive_sequence_), 1)) {
+                    return;
+                }
+            }
+            if (0 != shared_waiters_.load(std::memory_order_seq_cst)) {
+                shared_sequence_.fetch_add(1, std::memory_order_seq_cst);
+                details::futex_wake(reinterpret_cast<uint32_t const volatile *>(&shared_sequence_), 1);
+            }
+#endif
+        }
+
+        void notify_all() noexcept {
+#if AC_PLATFORM_WINDOWS
+            WakeAllConditionVariable(&cv_);
+#else
+            if (0 != shared_waiters_.load(std::memory_order_seq_cst)) {
+                shared_sequence_.fetch_add(1, std::memory_order_seq_cst);
+                details::futex_wake(reinterpret_cast<uint32_t const volatile *>(&shared_sequence_), INT_MAX);
+            }
+            if (0 != exclusive_waiters_.load(std::memory_order_seq_cst)) {
+                uint32_t const volatile *const address{
+                    reinterpret_cast<uint32_t const volatile *>(&exclusive_sequence_)};
+                uint32_t const sequence{exclusive_sequence_.fetch_add(1, std::memory_order_seq_cst) + 1};
+                srw_lock *const lock{lock_.load(std::memory_order_relaxed)};
+                long const moved{details::futex_requeue(address, 1, lock->writer_notify_address(), sequence)};
+                if (0 > moved) {
+                    //
+                    // Another notify changed sequence under us
+                    //
+                    details::futex_wake(address, INT_MAX);
+                } else if (1 < moved) {
+                    lock->writers_requeued();
+                }
+            }
+#endif
+        }
+
+    private:
+        template<typename P, typename W>
+        [[nodiscard]] static bool wait_until(P &predicate, DWORD milliseconds, W &&wait) {
+            if (INFINITE == milliseconds) {
+                while (!predicate()) {
+                    static_cast<void>(wait(INFINITE));
+                }
+                return true;
+            }
+            auto const deadline{std::chrono::steady_clock::now() +
+                                std::chrono::milliseconds{milliseconds}};
+            while (!predicate()) {
+                auto const now{std::chrono::steady_clock::now()};
+                if (now >= deadline) {
+                    return false;
+                }
+                static_cast<void>(wait(static_cast<DWORD>(
+                    std::chrono::ceil<std::chrono::milliseconds>(deadline - now).count())));
+            }
+            return true;
+        }
+
+#if AC_PLATFORM_WINDOWS
+        [[nodiscard]] bool sleep(srw_lock &lock, DWORD milliseconds, ULONG flags) noexcept {
+            if (SleepConditionVariableSRW(&cv_, &lock.lock_, milliseconds, flags)) {
+                return true;
+            }
+            AC_CODDING_ERROR_IF_NOT(ERROR_TIMEOUT == GetLastError());
+            return false;
+        }
+
+        CONDITION_VARIABLE cv_;
+#else
+        std::atomic<uint32_t> exclusive_sequence_{0};
+        std::atomic<uint32_t> shared_sequence_{0};
+        std::atomic<uint32_t> exclusive_waiters_{0};
+        std::atomic<uint32_t> shared_waiters_{0};
+        //
+        // Lock exclusive waiters are requeued to
+        //
+        std::atomic<srw_lock *> lock_{nullptr};
+#endif
     };
+
+    namespace details {
+
+        //
+        // Slots where a thread announces which bravo locks it holds
+        // shared on the fast path. Only owning thread writes to its
+        // record, and writers revoking bias only read it.
+        //
+        struct alignas(cache_line_size) bravo_reader_record {
+            static constexpr size_t slots_count{8};
+
+            std::atomic<void const *> locks[slots_count]{};
+            uint32_t depth[slots_count]{};
+            std::atomic<bool> in_use{false};
+            bravo_reader_record *next{nullptr};
+        };
+
+        //
+        // Records are never freed, since threads can exit after static
+        // objects are destroyed. Record of an exited thread is reused.
+        //
+        class bravo_registry {
+        public:
+            [[nodiscard]] static bravo_registry &instance() noexcept {
+                static bravo_registry registry;
+                return registry;
+            }
+
+            [[nodiscard]] bravo_reader_record *acquire_record() {
+                for (bravo_reader_record *record = head(); record; record = record->next) {
+                    bool expected{false};
+                    if (!record->in_use.load(std::memory_order_relaxed) &&
+                        record->in_use.compare_exchange_strong(
+                            expected, true, std::memory_order_acquire, std::memory_order_relaxed)) {
+                        return record;
+                    }
+                }
+                bravo_reader_record *record{new bravo_reader_record};
+                record->in_use.store(true, std::memory_order_relaxed);
+                record->next = head_.load(std::memory_order_relaxed);
+                while (!head_.compare_exchange_weak(
+                    record->next, record, std::memory_order_release, std::memory_order_relaxed)) {
+                }
+                return record;
+            }
+
+            [[nodiscard]] bravo_reader_record *head() const noexcept {
+                return head_.load(std::memory_order_acquire);
+            }
+
+        private:
+            bravo_registry() noexcept {
+            }
+
+            std::atomic<bravo_reader_record *> head_{nullptr};
+        };
+
+        struct bravo_thread_record {
+            bravo_reader_record *record{nullptr};
+
+            ~bravo_thread_record() {
+                if (record) {
+                    for (auto const &lock : record->locks) {
+                        AC_CODDING_ERROR_IF(lock.load(std::memory_order_relaxed));
+                    }
+                    record->in_use.store(false, std::memory_order_release);
+                }
+            }
+        };
+
+        [[nodiscard]] inline bravo_reader_record &current_bravo_record() {
+            thread_local bravo_thread_record local;
+            if (!local.record) {
+                local.record = bravo_registry::instance().acquire_record();
+            }
+            return *local.record;
+        }
+    } // namespace details
+
+    //
+    // Reader biased wrapper around a reader/writer lock (BRAVO).
+    // While lock is biased towards readers, shared acquire publishes
+    // the lock in a slot of the thread's own record and does not
+    // touch the underlying lock, so readers on different processors
+    // do not bounce a shared cache line.
+    //
+    // Exclusive acquire takes the underlying lock, revokes the bias,
+    // and waits for fast path readers to leave. Bias is restored by
+    // a slow path reader once a period proportional to how long the
+    // last revocation took has passed, so write heavy phases mostly
+    // run on the underlying lock.
+    //
+    // Use it for tables that are read on every call and written
+    // rarely. Every write pays for a scan of all threads records.
+    //
+    template<typename L = srw_lock>
+    class bravo_lock final {
+    public:
+        using lock_t = L;
+
+        using acqiure_shared_traits_t = acquire_shared_traits<bravo_lock>;
+        using acqiure_exclusive_traits_t = acquire_exclusive_traits<bravo_lock>;
+        using anti_acquire_shared_traits_t = anti_acquire_shared_traits<bravo_lock>;
+        using anti_acquire_exclusive_traits_t = anti_acquire_exclusive_traits<bravo_lock>;
+
+        using shared_lock_guard = resource_owner<bravo_lock, acqiure_shared_traits_t>;
+        using exclusive_lock_guard = resource_owner<bravo_lock, acqiure_exclusive_traits_t>;
+        using anti_shared_lock_guard = resource_owner<bravo_lock, anti_acquire_shared_traits_t>;
+        using anti_exclusive_lock_guard =
+            resource_owner<bravo_lock, anti_acquire_exclusive_traits_t>;
+
+        bravo_lock() noexcept {
+        }
+
+        bravo_lock(bravo_lock const &) = delete;
+        bravo_lock(bravo_lock &&) = delete;
+
+        bravo_lock &operator=(bravo_lock const &) = delete;
+        bravo_lock &operator=(bravo_lock &&) = delete;
+
+        ~bravo_lock() noexcept {
+        }
+
+        void acquire_exclusive() noexcept {
+            lock_.acquire_exclusive();
+            if (reader_bias_.load(std::memory_order_relaxed)) {
+                revoke_bias();
+            }
+        }
+
+        //
+        // Fails if there are fast path readers, and then leaves
+        // bias as it was
+        //
+        [[nodiscard]] bool try_acquire_exclusive() noexcept {
+            if (!lock_.try_acquire_exclusive()) {
+                return false;
+            }
+            if (reader_bias_.load(std::memory_order_relaxed)) {
+                reader_bias_.store(false, std::memory_order_relaxed);
+                heavy_memory_barrier();
+                if (has_fast_readers()) {
+                    reader_bias_.store(true, std::memory_order_release);
+                    lock_.release_exclusive();
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        void release_exclusive() noexcept {
+            lock_.release_exclusive();
+        }
+
+        void acquire_shared() noexcept {
+            if (reader_bias_.load(std::memory_order_acquire) && try_acquire_shared_fast()) {
+                return;
+            }
+            lock_.acquire_shared();
+            maybe_restore_bias();
+        }
+
+        [[nodiscard]] bool try_acquire_shared() noexcept {
+            if (reader_bias_.load(std::memory_order_acquire) && try_acquire_shared_fast()) {
+                return true;
+            }
+            if (!lock_.try_acquire_shared()) {
+                return false;
+            }
+            maybe_restore_bias();
+            return true;
+        }
+
+        void release_shared() noexcept {
+            details::bravo_reader_record &record{details::current_bravo_record()};
+            for (size_t i = 0; i < details::bravo_reader_record::slots_count; ++i) {
+                if (this == record.locks[i].load(std::memory_order_relaxed)) {
+                    if (0 == --record.depth[i]) {
+                        record.locks[i].store(nullptr, std::memory_order_release);
+                    }
+                    return;
+                }
+            }
+            lock_.release_shared();
+        }
+
+        [[nodiscard]] bool is_reader_biased() const noexcept {
+            return reader_bias_.load(std::memory_order_relaxed);
+        }
+
+    private:
+        //
+        // How many times longer than last revocation we stay
+        // unbiased
+        //
+        static constexpr uint64_t inhibit_multiplier{9};
+        static constexpr int revoke_spin_count{100};
+
+        [[nodiscard]] static uint64_t now() noexcept {
+            return static_cast<uint64_t>(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    std::chrono::steady_clock::now().time_since_epoch())
+                    .count());
+        }
+
+        //
+        // Publish in our slot first and then recheck bias. Writer
+        // clears bias first and then scans slots. Light barrier here
+        // pairs with the heavy barrier in revoke_bias, so either we
+        // see bias cleared or writer sees our slot.
+        //
+        [[nodiscard]] bool try_acquire_shared_fast() noexcept {
+            details::bravo_reader_record &record{details::current_bravo_record()};
+            size_t free_slot{details::bravo_reader_record::slots_count};
+            for (size_t i = 0; i < details::bravo_reader_record::slots_count; ++i) {
+                void const *const lock{record.locks[i].load(std::memory_order_relaxed)};
+                if (this == lock) {
+                    ++record.depth[i];
+                    return true;
+                }
+                if (nullptr == lock && details::bravo_reader_record::slots_count == free_slot) {
+                    free_slot = i;
+                }
+            }
+            if (details::bravo_reader_record::slots_count == free_slot) {
+                return false;
+            }
+            record.locks[free_slot].store(this, std::memory_order_relaxed);
+            light_memory_barrier();
+            if (reader_bias_.load(std::memory_order_acquire)) {
+                record.depth[free_slot] = 1;
+                return true;
+            }
+            record.locks[free_slot].store(nullptr, std::memory_order_relaxed);
+            return false;
+        }
+
+        [[nodiscard]] bool has_fast_readers() const noexcept {
+            for (details::bravo_reader_record *record = details::bravo_registry::instance().head();
+                 record;
+                 record = record->next) {
+                for (auto const &lock : record->locks) {
+                    if (this == lock.load(std::memory_order_acquire)) {
+                        return true;
+                    }
+                }
+            }
+            return false;
+        }
+
+        //
+        // Called with underlying lock held exclusive
+        //
+        void revoke_bias() noexcept {
+            reader_bias_.store(false, std::memory_order_relaxed);
+            heavy_memory_barrier();
+            uint64_t const start{now()};
+            for (details::bravo_reader_record *record = details::bravo_registry::instance().head();
+                 record;
+                 record = record->next) {
+                for (auto const &lock : record->locks) {
+                    //
+                    // Reader might have been preempted while holding
+                    // the lock, so do not burn the whole quantum
+                    //
+                    for (int i = 0; this == lock.load(std::memory_order_acquire); ++i) {
+                        if (i < revoke_spin_count) {
+                            cpu_relax();
+                        } else {
+                            std::this_thread::yield();
+                        }
+                    }
+                }
+            }
+            uint64_t const finish{now()};
+            inhibit_until_.store(finish + (finish - start) * inhibit_multiplier,
+                                 std::memory_order_relaxed);
+        }
+
+        //
+        // Called with underlying lock held shared, so no writer can
+        // be revoking bias at the same time
+        //
+        void maybe_restore_bias() noexcept {
+            if (!reader_bias_.load(std::memory_order_relaxed) &&
+                now() >= inhibit_until_.load(std::memory_order_relaxed)) {
+                reader_bias_.store(true, std::memory_order_release);
+            }
+        }
+
+        std::atomic<bool> reader_bias_{true};
+        std::atomic<uint64_t> inhibit_until_{0};
+        lock_t lock_;
+    };
+
 } // namespace ac
 
 #endif //_AC_HELPERS_WIN32_LIBRARY_RESOURCE_OWNERL_HEADER_
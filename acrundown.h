@@ -5,9 +5,22 @@
 
 #include "accommon.h"
 #include "acwaitonaddress.h"
-#include "ackernelobject.h"
+#include "acparkinglot.h"
+#include "acslimevent.h"
 #include "acresourceowner.h"
 
+#include <coroutine>
+#include <thread>
+#include <source_location>
+
+//
+// Define AC_RUNDOWN_INSTRUMENTED to 1 to make rundowns collect
+// rundown_stats by default
+//
+#ifndef AC_RUNDOWN_INSTRUMENTED
+#define AC_RUNDOWN_INSTRUMENTED 0
+#endif
+
 namespace ac {
 
     class rundown_exception: public std::system_error {
@@ -118,15 +131,377 @@ namespace ac {
             T *master_{nullptr};
             bool master_acquired_{false};
         };
+
+        //
+        // Completion latch of a rundown with an optional continuation.
+        // Exactly one thread completes it in each rundown cycle,
+        // either the thread that released the last reference or the
+        // thread that started rundown when there were no references.
+        //
+        // Continuation is moved out before completion is published,
+        // and after that the latch is not touched, so a joiner is free
+        // to destroy the rundown as soon as it observes completion.
+        //
+        class rundown_completion {
+        public:
+            using callback_t = std::move_only_function<void()>;
+
+            rundown_completion() noexcept {
+            }
+
+            rundown_completion(rundown_completion const &) = delete;
+            rundown_completion &operator=(rundown_completion const &) = delete;
+
+            ~rundown_completion() noexcept {
+                AC_CODDING_ERROR_IF(installed == state_.load(std::memory_order_relaxed));
+            }
+
+            //
+            // Returns false if rundown is already complete, and
+            // leaves callback to the caller. Only one continuation
+            // can be pending at a time.
+            //
+            [[nodiscard]] bool try_install(callback_t &callback) noexcept {
+                uint32_t expected{none};
+                callback_ = std::move(callback);
+                if (state_.compare_exchange_strong(
+                        expected, installed, std::memory_order_acq_rel, std::memory_order_acquire)) {
+                    return true;
+                }
+                AC_CODDING_ERROR_IF(installed == expected);
+                callback = std::exchange(callback_, nullptr);
+                return false;
+            }
+
+            //
+            // Returns continuation that caller has to run
+            //
+            [[nodiscard]] callback_t complete() noexcept {
+                callback_t callback;
+                uint32_t state{state_.load(std::memory_order_relaxed)};
+                for (;;) {
+                    AC_CODDING_ERROR_IF(firing == state || completed == state);
+                    if (state_.compare_exchange_weak(
+                            state, firing, std::memory_order_acq_rel, std::memory_order_relaxed)) {
+                        break;
+                    }
+                }
+                if (installed == state) {
+                    callback = std::exchange(callback_, nullptr);
+                }
+                void const volatile *const address{&state_};
+                state_.store(completed, std::memory_order_release);
+                parking_lot::unpark_one(address);
+                return callback;
+            }
+
+            //
+            // Joiners are unparked one by one, each joiner passes
+            // wake up to the next one. Wake up that came before
+            // completion, e.g. for a previous rundown cycle or for an
+            // object that used the same address, is not a completion,
+            // so joiner parks again.
+            //
+            void wait() noexcept {
+                void const volatile *const address{&state_};
+                bool was_unparked{false};
+                while (!is_complete()) {
+                    park_result const result{parking_lot::park(address, [this]() noexcept {
+                        return completed != state_.load(std::memory_order_acquire);
+                    })};
+                    if (park_result::unparked == result) {
+                        was_unparked = true;
+                    }
+                }
+                if (was_unparked) {
+                    parking_lot::unpark_one(address);
+                }
+            }
+
+            [[nodiscard]] bool is_complete() const noexcept {
+                return completed == state_.load(std::memory_order_acquire);
+            }
+
+            [[nodiscard]] bool is_pending() const noexcept {
+                return installed == state_.load(std::memory_order_relaxed);
+            }
+
+            void reset() noexcept {
+                AC_CODDING_ERROR_IF(is_pending());
+                state_.store(none, std::memory_order_relaxed);
+            }
+
+        private:
+            enum : uint32_t {
+                none = 0,
+                installed = 1,
+                firing = 2,
+                completed = 3,
+            };
+
+            std::atomic<uint32_t> state_{none};
+            callback_t callback_;
+        };
+
+        //
+        // co_await rundown.join_async() starts rundown and resumes
+        // coroutine once it completes. Coroutine resumes on the thread
+        // that released the last reference, or does not suspend if
+        // rundown is already complete. See ac::tp::join_async for an
+        // awaiter that resumes on a thread pool.
+        //
+        template<typename R>
+        class rundown_join_awaiter {
+        public:
+            explicit rundown_join_awaiter(R *rundown) noexcept
+                : rundown_(rundown) {
+            }
+
+            [[nodiscard]] bool await_ready() const noexcept {
+                return false;
+            }
+
+            [[nodiscard]] bool await_suspend(std::coroutine_handle<> handle) {
+                rundown_completion::callback_t continuation{[handle]() { handle.resume(); }};
+                return rundown_->try_join_async(continuation);
+            }
+
+            void await_resume() const noexcept {
+            }
+
+        private:
+            R *rundown_;
+        };
+    } // namespace details
+
+    using rundown_continuation = details::rundown_completion::callback_t;
+
+    //
+    // Counters collected by an instrumented rundown. Durations are
+    // measured from the moment cancelation bit is set till the
+    // moment rundown completes.
+    //
+    struct rundown_stats_snapshot {
+        uint64_t acquires{0};
+        uint64_t failed_acquires{0};
+        uint64_t cas_retries{0};
+        uint64_t max_cas_retries{0};
+        uint64_t peak_count{0};
+        uint64_t rundowns_started{0};
+        uint64_t rundowns_completed{0};
+        std::chrono::nanoseconds last_rundown_duration{0};
+        std::chrono::nanoseconds max_rundown_duration{0};
+    };
+
+    namespace details {
+
+        //
+        // Default stats policy. Compiles to nothing.
+        //
+        struct noop_rundown_stats {
+            void acquired(uint64_t, uint32_t) noexcept {
+            }
+
+            void acquire_failed(uint32_t) noexcept {
+            }
+
+            void rundown_started() noexcept {
+            }
+
+            void rundown_completed() noexcept {
+            }
+
+            [[nodiscard]] size_t site_acquired(std::source_location const &) noexcept {
+                return 0;
+            }
+
+            void site_released(size_t) noexcept {
+            }
+
+            [[nodiscard]] rundown_stats_snapshot snapshot() const noexcept {
+                return rundown_stats_snapshot{};
+            }
+
+            template<typename F>
+            void for_each_site(F &&) const {
+            }
+        };
+
+        inline void atomic_max(std::atomic<uint64_t> &value, uint64_t candidate) noexcept {
+            uint64_t current{value.load(std::memory_order_relaxed)};
+            while (current < candidate &&
+                   !value.compare_exchange_weak(
+                       current, candidate, std::memory_order_relaxed, std::memory_order_relaxed)) {
+            }
+        }
+    } // namespace details
+
+    //
+    // Stats policy that counts CAS retries, failed acquires, peak
+    // number of concurrent holders, and how long rundowns take to
+    // complete. All counters are relaxed atomics that are updated on
+    // every acquire, so they add contention, and are meant to be
+    // enabled while chasing a slow or hung shutdown.
+    //
+    // It also tracks outstanding references per call site for locks
+    // taken with rundown_site_lock. Call sites are kept in a small
+    // fixed table, and sites that do not fit are not tracked.
+    //
+    class rundown_stats {
+    public:
+        static constexpr size_t sites_count{32};
+        static constexpr size_t untracked_site{sites_count};
+
+        rundown_stats() noexcept {
+        }
+
+        rundown_stats(rundown_stats const &) = delete;
+        rundown_stats &operator=(rundown_stats const &) = delete;
+
+        void acquired(uint64_t count, uint32_t retries) noexcept {
+            acquires_.fetch_add(1, std::memory_order_relaxed);
+            if (retries) {
+                cas_retries_.fetch_add(retries, std::memory_order_relaxed);
+                details::atomic_max(max_cas_retries_, retries);
+            }
+            details::atomic_max(peak_count_, count);
+        }
+
+        void acquire_failed(uint32_t retries) noexcept {
+            failed_acquires_.fetch_add(1, std::memory_order_relaxed);
+            cas_retries_.fetch_add(retries, std::memory_order_relaxed);
+        }
+
+        void rundown_started() noexcept {
+            rundown_started_at_.store(now(), std::memory_order_relaxed);
+            rundowns_started_.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        void rundown_completed() noexcept {
+            uint64_t const duration{now() - rundown_started_at_.load(std::memory_order_relaxed)};
+            last_rundown_duration_.store(duration, std::memory_order_relaxed);
+            details::atomic_max(max_rundown_duration_, duration);
+            rundowns_completed_.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        [[nodiscard]] size_t site_acquired(std::source_location const &location) noexcept {
+            uintptr_t const key{reinterpret_cast<uintptr_t>(location.file_name())};
+            size_t index{(key ^ (static_cast<uintptr_t>(location.line()) * 0x9E3779B1U)) % sites_count};
+            for (size_t probe = 0; probe < sites_count; ++probe, index = (index + 1) % sites_count) {
+                site &s{sites_[index]};
+                uint32_t state{s.state.load(std::memory_order_acquire)};
+                if (site_empty == state &&
+                    s.state.compare_exchange_strong(
+                        state, site_claiming, std::memory_order_acquire, std::memory_order_acquire)) {
+                    s.file = location.file_name();
+                    s.function = location.function_name();
+                    s.line = location.line();
+                    s.state.store(site_ready, std::memory_order_release);
+                    state = site_ready;
+                }
+                while (site_claiming == state) {
+                    std::this_thread::yield();
+                    state = s.state.load(std::memory_order_acquire);
+                }
+                if (s.line == location.line() && s.file == location.file_name()) {
+                    s.outstanding.fetch_add(1, std::memory_order_relaxed);
+                    s.acquires.fetch_add(1, std::memory_order_relaxed);
+                    return index;
+                }
+            }
+            return untracked_site;
+        }
+
+        void site_released(size_t index) noexcept {
+            if (untracked_site != index) {
+                sites_[index].outstanding.fetch_sub(1, std::memory_order_relaxed);
+            }
+        }
+
+        [[nodiscard]] rundown_stats_snapshot snapshot() const noexcept {
+            rundown_stats_snapshot result;
+            result.acquires = acquires_.load(std::memory_order_relaxed);
+            result.failed_acquires = failed_acquires_.load(std::memory_order_relaxed);
+            result.cas_retries = cas_retries_.load(std::memory_order_relaxed);
+            result.max_cas_retries = max_cas_retries_.load(std::memory_order_relaxed);
+            result.peak_count = peak_count_.load(std::memory_order_relaxed);
+            result.rundowns_started = rundowns_started_.load(std::memory_order_relaxed);
+            result.rundowns_completed = rundowns_completed_.load(std::memory_order_relaxed);
+            result.last_rundown_duration =
+                std::chrono::nanoseconds{last_rundown_duration_.load(std::memory_order_relaxed)};
+            result.max_rundown_duration =
+                std::chrono::nanoseconds{max_rundown_duration_.load(std::memory_order_relaxed)};
+            return result;
+        }
+
+        //
+        // Calls f(file, line, function, outstanding, acquires) for
+        // each call site. Use it to find who holds a rundown that
+        // does not complete.
+        //
+        template<typename F>
+        void for_each_site(F &&f) const {
+            for (site const &s : sites_) {
+                if (site_ready == s.state.load(std::memory_order_acquire)) {
+                    f(s.file,
+                      s.line,
+                      s.function,
+                      s.outstanding.load(std::memory_order_relaxed),
+                      s.acquires.load(std::memory_order_relaxed));
+                }
+            }
+        }
+
+    private:
+        static constexpr uint32_t site_empty{0};
+        static constexpr uint32_t site_claiming{1};
+        static constexpr uint32_t site_ready{2};
+
+        struct site {
+            std::atomic<uint32_t> state{site_empty};
+            uint32_t line{0};
+            char const *file{nullptr};
+            char const *function{nullptr};
+            std::atomic<int64_t> outstanding{0};
+            std::atomic<uint64_t> acquires{0};
+        };
+
+        [[nodiscard]] static uint64_t now() noexcept {
+            return static_cast<uint64_t>(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    std::chrono::steady_clock::now().time_since_epoch())
+                    .count());
+        }
+
+        std::atomic<uint64_t> acquires_{0};
+        std::atomic<uint64_t> failed_acquires_{0};
+        std::atomic<uint64_t> cas_retries_{0};
+        std::atomic<uint64_t> max_cas_retries_{0};
+        std::atomic<uint64_t> peak_count_{0};
+        std::atomic<uint64_t> rundowns_started_{0};
+        std::atomic<uint64_t> rundowns_completed_{0};
+        std::atomic<uint64_t> rundown_started_at_{0};
+        std::atomic<uint64_t> last_rundown_duration_{0};
+        std::atomic<uint64_t> max_rundown_duration_{0};
+        site sites_[sites_count];
+    };
+
+    namespace details {
+#if AC_RUNDOWN_INSTRUMENTED
+        using default_rundown_stats = rundown_stats;
+#else
+        using default_rundown_stats = noop_rundown_stats;
+#endif
     } // namespace details
 
-    template<typename T = details::noop_rundown_base>
+    template<typename T = details::noop_rundown_base, typename S = details::default_rundown_stats>
     class rundown_counter: public T {
     protected:
         using base_t = T;
 
     public:
-#ifdef _WIN64
+        using stats_t = S;
+#if defined(_WIN64) || defined(__LP64__)
         using counter_t = uint64_t;
         static counter_t const COUNTER_MAX_VALUE = 0x7FFFFFFFFFFFFFFFLL;
 #else
@@ -164,9 +539,9 @@ namespace ac {
         rundown_counter(rundown_counter &&) = delete;
         rundown_counter &operator=(rundown_counter &&) = delete;
 
-        template<typename... T>
-        explicit rundown_counter(T &&...Args) {
-            AC_CODDING_ERROR_IF_NOT(this->try_start(false, std::forward<T>(Args)...));
+        template<typename... A>
+        explicit rundown_counter(A &&...Args) {
+            AC_CODDING_ERROR_IF_NOT(this->try_start(false, std::forward<A>(Args)...));
         }
 
         ~rundown_counter() {
@@ -184,10 +559,13 @@ namespace ac {
         // rundown last time.
         //
         bool start_rundown() {
-            counter_t value = counter_.fetch_or(CANCEL_BIT, std::memory_order_release);
+            counter_t value = set_cancel_bit(std::memory_order_release);
             bool idle = is_idle(value);
             if (idle) {
                 std::atomic_thread_fence(std::memory_order_acquire);
+                if (!is_canceled(value)) {
+                    stats_.rundown_completed();
+                }
             }
             return idle;
         }
@@ -203,9 +581,9 @@ namespace ac {
         // Threads that do acquire with memory_rder_acquire will see
         // all changes done in (1)
         //
-        template<typename... T>
-        std::pair<bool, bool> restart(T &&...Args) {
-            bool result = this->try_start(true, std::forward<T>(Args)...);
+        template<typename... A>
+        std::pair<bool, bool> restart(A &&...Args) {
+            bool result = this->try_start(true, std::forward<A>(Args)...);
             if (result) {
                 counter_t value = counter_.exchange(INIT_VALUE, std::memory_order_release);
                 AC_CODDING_ERROR_IF_NOT(is_canceled(value) && is_idle(value));
@@ -252,12 +630,24 @@ namespace ac {
             return decoded_count(value);
         }
         //
+        // Stats policy. With the default policy all counters are
+        // zero, unless AC_RUNDOWN_INSTRUMENTED is defined.
+        //
+        [[nodiscard]] stats_t &stats() noexcept {
+            return stats_;
+        }
+
+        [[nodiscard]] stats_t const &stats() const noexcept {
+            return stats_;
+        }
+        //
         // Uses memory order acquire to make sure we will see any changes
         // done by the thread that reset rundown.
         //
         bool try_acquire(counter_t max_count = COUNTER_MAX_VALUE) {
             bool aborted = false;
             bool acquired = false;
+            uint32_t retries = 0;
             //
             // Since we are loading current counter value relaxed
             // we might have a stale value. If it is below max then
@@ -284,12 +674,16 @@ namespace ac {
                     break;
                 }
                 new_value = old_value + INCR;
+                ++retries;
             }
             if (!aborted) {
                 acquired = true;
+                stats_.acquired(new_value, retries);
                 if (new_value == INCR) {
                     this->has_work();
                 }
+            } else {
+                stats_.acquire_failed(retries);
             }
             return acquired;
         }
@@ -298,6 +692,7 @@ namespace ac {
         // done by the thread that reset rundown.
         //
         void acquire(counter_t max_count = COUNTER_MAX_VALUE) {
+            uint32_t retries = 0;
             //
             // Since we are loading current counter value relaxed
             // we might have a stale value. If it is below max then
@@ -316,18 +711,94 @@ namespace ac {
             while (!counter_.compare_exchange_weak(
                 old_value, new_value, std::memory_order_acquire, std::memory_order_relaxed)) {
                 if (is_canceled(old_value)) {
+                    stats_.acquire_failed(retries);
                     throw rundown_exception();
                 }
                 if (old_value >= max_count) {
+                    stats_.acquire_failed(retries);
                     throw counter_overflow_exception();
                 }
                 new_value = old_value + INCR;
+                ++retries;
             }
+            stats_.acquired(new_value, retries);
             if (new_value == INCR) {
                 this->has_work();
             }
         }
         //
+        // Same as try_acquire, but takes n references with a single
+        // successful CAS. Use it to cover a batch of work items before
+        // fanning them out, instead of acquiring once per item.
+        //
+        bool try_acquire_n(counter_t n, counter_t max_count = COUNTER_MAX_VALUE) {
+            AC_CODDING_ERROR_IF_NOT(0 < n && n <= max_count);
+            uint32_t retries = 0;
+            counter_t old_value = counter_.load(std::memory_order_relaxed);
+            for (;;) {
+                if (is_canceled(old_value) || decoded_count(old_value) > max_count - n) {
+                    stats_.acquire_failed(retries);
+                    return false;
+                }
+                if (counter_.compare_exchange_weak(
+                        old_value, old_value + n * INCR, std::memory_order_acquire, std::memory_order_relaxed)) {
+                    break;
+                }
+                ++retries;
+            }
+            stats_.acquired(decoded_count(old_value) + n, retries);
+            if (is_idle(old_value)) {
+                this->has_work();
+            }
+            return true;
+        }
+        //
+        // Same as acquire, but takes n references with a single
+        // successful CAS.
+        //
+        void acquire_n(counter_t n, counter_t max_count = COUNTER_MAX_VALUE) {
+            AC_CODDING_ERROR_IF_NOT(0 < n && n <= max_count);
+            uint32_t retries = 0;
+            counter_t old_value = counter_.load(std::memory_order_relaxed);
+            for (;;) {
+                if (is_canceled(old_value)) {
+                    stats_.acquire_failed(retries);
+                    throw rundown_exception();
+                }
+                if (decoded_count(old_value) > max_count - n) {
+                    stats_.acquire_failed(retries);
+                    throw counter_overflow_exception();
+                }
+                if (counter_.compare_exchange_weak(
+                        old_value, old_value + n * INCR, std::memory_order_acquire, std::memory_order_relaxed)) {
+                    break;
+                }
+                ++retries;
+            }
+            stats_.acquired(decoded_count(old_value) + n, retries);
+            if (is_idle(old_value)) {
+                this->has_work();
+            }
+        }
+        //
+        // Same as release, but drops n references with a single
+        // fetch_sub.
+        //
+        void release_n(counter_t n) {
+            AC_CODDING_ERROR_IF_NOT(0 < n);
+            counter_t old_value = counter_.fetch_sub(n * INCR, std::memory_order_relaxed);
+            counter_t decoded_value = decoded_count(old_value);
+            AC_CODDING_ERROR_IF(decoded_value < n);
+            bool canceled = is_canceled(old_value);
+            if (n == decoded_value) {
+                this->no_work();
+                if (canceled) {
+                    std::atomic_thread_fence(std::memory_order_acquire);
+                    complete_rundown();
+                }
+            }
+        }
+        //
         // Use relaxed to decrement counter, and only if we
         // are running down do acquire fence so method that
         // is handling rundown complete is synchronised with
@@ -341,13 +812,31 @@ namespace ac {
                 this->no_work();
                 if (canceled) {
                     std::atomic_thread_fence(std::memory_order_acquire);
-                    this->rundown_complete();
+                    complete_rundown();
                 }
             }
         }
 
     protected:
+        //
+        // Derived classes that complete rundown from start_rundown
+        // use these two, so stats see every rundown
+        //
+        counter_t set_cancel_bit(std::memory_order const order = std::memory_order_acq_rel) {
+            counter_t const previous_value{counter_.fetch_or(CANCEL_BIT, order)};
+            if (!is_canceled(previous_value)) {
+                stats_.rundown_started();
+            }
+            return previous_value;
+        }
+
+        void complete_rundown() {
+            stats_.rundown_completed();
+            this->rundown_complete();
+        }
+
         atomic_counter_t counter_{INIT_VALUE};
+        AC_NO_UNIQUE_ADDRESS stats_t stats_;
     };
 
     class rundown: public rundown_counter<ac::details::crtp_rundown_base<rundown>> {
@@ -361,12 +850,17 @@ namespace ac {
             join();
         }
 
+        //
+        // If there are no references then there will be no last
+        // release, so thread that sets cancelation bit completes
+        // rundown
+        //
         bool start_rundown() {
-            bool just_stopped = base_t::start_rundown();
-            if (just_stopped) {
-                e_.set();
+            counter_t const previous_value{set_cancel_bit()};
+            if (!is_canceled(previous_value) && is_idle(previous_value)) {
+                complete_rundown();
             }
-            return just_stopped;
+            return is_idle(previous_value);
         }
 
         void restart() {
@@ -383,9 +877,34 @@ namespace ac {
             start_rundown();
             AC_CODDING_ERROR_IF_NOT(ERROR_SUCCESS == e_.wait());
         }
+        //
+        // Starts rundown and returns without waiting for it to
+        // complete. Continuation is called by the thread that
+        // releases the last reference, or right away by this thread
+        // if rundown is already complete. Only one continuation can
+        // be pending at a time.
+        //
+        void join_async(rundown_continuation continuation) {
+            if (!try_join_async(continuation)) {
+                continuation();
+            }
+        }
+        //
+        // Same as join_async, but if rundown is already complete
+        // returns false and leaves continuation to the caller
+        //
+        [[nodiscard]] bool try_join_async(rundown_continuation &continuation) noexcept {
+            start_rundown();
+            return completion_.try_install(continuation);
+        }
+
+        [[nodiscard]] details::rundown_join_awaiter<rundown> join_async() noexcept {
+            return details::rundown_join_awaiter<rundown>{this};
+        }
 
         bool try_start_impl(bool restart) {
             if (restart) {
+                completion_.reset();
                 e_.reset();
             }
             return true;
@@ -397,12 +916,21 @@ namespace ac {
         void no_work_impl() {
         }
 
+        //
+        // Joiners wait for the event, so set it after we are done
+        // with the completion latch
+        //
         void rundown_complete_impl() {
+            rundown_continuation continuation{completion_.complete()};
             e_.set();
+            if (continuation) {
+                continuation();
+            }
         }
 
     private:
-        ac::event e_{event::manuel, event::unsignaled};
+        ac::slim_event e_{slim_event::manuel, slim_event::unsignaled};
+        details::rundown_completion completion_;
     };
 
     class slim_rundown
@@ -417,9 +945,17 @@ namespace ac {
             join();
         }
 
+        //
+        // If there are no references then there will be no last
+        // release, so thread that sets cancelation bit completes
+        // rundown
+        //
         bool start_rundown() {
-            bool just_stopped = base_t::start_rundown();
-            return just_stopped;
+            counter_t const previous_value{set_cancel_bit()};
+            if (!is_canceled(previous_value) && is_idle(previous_value)) {
+                complete_rundown();
+            }
+            return is_idle(previous_value);
         }
 
         void restart() {
@@ -429,23 +965,44 @@ namespace ac {
             AC_CODDING_ERROR_IF_NOT(result);
         }
 
+        //
+        // Joiners wait for the completion latch rather than for the
+        // counter to drop to zero, so they do not return while the
+        // last releaser is still completing rundown.
+        //
         void join() {
-            if (!start_rundown()) {
-                counter_t const volatile *const volatile counter =
-                    reinterpret_cast<counter_t *>(&counter_);
-                for (;;) {
-                    counter_t current_value = counter_value(std::memory_order_acquire);
-                    AC_CODDING_ERROR_IF_NOT(is_canceled(current_value));
-                    if (is_idle(current_value)) {
-                        break;
-                    }
-                    wait_on_address::wait(counter, current_value);
-                }
+            start_rundown();
+            completion_.wait();
+        }
+        //
+        // Starts rundown and returns without waiting for it to
+        // complete. Continuation is called by the thread that
+        // releases the last reference, or right away by this thread
+        // if rundown is already complete. Only one continuation can
+        // be pending at a time.
+        //
+        void join_async(rundown_continuation continuation) {
+            if (!try_join_async(continuation)) {
+                continuation();
             }
         }
+        //
+        // Same as join_async, but if rundown is already complete
+        // returns false and leaves continuation to the caller
+        //
+        [[nodiscard]] bool try_join_async(rundown_continuation &continuation) noexcept {
+            start_rundown();
+            return completion_.try_install(continuation);
+        }
+
+        [[nodiscard]] details::rundown_join_awaiter<slim_rundown> join_async() noexcept {
+            return details::rundown_join_awaiter<slim_rundown>{this};
+        }
 
         bool try_start_impl(bool restart) {
-            restart;
+            if (restart) {
+                completion_.reset();
+            }
             return true;
         }
 
@@ -455,48 +1012,488 @@ namespace ac {
         void no_work_impl() {
         }
 
+        //
+        // Rundown can be destroyed as soon as completion is published,
+        // so continuation runs from a local
+        //
         void rundown_complete_impl() {
-            counter_t const volatile *const volatile counter =
-                reinterpret_cast<counter_t *>(&counter_);
-            wait_on_address::wake_all(counter);
+            rundown_continuation continuation{completion_.complete()};
+            if (continuation) {
+                continuation();
+            }
         }
-    };
-
-    template< typename T>
-    class join_guard {
-    public:
 
-        explicit join_guard(T *rundown) noexcept 
-        : rundown_(rundown) {
-        }
+    private:
+        details::rundown_completion completion_;
+    };
 
-        join_guard(join_guard const &) = delete;
-        join_guard &operator=(join_guard const &) = delete;
+    //
+    // Node of a tree of rundowns. Child node holds a reference on
+    // its parent for as long as child is running or running down,
+    // so parent rundown completes only after all children completed.
+    //
+    // Starting rundown on a node starts rundown on all of its
+    // children without waiting for them, so branches drain in
+    // parallel, and join on the root waits for the slowest branch.
+    // Children do not restart when parent restarts, each node has
+    // to be restarted separately, parent first.
+    //
+    // Parent must outlive its children. Destroy children first.
+    //
+    class rundown_tree
+        : public rundown_counter<ac::details::crtp_rundown_base<rundown_tree>> {
+        using base_t = rundown_counter<ac::details::crtp_rundown_base<rundown_tree>>;
 
-        join_guard(join_guard &&other) noexcept 
-        : rundown_(other.rundown_) {
-            other.rundown_ = nullptr;
+    public:
+        rundown_tree() {
         }
 
-        join_guard &operator=(join_guard &&other) noexcept {
-            if (&other != this) {
-                join();
-                rundown_ = other.rundown_;
-                other.rundown_ = nullptr;
+        //
+        // Throws rundown_exception if parent is running down
+        //
+        explicit rundown_tree(rundown_tree *parent) {
+            if (parent) {
+                if (!parent->try_acquire()) {
+                    base_t::start_rundown();
+                    throw rundown_exception();
+                }
+                parent_ = parent;
+                if (!parent_->add_child(this)) {
+                    //
+                    // Parent started rundown before we were linked,
+                    // and its fan out might have missed us. Join
+                    // releases the parent reference.
+                    //
+                    join();
+                    parent_->remove_child(this);
+                    throw rundown_exception();
+                }
             }
-            return *this;
         }
 
-        ~join_guard() noexcept {
+        ~rundown_tree() {
             join();
+            if (parent_) {
+                parent_->remove_child(this);
+            }
+            AC_CODDING_ERROR_IF(first_child_);
         }
 
-        [[nodiscard]] bool is_armed() const noexcept {
-            return rundown_ != nullptr;
+        //
+        // Whoever sets cancelation bit fans out to children. If there
+        // are no references, that thread also completes rundown, since
+        // there will be no last release to do it.
+        //
+        bool start_rundown() {
+            counter_t const previous_value{set_cancel_bit()};
+            if (!is_canceled(previous_value)) {
+                start_children_rundown();
+                if (is_idle(previous_value)) {
+                    complete_rundown();
+                }
+            }
+            return is_idle(previous_value);
         }
 
-        operator bool() const noexcept {
-            return is_armed();
+        //
+        // Returns false if parent is running down
+        //
+        bool restart() {
+            bool result = false;
+            bool is_idle = false;
+            std::tie(result, is_idle) = base_t::restart();
+            return result;
+        }
+
+        void join() {
+            start_rundown();
+            completion_.wait();
+        }
+
+        void join_async(rundown_continuation continuation) {
+            if (!try_join_async(continuation)) {
+                continuation();
+            }
+        }
+
+        [[nodiscard]] bool try_join_async(rundown_continuation &continuation) noexcept {
+            start_rundown();
+            return completion_.try_install(continuation);
+        }
+
+        [[nodiscard]] details::rundown_join_awaiter<rundown_tree> join_async() noexcept {
+            return details::rundown_join_awaiter<rundown_tree>{this};
+        }
+
+        [[nodiscard]] rundown_tree *parent() const noexcept {
+            return parent_;
+        }
+
+        bool try_start_impl(bool restart) {
+            if (restart) {
+                if (parent_ && !parent_->try_acquire()) {
+                    return false;
+                }
+                completion_.reset();
+            }
+            return true;
+        }
+
+        void has_work_impl() {
+        }
+
+        void no_work_impl() {
+        }
+
+        //
+        // Parent reference is released last, so parent completes
+        // only after the subtree is done, including continuations.
+        // Node can be destroyed as soon as completion is published,
+        // so everything after that runs from locals.
+        //
+        void rundown_complete_impl() {
+            rundown_tree *const parent{parent_};
+            rundown_continuation continuation{completion_.complete()};
+            if (continuation) {
+                continuation();
+            }
+            if (parent) {
+                parent->release();
+            }
+        }
+
+    private:
+        //
+        // Returns false if we started rundown. Start rundown sets
+        // cancelation bit before it takes the lock to fan out, so
+        // either fan out finds the child in the list, or we see the
+        // bit here.
+        //
+        [[nodiscard]] bool add_child(rundown_tree *child) noexcept {
+            lock_.lock();
+            child->prev_sibling_ = last_child_;
+            child->next_sibling_ = nullptr;
+            if (last_child_) {
+                last_child_->next_sibling_ = child;
+            } else {
+                first_child_ = child;
+            }
+            last_child_ = child;
+            bool const running{is_running()};
+            lock_.unlock();
+            return running;
+        }
+
+        void remove_child(rundown_tree *child) noexcept {
+            lock_.lock();
+            if (fan_out_cursor_ == child) {
+                fan_out_cursor_ = child->next_sibling_;
+            }
+            if (child->prev_sibling_) {
+                child->prev_sibling_->next_sibling_ = child->next_sibling_;
+            } else {
+                first_child_ = child->next_sibling_;
+            }
+            if (child->next_sibling_) {
+                child->next_sibling_->prev_sibling_ = child->prev_sibling_;
+            } else {
+                last_child_ = child->prev_sibling_;
+            }
+            lock_.unlock();
+        }
+
+        //
+        // Child cannot complete while we hold a reference on it, so
+        // it cannot be destroyed while we start its rundown. The
+        // reference is released outside of the lock, since completion
+        // might run a continuation that destroys the child, and
+        // destructor removes child from our list.
+        //
+        void start_children_rundown() {
+            lock_.lock();
+            fan_out_cursor_ = first_child_;
+            lock_.unlock();
+            for (;;) {
+                lock_.lock();
+                rundown_tree *const child{fan_out_cursor_};
+                if (nullptr == child) {
+                    lock_.unlock();
+                    break;
+                }
+                fan_out_cursor_ = child->next_sibling_;
+                bool const acquired{child->try_acquire()};
+                lock_.unlock();
+                if (acquired) {
+                    child->start_rundown();
+                    child->release();
+                }
+            }
+        }
+
+        rundown_tree *parent_{nullptr};
+        rundown_tree *prev_sibling_{nullptr};
+        rundown_tree *next_sibling_{nullptr};
+        //
+        // Guards list of children and fan out cursor
+        //
+        details::parking_lot_word_lock lock_;
+        rundown_tree *first_child_{nullptr};
+        rundown_tree *last_child_{nullptr};
+        rundown_tree *fan_out_cursor_{nullptr};
+        details::rundown_completion completion_;
+    };
+
+    //
+    // Rundown that spreads reference count across per-processor
+    // cache lines. Acquire and release modify only the stripe of the
+    // processor that thread is running on, and acquire reads
+    // cancelation flag that stays shared in caches of all processors
+    // until rundown starts.
+    //
+    // Thread might acquire on one stripe and release on another stripe
+    // if it migrated between processors, so a stripe can go negative.
+    // Only the sum of all stripes is meaningful.
+    //
+    // Start rundown marks every stripe by adding a large constant to
+    // it, and moves the sum of stripes to a single drain counter. Each
+    // release learns from the value its decrement returned whether
+    // the stripe was already marked. Unmarked release is counted by
+    // the mark and returns without touching anything else. Marked
+    // release also decrements drain counter, and thread that brings
+    // it to zero completes the latch. That decrement and completing
+    // the latch are the last accesses to the object, so a joiner that
+    // observes completion is free to destroy it.
+    //
+    // Each instance takes a few kilobytes, so use it for hot objects
+    // that are acquired by many processors at the same time, and keep
+    // using slim_rundown everywhere else.
+    //
+    class striped_rundown {
+    public:
+        using counter_t = std::ptrdiff_t;
+
+        static constexpr size_t stripes_count{64};
+
+        striped_rundown() noexcept {
+        }
+
+        striped_rundown(striped_rundown const &) = delete;
+        striped_rundown &operator=(striped_rundown const &) = delete;
+        striped_rundown(striped_rundown &&) = delete;
+        striped_rundown &operator=(striped_rundown &&) = delete;
+
+        ~striped_rundown() {
+            join();
+        }
+
+        //
+        // Only the first caller marks stripes. Returns true if rundown
+        // is complete by the time this call returns.
+        //
+        bool start_rundown() noexcept {
+            if (!canceled_.exchange(true, std::memory_order_seq_cst)) {
+                counter_t count{0};
+                for (stripe &s : stripes_) {
+                    count += s.count.fetch_add(mark, std::memory_order_seq_cst);
+                }
+                //
+                // Drain counter starts at the mark, so releases that
+                // run ahead of us cannot bring it to zero
+                //
+                release_drain(mark - count);
+            }
+            return completion_.is_complete();
+        }
+
+        void restart() noexcept {
+            AC_CODDING_ERROR_IF_NOT(is_rundown_complete());
+            completion_.reset();
+            for (stripe &s : stripes_) {
+                s.count.fetch_sub(mark, std::memory_order_seq_cst);
+            }
+            drain_.store(mark, std::memory_order_relaxed);
+            canceled_.store(false, std::memory_order_release);
+        }
+
+        //
+        // Waits for the completion latch rather than for the sum of
+        // stripes to drop to zero, so it does not return while the
+        // last releaser is still completing rundown
+        //
+        void join() {
+            start_rundown();
+            completion_.wait();
+        }
+
+        explicit operator bool() const noexcept {
+            return is_running();
+        }
+
+        bool is_running(std::memory_order order = std::memory_order_relaxed) const noexcept {
+            return !canceled_.load(order);
+        }
+
+        bool is_running_down() const noexcept {
+            return canceled_.load(std::memory_order_relaxed) && !completion_.is_complete();
+        }
+        //
+        // Only for logging
+        //
+        bool is_rundown_complete() const noexcept {
+            return completion_.is_complete();
+        }
+        //
+        // Only for logging
+        //
+        counter_t count() const noexcept {
+            counter_t result{0};
+            for (stripe const &s : stripes_) {
+                counter_t const value{s.count.load(std::memory_order_seq_cst)};
+                result += is_marked(value) ? value - mark : value;
+            }
+            return result;
+        }
+        //
+        // Increment stripe first and only then check cancelation flag.
+        // Both are sequentially consistent, so either start_rundown
+        // counts our increment when it marks the stripe, or we see
+        // the flag and undo increment. Loading the flag also
+        // synchronizes with restart.
+        //
+        [[nodiscard]] bool try_acquire() noexcept {
+            return try_acquire_n(1);
+        }
+
+        void acquire() {
+            if (!try_acquire()) {
+                throw rundown_exception();
+            }
+        }
+
+        void release() noexcept {
+            release_stripe(current_stripe(), 1);
+        }
+        //
+        // Takes n references on the current stripe at once
+        //
+        [[nodiscard]] bool try_acquire_n(counter_t n) noexcept {
+            AC_CODDING_ERROR_IF_NOT(0 < n);
+            if (canceled_.load(std::memory_order_relaxed)) {
+                return false;
+            }
+            std::atomic<counter_t> &count = current_stripe();
+            if (is_marked(count.fetch_add(n, std::memory_order_seq_cst))) {
+                //
+                // Stripe was marked before our increment, so mark did
+                // not count it and drain counter must not see the undo
+                //
+                count.fetch_sub(n, std::memory_order_relaxed);
+                return false;
+            }
+            if (canceled_.load(std::memory_order_seq_cst)) {
+                //
+                // Undo on the same stripe so start_rundown never sees
+                // a half of this transient reference
+                //
+                release_stripe(count, n);
+                return false;
+            }
+            return true;
+        }
+
+        void acquire_n(counter_t n) {
+            if (!try_acquire_n(n)) {
+                throw rundown_exception();
+            }
+        }
+
+        void release_n(counter_t n) noexcept {
+            AC_CODDING_ERROR_IF_NOT(0 < n);
+            release_stripe(current_stripe(), n);
+        }
+
+    private:
+        //
+        // Stripes stay far below half of the mark, so a marked stripe
+        // is told apart from an unmarked one even if it is negative
+        //
+        static constexpr counter_t mark{(std::numeric_limits<counter_t>::max)() / 2 + 1};
+
+        struct alignas(cache_line_size) stripe {
+            std::atomic<counter_t> count{0};
+        };
+
+        [[nodiscard]] static bool is_marked(counter_t value) noexcept {
+            return value >= mark / 2;
+        }
+
+        std::atomic<counter_t> &current_stripe() noexcept {
+            return stripes_[current_processor_number() % stripes_count].count;
+        }
+
+        void release_stripe(std::atomic<counter_t> &count, counter_t n) noexcept {
+            if (is_marked(count.fetch_sub(n, std::memory_order_seq_cst))) {
+                release_drain(n);
+            }
+        }
+
+        void release_drain(counter_t n) noexcept {
+            counter_t const previous{drain_.fetch_sub(n, std::memory_order_acq_rel)};
+            AC_CODDING_ERROR_IF(previous < n);
+            if (previous == n) {
+                rundown_continuation continuation{completion_.complete()};
+                AC_CODDING_ERROR_IF(continuation);
+            }
+        }
+        //
+        // Read by every acquire, and written only when rundown
+        // starts or restarts, so it stays shared in all caches
+        //
+        alignas(cache_line_size) std::atomic<bool> canceled_{false};
+        //
+        // Touched only after rundown has started
+        //
+        alignas(cache_line_size) std::atomic<counter_t> drain_{mark};
+        details::rundown_completion completion_;
+
+        stripe stripes_[stripes_count];
+    };
+
+    template< typename T>
+    class join_guard {
+    public:
+
+        explicit join_guard(T *rundown) noexcept 
+        : rundown_(rundown) {
+        }
+
+        join_guard(join_guard const &) = delete;
+        join_guard &operator=(join_guard const &) = delete;
+
+        join_guard(join_guard &&other) noexcept 
+        : rundown_(other.rundown_) {
+            other.rundown_ = nullptr;
+        }
+
+        join_guard &operator=(join_guard &&other) noexcept {
+            if (&other != this) {
+                join();
+                rundown_ = other.rundown_;
+                other.rundown_ = nullptr;
+            }
+            return *this;
+        }
+
+        ~join_guard() noexcept {
+            join();
+        }
+
+        [[nodiscard]] bool is_armed() const noexcept {
+            return rundown_ != nullptr;
+        }
+
+        operator bool() const noexcept {
+            return is_armed();
         }
 
         void join() noexcept {
@@ -527,11 +1524,597 @@ namespace ac {
         T *rundown_;
     };
 
+    //
+    // Owns a number of references on a rundown that were taken
+    // with a single acquire_n. Shares can be split off and handed
+    // to tasks, each task releasing its share when it is done,
+    // or merged back so a worker that processed many items
+    // releases all of them with a single release_n.
+    //
+    // Works with any rundown that has acquire_n, try_acquire_n
+    // and release_n.
+    //
+    template<typename T>
+    class rundown_batch_lock {
+    public:
+        using rundown_t = T;
+        using counter_t = typename T::counter_t;
+
+        rundown_batch_lock() noexcept {
+        }
+
+        rundown_batch_lock(rundown_t *rundown, counter_t count) {
+            acquire(rundown, count);
+        }
+
+        rundown_batch_lock(rundown_batch_lock const &) = delete;
+        rundown_batch_lock &operator=(rundown_batch_lock const &) = delete;
+
+        rundown_batch_lock(rundown_batch_lock &&other) noexcept
+            : rundown_(other.rundown_)
+            , count_(other.count_) {
+            other.rundown_ = nullptr;
+            other.count_ = 0;
+        }
+
+        rundown_batch_lock &operator=(rundown_batch_lock &&other) noexcept {
+            if (&other != this) {
+                release();
+                rundown_ = other.rundown_;
+                count_ = other.count_;
+                other.rundown_ = nullptr;
+                other.count_ = 0;
+            }
+            return *this;
+        }
+
+        ~rundown_batch_lock() noexcept {
+            release();
+        }
+
+        void acquire(rundown_t *rundown, counter_t count) {
+            release();
+            if (rundown && count) {
+                rundown->acquire_n(count);
+                rundown_ = rundown;
+                count_ = count;
+            }
+        }
+
+        [[nodiscard]] bool try_acquire(rundown_t *rundown, counter_t count) {
+            release();
+            if (rundown && count && rundown->try_acquire_n(count)) {
+                rundown_ = rundown;
+                count_ = count;
+            }
+            return is_acquired();
+        }
+        //
+        // Moves count references to a new lock. Does not touch
+        // the rundown counter.
+        //
+        [[nodiscard]] rundown_batch_lock split(counter_t count) noexcept {
+            AC_CODDING_ERROR_IF_NOT(0 < count && count <= count_);
+            count_ -= count;
+            rundown_batch_lock result{rundown_, count, adopt};
+            if (0 == count_) {
+                rundown_ = nullptr;
+            }
+            return result;
+        }
+        //
+        // Takes over references owned by other lock. Both locks
+        // must be on the same rundown. Does not touch the rundown
+        // counter.
+        //
+        void merge(rundown_batch_lock &&other) noexcept {
+            if (&other == this || !other.is_acquired()) {
+                return;
+            }
+            if (!is_acquired()) {
+                *this = std::move(other);
+                return;
+            }
+            AC_CODDING_ERROR_IF_NOT(rundown_ == other.rundown_);
+            count_ += other.count_;
+            other.rundown_ = nullptr;
+            other.count_ = 0;
+        }
+        //
+        // Drops count references. Lock stays armed while
+        // it still owns any.
+        //
+        void release(counter_t count) noexcept {
+            AC_CODDING_ERROR_IF_NOT(0 < count && count <= count_);
+            rundown_->release_n(count);
+            count_ -= count;
+            if (0 == count_) {
+                rundown_ = nullptr;
+            }
+        }
+
+        void release() noexcept {
+            if (rundown_) {
+                rundown_->release_n(count_);
+                rundown_ = nullptr;
+                count_ = 0;
+            }
+        }
+
+        [[nodiscard]] bool is_acquired() const noexcept {
+            return rundown_ != nullptr;
+        }
+
+        explicit operator bool() const noexcept {
+            return is_acquired();
+        }
+
+        [[nodiscard]] counter_t count() const noexcept {
+            return count_;
+        }
+
+        [[nodiscard]] rundown_t *get() const noexcept {
+            return rundown_;
+        }
+        //
+        // Caller becomes responsible for calling release_n
+        // on the returned rundown with the returned count
+        //
+        [[nodiscard]] std::pair<rundown_t *, counter_t> detach() noexcept {
+            std::pair<rundown_t *, counter_t> result{rundown_, count_};
+            rundown_ = nullptr;
+            count_ = 0;
+            return result;
+        }
+
+    private:
+        struct adopt_t {};
+        static constexpr adopt_t adopt{};
+
+        rundown_batch_lock(rundown_t *rundown, counter_t count, adopt_t) noexcept
+            : rundown_(rundown)
+            , count_(count) {
+        }
+
+        rundown_t *rundown_{nullptr};
+        counter_t count_{0};
+    };
+
+    //
+    // Rundown reference that remembers the call site that took it.
+    // With rundown_stats policy, stats().for_each_site reports how
+    // many references each call site holds, so a hung rundown can be
+    // traced to its holders. With the default policy it costs the
+    // same as resource_owner.
+    //
+    template<typename T>
+    class rundown_site_lock {
+    public:
+        using rundown_t = T;
+
+        rundown_site_lock() noexcept {
+        }
+
+        explicit rundown_site_lock(
+            rundown_t *rundown,
+            std::source_location const &location = std::source_location::current()) {
+            rundown->acquire();
+            rundown_ = rundown;
+            site_ = rundown_->stats().site_acquired(location);
+        }
+
+        rundown_site_lock(rundown_site_lock const &) = delete;
+        rundown_site_lock &operator=(rundown_site_lock const &) = delete;
+
+        rundown_site_lock(rundown_site_lock &&other) noexcept
+            : rundown_(other.rundown_)
+            , site_(other.site_) {
+            other.rundown_ = nullptr;
+        }
+
+        rundown_site_lock &operator=(rundown_site_lock &&other) noexcept {
+            if (&other != this) {
+                release();
+                rundown_ = other.rundown_;
+                site_ = other.site_;
+                other.rundown_ = nullptr;
+            }
+            return *this;
+        }
+
+        ~rundown_site_lock() {
+            release();
+        }
+
+        [[nodiscard]] bool try_acquire(
+            rundown_t *rundown,
+            std::source_location const &location = std::source_location::current()) {
+            release();
+            if (!rundown->try_acquire()) {
+                return false;
+            }
+            rundown_ = rundown;
+            site_ = rundown_->stats().site_acquired(location);
+            return true;
+        }
+
+        void release() noexcept {
+            if (rundown_) {
+                rundown_->stats().site_released(site_);
+                rundown_t *rundown{rundown_};
+                rundown_ = nullptr;
+                rundown->release();
+            }
+        }
+
+        [[nodiscard]] bool is_acquired() const noexcept {
+            return nullptr != rundown_;
+        }
+
+        explicit operator bool() const noexcept {
+            return is_acquired();
+        }
+
+        [[nodiscard]] rundown_t *get() const noexcept {
+            return rundown_;
+        }
+
+    private:
+        rundown_t *rundown_{nullptr};
+        size_t site_{0};
+    };
+
+    namespace details {
+
+        //
+        // Per-thread announcement of the epoch thread entered its
+        // critical region in. Zero means thread is not in a critical
+        // region. Only owning thread writes it, so reader never
+        // writes a cache line shared with other threads.
+        //
+        struct alignas(cache_line_size) epoch_record {
+            std::atomic<uint64_t> epoch{0};
+            std::atomic<bool> in_use{false};
+            epoch_record *next{nullptr};
+            uint32_t nesting{0};
+        };
+
+        //
+        // Records are never freed, because threads can exit after
+        // static objects are destroyed. Record of a thread that
+        // exited is reused by the next thread.
+        //
+        class epoch_registry {
+        public:
+            [[nodiscard]] static epoch_registry &instance() noexcept {
+                static epoch_registry registry;
+                return registry;
+            }
+
+            [[nodiscard]] epoch_record *acquire_record() {
+                for (epoch_record *record = head_.load(std::memory_order_acquire); record;
+                     record = record->next) {
+                    bool expected{false};
+                    if (!record->in_use.load(std::memory_order_relaxed) &&
+                        record->in_use.compare_exchange_strong(
+                            expected, true, std::memory_order_acquire, std::memory_order_relaxed)) {
+                        return record;
+                    }
+                }
+                epoch_record *record{new epoch_record};
+                record->in_use.store(true, std::memory_order_relaxed);
+                record->next = head_.load(std::memory_order_relaxed);
+                while (!head_.compare_exchange_weak(
+                    record->next, record, std::memory_order_release, std::memory_order_relaxed)) {
+                }
+                return record;
+            }
+
+            [[nodiscard]] uint64_t epoch() const noexcept {
+                return epoch_.load(std::memory_order_acquire);
+            }
+
+            //
+            // Epoch can move forward only when every thread in
+            // a critical region has observed current epoch. Heavy
+            // barrier pairs with the compiler barrier readers do
+            // after they announce epoch, so we either see the
+            // announcement, or reader will see everything writer
+            // did before calling us.
+            //
+            bool try_advance() noexcept {
+                heavy_memory_barrier();
+                uint64_t current{epoch_.load(std::memory_order_acquire)};
+                for (epoch_record *record = head_.load(std::memory_order_acquire); record;
+                     record = record->next) {
+                    uint64_t const observed{record->epoch.load(std::memory_order_acquire)};
+                    if (0 != observed && current != observed) {
+                        return false;
+                    }
+                }
+                return epoch_.compare_exchange_strong(
+                    current, current + 1, std::memory_order_acq_rel, std::memory_order_relaxed);
+            }
+
+        private:
+            epoch_registry() noexcept {
+            }
+
+            std::atomic<epoch_record *> head_{nullptr};
+            alignas(cache_line_size) std::atomic<uint64_t> epoch_{1};
+        };
+
+        struct epoch_thread_record {
+            epoch_record *record{nullptr};
+
+            ~epoch_thread_record() {
+                if (record) {
+                    AC_CODDING_ERROR_IF(0 != record->nesting);
+                    record->in_use.store(false, std::memory_order_release);
+                }
+            }
+        };
+
+        [[nodiscard]] inline epoch_record &current_epoch_record() {
+            thread_local epoch_thread_record local;
+            if (!local.record) {
+                local.record = epoch_registry::instance().acquire_record();
+            }
+            return *local.record;
+        }
+
+        struct epoch_retired {
+            epoch_retired *next{nullptr};
+            uint64_t epoch{0};
+            void *object{nullptr};
+            void (*deleter)(void *) noexcept {nullptr};
+        };
+    } // namespace details
+
+    //
+    // Marks a read side critical region of epoch based reclamation.
+    // Objects retired to any epoch_domain are not freed while a
+    // thread that might have seen them is inside of the region.
+    //
+    // Entering and leaving are stores to a thread local record, so
+    // readers never write to a shared cache line. Regions can nest.
+    // Guard must be destroyed on the thread that created it, and
+    // thread should not block for long inside of the region since
+    // that holds back reclamation in all domains.
+    //
+    class epoch_guard {
+    public:
+        epoch_guard()
+            : record_{&details::current_epoch_record()} {
+            if (0 == record_->nesting++) {
+                record_->epoch.store(details::epoch_registry::instance().epoch(),
+                                     std::memory_order_relaxed);
+                light_memory_barrier();
+            }
+        }
+
+        ~epoch_guard() {
+            if (0 == --record_->nesting) {
+                record_->epoch.store(0, std::memory_order_release);
+            }
+        }
+
+        epoch_guard(epoch_guard const &) = delete;
+        epoch_guard &operator=(epoch_guard const &) = delete;
+        epoch_guard(epoch_guard &&) = delete;
+        epoch_guard &operator=(epoch_guard &&) = delete;
+
+    private:
+        details::epoch_record *record_;
+    };
+
+    //
+    // Epoch based reclamation for read mostly data. Unlike waiting
+    // on a rundown for readers to go away, writer does not block.
+    // It unpublishes an object, retires it to the domain, and the
+    // object is freed once global epoch moved two steps past the
+    // epoch it was retired in. By then every thread that was in a
+    // critical region when object was unpublished has left it.
+    //
+    // Reclamation happens opportunistically on retire once enough
+    // objects are pending, or when caller asks for it. Global
+    // epoch and per-thread records are shared by all domains,
+    // domain only owns the list of retired objects.
+    //
+    class epoch_domain {
+    public:
+        epoch_domain() noexcept {
+        }
+
+        ~epoch_domain() {
+            reclaim();
+            AC_CODDING_ERROR_IF(retired_.load(std::memory_order_acquire));
+        }
+
+        epoch_domain(epoch_domain const &) = delete;
+        epoch_domain &operator=(epoch_domain const &) = delete;
+        epoch_domain(epoch_domain &&) = delete;
+        epoch_domain &operator=(epoch_domain &&) = delete;
+
+        template<typename T>
+        void retire(T *object) noexcept {
+            retire(static_cast<void *>(object),
+                   [](void *object) noexcept { delete static_cast<T *>(object); });
+        }
+
+        //
+        // Object must be unreachable for new readers before it is
+        // retired. If we cannot allocate bookkeeping for it, we fall
+        // back to waiting for readers and freeing it inline.
+        //
+        void retire(void *object, void (*deleter)(void *) noexcept) noexcept {
+            details::epoch_retired *node{new (std::nothrow) details::epoch_retired};
+            if (!node) {
+                synchronize();
+                deleter(object);
+                return;
+            }
+            node->object = object;
+            node->deleter = deleter;
+            node->epoch = details::epoch_registry::instance().epoch();
+            push(node, node);
+            if (reclaim_threshold <= pending_.fetch_add(1, std::memory_order_relaxed) + 1) {
+                try_reclaim();
+            }
+        }
+
+        //
+        // Tries to move epoch forward once, and frees objects that
+        // no reader can see anymore. Does not block. Returns number
+        // of freed objects.
+        //
+        size_t try_reclaim() noexcept {
+            details::epoch_registry &registry{details::epoch_registry::instance()};
+            registry.try_advance();
+            uint64_t const epoch{registry.epoch()};
+
+            details::epoch_retired *node{retired_.exchange(nullptr, std::memory_order_acquire)};
+            details::epoch_retired *keep_head{nullptr};
+            details::epoch_retired *keep_tail{nullptr};
+            size_t freed{0};
+            while (node) {
+                details::epoch_retired *const next{node->next};
+                if (node->epoch + 2 <= epoch) {
+                    node->deleter(node->object);
+                    delete node;
+                    ++freed;
+                } else {
+                    node->next = keep_head;
+                    keep_head = node;
+                    if (!keep_tail) {
+                        keep_tail = node;
+                    }
+                }
+                node = next;
+            }
+            if (keep_head) {
+                push(keep_head, keep_tail);
+            }
+            pending_.fetch_sub(freed, std::memory_order_relaxed);
+            return freed;
+        }
+
+        //
+        // Blocks until every thread that was in a critical region
+        // when this call started has left it. Must not be called
+        // from a critical region.
+        //
+        void synchronize() noexcept {
+            AC_CODDING_ERROR_IF(0 != details::current_epoch_record().nesting);
+            details::epoch_registry &registry{details::epoch_registry::instance()};
+            uint64_t const target{registry.epoch() + 2};
+            for (int attempt = 0; registry.epoch() < target; ++attempt) {
+                if (!registry.try_advance()) {
+                    if (attempt < 16) {
+                        std::this_thread::yield();
+                    } else {
+                        std::this_thread::sleep_for(std::chrono::milliseconds{1});
+                    }
+                }
+            }
+        }
+
+        //
+        // Waits for readers and frees everything that was retired
+        // before this call
+        //
+        size_t reclaim() noexcept {
+            synchronize();
+            return try_reclaim();
+        }
+
+        [[nodiscard]] size_t pending() const noexcept {
+            return pending_.load(std::memory_order_relaxed);
+        }
+
+    private:
+        static constexpr size_t reclaim_threshold{64};
+
+        void push(details::epoch_retired *head, details::epoch_retired *tail) noexcept {
+            tail->next = retired_.load(std::memory_order_relaxed);
+            while (!retired_.compare_exchange_weak(
+                tail->next, head, std::memory_order_release, std::memory_order_relaxed)) {
+            }
+        }
+
+        std::atomic<details::epoch_retired *> retired_{nullptr};
+        std::atomic<size_t> pending_{0};
+    };
+
+    //
+    // Pointer to read mostly data protected by an epoch_domain.
+    // Readers load it inside of an epoch_guard, and can use the
+    // object until guard is destroyed. Writers publish a new
+    // object, and the old one is retired to the domain.
+    //
+    template<typename T>
+    class epoch_ptr {
+    public:
+        explicit epoch_ptr(epoch_domain &domain, T *value = nullptr) noexcept
+            : domain_{&domain}
+            , value_{value} {
+        }
+
+        explicit epoch_ptr(epoch_domain &domain, std::unique_ptr<T> value) noexcept
+            : epoch_ptr{domain, value.release()} {
+        }
+
+        ~epoch_ptr() {
+            reset();
+        }
+
+        epoch_ptr(epoch_ptr const &) = delete;
+        epoch_ptr &operator=(epoch_ptr const &) = delete;
+        epoch_ptr(epoch_ptr &&) = delete;
+        epoch_ptr &operator=(epoch_ptr &&) = delete;
+
+        [[nodiscard]] T *load() const noexcept {
+            return value_.load(std::memory_order_acquire);
+        }
+
+        void reset(T *value = nullptr) noexcept {
+            T *const previous{value_.exchange(value, std::memory_order_acq_rel)};
+            if (previous) {
+                domain_->retire(previous);
+            }
+        }
+
+        void reset(std::unique_ptr<T> value) noexcept {
+            reset(value.release());
+        }
+
+        [[nodiscard]] epoch_domain &domain() const noexcept {
+            return *domain_;
+        }
+
+    private:
+        epoch_domain *domain_;
+        std::atomic<T *> value_;
+    };
+
     using rundown_lock = resource_owner<rundown>;
     using rundown_join = join_guard<rundown>;
 
     using slim_rundown_lock = resource_owner<slim_rundown>;
     using slim_rundown_join = join_guard<slim_rundown>;
+    using slim_rundown_site_lock = rundown_site_lock<slim_rundown>;
+
+    using rundown_tree_lock = resource_owner<rundown_tree>;
+    using rundown_tree_join = join_guard<rundown_tree>;
+    using rundown_tree_site_lock = rundown_site_lock<rundown_tree>;
+
+    using striped_rundown_lock = resource_owner<striped_rundown>;
+    using striped_rundown_join = join_guard<striped_rundown>;
+
+    using rundown_batch = rundown_batch_lock<rundown>;
+    using slim_rundown_batch = rundown_batch_lock<slim_rundown>;
+    using rundown_tree_batch = rundown_batch_lock<rundown_tree>;
+    using striped_rundown_batch = rundown_batch_lock<striped_rundown>;
 
 
 } // namespace ac
@@ -0,0 +1,147 @@
+#ifndef _AC_HELPERS_WIN32_LIBRARY_SEQLOCK_HEADER_
+#define _AC_HELPERS_WIN32_LIBRARY_SEQLOCK_HEADER_
+
+#pragma once
+
+#include "accommon.h"
+
+#include <cstring>
+#include <type_traits>
+
+namespace ac {
+
+    //
+    // Sequence lock protecting a small trivially copyable value.
+    //
+    // Writer claims the sequence by moving it from even to odd with a
+    // CAS, and a writer that finds another write in progress spins
+    // until it is done. Uncontended write pays one CAS and one store
+    // to the sequence counter. Readers never block writers, and never
+    // observe a torn value. A reader that races with a write retries
+    // the copy.
+    //
+    // Value is kept in an array of atomic words so concurrent copy is
+    // not a data race. Relaxed word accesses compile to plain moves.
+    //
+    template<typename T>
+    class seqlock {
+    public:
+        static_assert(std::is_trivially_copyable_v<T>, "seqlock value must be trivially copyable");
+        static_assert(std::is_default_constructible_v<T>, "seqlock value must be default constructible");
+
+        using value_type = T;
+
+        seqlock() noexcept
+            : seqlock{T{}} {
+        }
+
+        explicit seqlock(T const &value) noexcept {
+            word_t words[word_count]{};
+            std::memcpy(words, &value, sizeof(T));
+            for (size_t i = 0; i < word_count; ++i) {
+                words_[i].store(words[i], std::memory_order_relaxed);
+            }
+        }
+
+        seqlock(seqlock const &) = delete;
+        seqlock(seqlock &&) = delete;
+
+        seqlock &operator=(seqlock const &) = delete;
+        seqlock &operator=(seqlock &&) = delete;
+
+        [[nodiscard]] T load() const noexcept {
+            word_t words[word_count];
+            for (;;) {
+                uint32_t const sequence{sequence_.load(std::memory_order_acquire)};
+                if (sequence & 1) {
+                    cpu_relax();
+                    continue;
+                }
+                for (size_t i = 0; i < word_count; ++i) {
+                    words[i] = words_[i].load(std::memory_order_relaxed);
+                }
+                //
+                // Keeps word loads above the second sequence load
+                //
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if (sequence == sequence_.load(std::memory_order_relaxed)) {
+                    break;
+                }
+            }
+            T value;
+            std::memcpy(&value, words, sizeof(T));
+            return value;
+        }
+
+        void store(T const &value) noexcept {
+            word_t words[word_count]{};
+            std::memcpy(words, &value, sizeof(T));
+
+            uint32_t const sequence{begin_write()};
+            for (size_t i = 0; i < word_count; ++i) {
+                words_[i].store(words[i], std::memory_order_relaxed);
+            }
+            sequence_.store(sequence + 2, std::memory_order_release);
+        }
+
+        //
+        // Read-modify-write. Other writers wait while f runs, so it
+        // must be short. Value cannot change under the writer, so it
+        // is read without retries.
+        //
+        template<typename F>
+        void update(F &&f) noexcept {
+            uint32_t const sequence{begin_write()};
+            word_t words[word_count];
+            for (size_t i = 0; i < word_count; ++i) {
+                words[i] = words_[i].load(std::memory_order_relaxed);
+            }
+            T value;
+            std::memcpy(&value, words, sizeof(T));
+            f(value);
+            std::memcpy(words, &value, sizeof(T));
+            for (size_t i = 0; i < word_count; ++i) {
+                words_[i].store(words[i], std::memory_order_relaxed);
+            }
+            sequence_.store(sequence + 2, std::memory_order_release);
+        }
+
+        [[nodiscard]] uint32_t sequence() const noexcept {
+            return sequence_.load(std::memory_order_relaxed);
+        }
+
+    private:
+        using word_t = uintptr_t;
+
+        //
+        // Returns even sequence that this writer moved to odd. Acquire
+        // pairs with the release that ended previous write, so update
+        // reads the words that write stored.
+        //
+        [[nodiscard]] uint32_t begin_write() noexcept {
+            uint32_t sequence{sequence_.load(std::memory_order_relaxed)};
+            for (;;) {
+                if (sequence & 1) {
+                    cpu_relax();
+                    sequence = sequence_.load(std::memory_order_relaxed);
+                } else if (sequence_.compare_exchange_weak(
+                               sequence, sequence + 1, std::memory_order_acquire, std::memory_order_relaxed)) {
+                    break;
+                }
+            }
+            //
+            // Keeps word stores below the odd sequence store
+            //
+            std::atomic_thread_fence(std::memory_order_release);
+            return sequence;
+        }
+
+        static constexpr size_t word_count{(sizeof(T) + sizeof(word_t) - 1) / sizeof(word_t)};
+
+        std::atomic<uint32_t> sequence_{0};
+        std::atomic<word_t> words_[word_count];
+    };
+
+} // namespace ac
+
+#endif //_AC_HELPERS_WIN32_LIBRARY_SEQLOCK_HEADER_
@@ -0,0 +1,260 @@
+#ifndef _AC_HELPERS_WIN32_LIBRARY_SEQUENTIAL_READER_HEADER_
+#define _AC_HELPERS_WIN32_LIBRARY_SEQUENTIAL_READER_HEADER_
+
+#pragma once
+
+#include "accommon.h"
+#include "actp.h"
+#include "acfileobject.h"
+#include "acbufferpool.h"
+#include "acslimevent.h"
+
+#include <chrono>
+#include <cmath>
+
+namespace ac {
+
+    //
+    // Reads file front to back keeping several reads in flight ahead
+    // of the consumer, and hands completed chunks out in file order.
+    //
+    // File must be opened with FILE_FLAG_OVERLAPPED, and usually with
+    // FILE_FLAG_NO_BUFFERING. Handle must not use
+    // FILE_SKIP_COMPLETION_PORT_ON_SUCCESS. Reader takes the file
+    // size when it is constructed and does not read past it.
+    //
+    // Number of reads in flight follows Little's law: average read
+    // latency divided by the time consumer spends on a chunk, plus
+    // one. Consumer that keeps up with the device gets the maximum.
+    //
+    // Single consumer. Chunks return their buffers when destroyed,
+    // and must be destroyed before the reader.
+    //
+    class sequential_reader final {
+    public:
+        struct chunk {
+            [[nodiscard]] char const *data() const noexcept {
+                return buffer.data();
+            }
+
+            io_buffer buffer;
+            ULONGLONG offset{0};
+            DWORD size{0};
+        };
+
+        static constexpr uint32_t default_max_reads_in_flight{32};
+
+        //
+        // Chunk size must be a multiple of the page size. If pool is
+        // nullptr, IOs complete on the default thread pool.
+        //
+        explicit sequential_reader(file_object &file,
+                                   DWORD chunk_size = 1024 * 1024,
+                                   uint32_t max_reads_in_flight = default_max_reads_in_flight,
+                                   tp::thread_pool *pool = nullptr)
+            : file_{file}
+            , file_size_{static_cast<ULONGLONG>(file.get_size())}
+            , chunk_size_{chunk_size}
+            , max_reads_in_flight_{max_reads_in_flight}
+            , buffers_{{chunk_size}, size_t{chunk_size} * min_reads_in_flight * 2}
+            , slots_{std::make_unique<slot[]>(max_reads_in_flight)} {
+            AC_THROW_IF(0 == chunk_size || 0 != chunk_size % system_page_size() ||
+                            max_reads_in_flight < min_reads_in_flight ||
+                            max_reads_in_flight > tp::io_handler::io_contexts_count,
+                        ERROR_INVALID_PARAMETER,
+                        "sequential_reader");
+            auto callback = [this](tp::callback_instance &,
+                                   tp::io_context &context,
+                                   ULONG error,
+                                   ULONG_PTR bytes_transferred) {
+                on_read_complete(*static_cast<slot *>(context.payload), error, bytes_transferred);
+            };
+            io_handler_ = pool ? pool->make_io_handler(file.get_handle(), std::move(callback))
+                               : tp::make_io_handler(file.get_handle(), std::move(callback));
+            start_reads();
+        }
+
+        sequential_reader(sequential_reader const &) = delete;
+        sequential_reader(sequential_reader &&) = delete;
+
+        sequential_reader &operator=(sequential_reader const &) = delete;
+        sequential_reader &operator=(sequential_reader &&) = delete;
+
+        ~sequential_reader() noexcept {
+            //
+            // Wait for reads that are still in flight before slots
+            // and buffers go away
+            //
+            io_handler_.reset();
+        }
+
+        //
+        // Blocks until next chunk is read. Returns false once whole
+        // file was handed out, and throws if the read failed.
+        //
+        [[nodiscard]] bool next(chunk &c) {
+            auto const entered{std::chrono::steady_clock::now()};
+            if (has_consumed_) {
+                update_average(average_consume_time_, entered - consumed_at_);
+            }
+            if (consumed_ == issued_) {
+                c = chunk{};
+                return false;
+            }
+            slot &s{slots_[consumed_ % max_reads_in_flight_]};
+            while (!s.is_complete.load(std::memory_order_acquire)) {
+                static_cast<void>(completed_.wait());
+            }
+            s.is_complete.store(false, std::memory_order_relaxed);
+            ++consumed_;
+            update_average(average_read_latency_, s.completed_at - s.issued_at);
+            //
+            // Until consumer came back once we do not know how long
+            // it takes on a chunk
+            //
+            if (has_consumed_) {
+                update_target();
+            }
+
+            AC_THROW_IF(ERROR_SUCCESS != s.error && ERROR_HANDLE_EOF != s.error, s.error, "ReadFile");
+            c.buffer = std::move(s.buffer);
+            c.offset = s.offset;
+            c.size = s.bytes_read;
+            //
+            // Short read means file got truncated, nothing left to
+            // read after it
+            //
+            if (s.bytes_read < s.bytes_expected) {
+                next_offset_ = file_size_;
+            }
+            start_reads();
+
+            consumed_at_ = std::chrono::steady_clock::now();
+            has_consumed_ = true;
+            return true;
+        }
+
+        //
+        // Calls callback with every chunk of the file in order
+        //
+        template<typename C>
+        void read_all(C &&callback) {
+            chunk c;
+            while (next(c)) {
+                callback(static_cast<chunk const &>(c));
+            }
+        }
+
+        [[nodiscard]] ULONGLONG file_size() const noexcept {
+            return file_size_;
+        }
+
+        [[nodiscard]] uint32_t reads_in_flight_target() const noexcept {
+            return target_reads_in_flight_;
+        }
+
+        [[nodiscard]] std::chrono::duration<double> average_read_latency() const noexcept {
+            return average_read_latency_;
+        }
+
+    private:
+        static constexpr uint32_t min_reads_in_flight{2};
+
+        struct slot {
+            io_buffer buffer;
+            ULONGLONG offset{0};
+            DWORD bytes_expected{0};
+            DWORD bytes_read{0};
+            DWORD error{ERROR_SUCCESS};
+            std::chrono::steady_clock::time_point issued_at;
+            std::chrono::steady_clock::time_point completed_at;
+            std::atomic<bool> is_complete{false};
+        };
+
+        //
+        // Runs on thread pool
+        //
+        void on_read_complete(slot &s, ULONG error, ULONG_PTR bytes_transferred) noexcept {
+            s.completed_at = std::chrono::steady_clock::now();
+            s.error = error;
+            s.bytes_read = static_cast<DWORD>(bytes_transferred);
+            s.is_complete.store(true, std::memory_order_release);
+            completed_.set();
+        }
+
+        //
+        // Issues reads until there are as many in flight as target
+        // says. Chunks that completed but were not consumed yet count
+        // as in flight, so slot of the next read is always free.
+        //
+        void start_reads() {
+            while (next_offset_ < file_size_ && issued_ - consumed_ < target_reads_in_flight_) {
+                slot &s{slots_[issued_ % max_reads_in_flight_]};
+                s.buffer = buffers_.allocate(chunk_size_);
+                s.offset = next_offset_;
+                s.bytes_expected = static_cast<DWORD>((std::min)(ULONGLONG{chunk_size_}, file_size_ - next_offset_));
+                s.bytes_read = 0;
+                s.error = ERROR_SUCCESS;
+                s.issued_at = std::chrono::steady_clock::now();
+
+                tp::io_operation operation{io_handler_->start_io_context()};
+                AC_CODDING_ERROR_IF_NOT(operation);
+                operation.context()->set_offset(s.offset);
+                operation.context()->payload = &s;
+                //
+                // Unbuffered reads must be a multiple of the sector
+                // size, so always ask for the whole chunk
+                //
+                bool is_eof{false};
+                DWORD bytes_read{0};
+                bool const completed{
+                    file_.read(s.buffer.data(), chunk_size_, &bytes_read, &is_eof, operation.overlapped())};
+                if (completed && is_eof) {
+                    //
+                    // File was truncated under us. No completion is
+                    // queued, so operation cancels the IO.
+                    //
+                    s.completed_at = s.issued_at;
+                    s.is_complete.store(true, std::memory_order_relaxed);
+                } else {
+                    operation.disarm();
+                }
+                ++issued_;
+                next_offset_ += chunk_size_;
+            }
+        }
+
+        void update_target() noexcept {
+            double const consume_time{(std::max)(average_consume_time_.count(), 1e-9)};
+            double const target{std::ceil(average_read_latency_.count() / consume_time) + 1.0};
+            target_reads_in_flight_ = static_cast<uint32_t>(
+                (std::min)(target, static_cast<double>(max_reads_in_flight_)));
+            target_reads_in_flight_ = (std::max)(target_reads_in_flight_, min_reads_in_flight);
+        }
+
+        static void update_average(std::chrono::duration<double> &average,
+                                   std::chrono::duration<double> sample) noexcept {
+            average = 0.0 == average.count() ? sample : average * 0.875 + sample * 0.125;
+        }
+
+        file_object &file_;
+        ULONGLONG const file_size_;
+        DWORD const chunk_size_;
+        uint32_t const max_reads_in_flight_;
+        io_buffer_pool buffers_;
+        std::unique_ptr<slot[]> slots_;
+        slim_event completed_{slim_event::automatic};
+        ULONGLONG next_offset_{0};
+        uint64_t issued_{0};
+        uint64_t consumed_{0};
+        uint32_t target_reads_in_flight_{min_reads_in_flight};
+        std::chrono::duration<double> average_read_latency_{0.0};
+        std::chrono::duration<double> average_consume_time_{0.0};
+        std::chrono::steady_clock::time_point consumed_at_;
+        bool has_consumed_{false};
+        tp::io_handler_ptr io_handler_;
+    };
+
+} // namespace ac
+
+#endif //_AC_HELPERS_WIN32_LIBRARY_SEQUENTIAL_READER_HEADER_
@@ -0,0 +1,128 @@
+#ifndef _AC_HELPERS_WIN32_LIBRARY_SLIM_EVENT_HEADER_
+#define _AC_HELPERS_WIN32_LIBRARY_SLIM_EVENT_HEADER_
+
+#pragma once
+
+#include "accommon.h"
+#include "acwaitonaddress.h"
+
+namespace ac {
+
+    //
+    // Manual or auto reset event that takes a single word and no
+    // kernel object. Word keeps signaled bit, event type and number
+    // of waiting threads, so set and reset do not leave user mode
+    // unless some thread is waiting.
+    //
+    // Can be used in place of ac::event for signalling within the
+    // process. It cannot be waited on together with other objects.
+    // Waiters recheck the word when they wake up, so if event is
+    // reset right after set, a waiter that has not run yet keeps
+    // waiting.
+    //
+    class slim_event {
+    public:
+        enum event_type_t : bool { manuel = true, automatic = false };
+        enum event_state_t : bool { signaled = true, unsignaled = false };
+
+        explicit slim_event(event_type_t event_type = manuel, event_state_t event_state = unsignaled) noexcept
+            : state_{(event_state ? signaled_bit : 0) | (event_type ? manual_reset_bit : 0)} {
+        }
+
+        slim_event(slim_event const &) = delete;
+        slim_event(slim_event &&) = delete;
+
+        slim_event &operator=(slim_event const &) = delete;
+        slim_event &operator=(slim_event &&) = delete;
+
+        ~slim_event() noexcept {
+            AC_CODDING_ERROR_IF(0 != waiters_count(state_.load(std::memory_order_relaxed)));
+        }
+
+        //
+        // Wakes all waiters of manual reset event, or one waiter of
+        // auto reset event
+        //
+        void set() noexcept {
+            uint32_t const previous{state_.fetch_or(signaled_bit, std::memory_order_seq_cst)};
+            if (0 == (previous & signaled_bit) && 0 != waiters_count(previous)) {
+                if (previous & manual_reset_bit) {
+                    wait_on_address::wake_all(state_address());
+                } else {
+                    wait_on_address::wake_single(state_address());
+                }
+            }
+        }
+
+        void reset() noexcept {
+            state_.fetch_and(~signaled_bit, std::memory_order_relaxed);
+        }
+
+        [[nodiscard]] bool is_set() const noexcept {
+            return 0 != (state_.load(std::memory_order_acquire) & signaled_bit);
+        }
+
+        [[nodiscard]] bool is_manual_reset() const noexcept {
+            return 0 != (state_.load(std::memory_order_relaxed) & manual_reset_bit);
+        }
+
+        //
+        // Returns WAIT_OBJECT_0 or WAIT_TIMEOUT, same as waiting on
+        // ac::event. Waiter of auto reset event resets it.
+        //
+        [[nodiscard]] DWORD wait(DWORD milliseconds = INFINITE) noexcept {
+            wait_deadline const deadline{milliseconds};
+            for (;;) {
+                if (try_acquire()) {
+                    return WAIT_OBJECT_0;
+                }
+                DWORD const remaining{deadline.remaining()};
+                if (0 == remaining) {
+                    return WAIT_TIMEOUT;
+                }
+                //
+                // Setter either sees us in the waiters count, or we
+                // see the signaled bit
+                //
+                uint32_t const state{state_.fetch_add(waiter_increment, std::memory_order_seq_cst) +
+                                     waiter_increment};
+                if (0 == (state & signaled_bit)) {
+                    static_cast<void>(wait_on_address::try_wait(state_address(), state, remaining));
+                }
+                state_.fetch_sub(waiter_increment, std::memory_order_relaxed);
+            }
+        }
+
+    private:
+        static constexpr uint32_t signaled_bit{1};
+        static constexpr uint32_t manual_reset_bit{2};
+        static constexpr uint32_t waiter_increment{4};
+
+        [[nodiscard]] static uint32_t waiters_count(uint32_t state) noexcept {
+            return state / waiter_increment;
+        }
+
+        [[nodiscard]] bool try_acquire() noexcept {
+            uint32_t state{state_.load(std::memory_order_acquire)};
+            if (state & manual_reset_bit) {
+                return 0 != (state & signaled_bit);
+            }
+            while (state & signaled_bit) {
+                if (state_.compare_exchange_weak(
+                        state, state & ~signaled_bit, std::memory_order_acquire, std::memory_order_relaxed)) {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        uint32_t const volatile *state_address() const noexcept {
+            return reinterpret_cast<uint32_t const volatile *>(&state_);
+        }
+
+        std::atomic<uint32_t> state_;
+    };
+
+} // namespace ac
+
+#endif //_AC_HELPERS_WIN32_LIBRARY_SLIM_EVENT_HEADER_
@@ -7,6 +7,7 @@
 #include "accommon.h"
 #include "acresourceowner.h"
 #include "acrundown.h"
+#include "acseqlock.h"
 
 namespace ac::tp {
 
@@ -53,6 +54,9 @@ namespace ac::tp {
     class timer_work_item;
     class wait_work_item;
     class io_handler;
+    struct io_context;
+    template<typename R>
+    class join_async_awaiter;
 
     typedef std::shared_ptr<thread_pool> thread_pool_ptr;
     typedef std::shared_ptr<work_item_base> work_item_base_ptr;
@@ -65,6 +69,7 @@ namespace ac::tp {
     typedef std::move_only_function<void(callback_instance &)> timer_work_item_callback; // see help for the CreateThreadpoolTimer
     typedef std::move_only_function<void(callback_instance &, TP_WAIT_RESULT)> wait_work_item_callback; // see help for the CreateThreadpoolWait
     typedef std::move_only_function<void(callback_instance &, OVERLAPPED *, ULONG, ULONG_PTR)> io_callback; // see help for the CreateThreadpoolIo
+    typedef std::move_only_function<void(callback_instance &, io_context &, ULONG, ULONG_PTR)> io_context_callback;
 
     struct optional_callback_parameters {
         std::optional<TP_CALLBACK_PRIORITY> priority;
@@ -168,12 +173,13 @@ namespace ac::tp {
         using profiling_time_point = profiling_clock::time_point;
 
         [[nodiscard]] profiling_duration get_wait_duration() const noexcept {
+            profiling_times const times{times_.load()};
             profiling_duration result;
-            if (scheduled_time_.time_since_epoch().count() > 0) {
-                if (started_time_.time_since_epoch().count() > 0) {
-                    result = started_time_ - scheduled_time_;
+            if (times.scheduled_time.time_since_epoch().count() > 0) {
+                if (times.started_time.time_since_epoch().count() > 0) {
+                    result = times.started_time - times.scheduled_time;
                 } else {
-                    result = now() - scheduled_time_;
+                    result = now() - times.scheduled_time;
                 }
             } else {
                 result = profiling_duration{};
@@ -182,12 +188,13 @@ namespace ac::tp {
         }
 
         [[nodiscard]] profiling_duration get_run_duration() const noexcept {
+            profiling_times const times{times_.load()};
             profiling_duration result;
-            if (started_time_.time_since_epoch().count() > 0) {
-                if (completed_time_.time_since_epoch().count() > 0) {
-                    result = completed_time_ - started_time_;
+            if (times.started_time.time_since_epoch().count() > 0) {
+                if (times.completed_time.time_since_epoch().count() > 0) {
+                    result = times.completed_time - times.started_time;
                 } else {
-                    result = now() - started_time_;
+                    result = now() - times.started_time;
                 }
             } else {
                 result = profiling_duration{};
@@ -196,12 +203,13 @@ namespace ac::tp {
         }
 
         [[nodiscard]] profiling_duration get_duration() const noexcept {
+            profiling_times const times{times_.load()};
             profiling_duration result;
-            if (scheduled_time_.time_since_epoch().count() > 0) {
-                if (completed_time_.time_since_epoch().count() > 0) {
-                    result = completed_time_ - scheduled_time_;
+            if (times.scheduled_time.time_since_epoch().count() > 0) {
+                if (times.completed_time.time_since_epoch().count() > 0) {
+                    result = times.completed_time - times.scheduled_time;
                 } else {
-                    result = now() - scheduled_time_;
+                    result = now() - times.scheduled_time;
                 }
             } else {
                 result = profiling_duration{};
@@ -215,33 +223,46 @@ namespace ac::tp {
         }
 
         void update_scheduled_time() noexcept {
-            scheduled_time_ = now();
-            completed_time_ = profiling_time_point{};
-            started_time_ = profiling_time_point{};
+            times_.store(profiling_times{now(), profiling_time_point{}, profiling_time_point{}});
         }
 
         void update_started_time() noexcept {
-            started_time_ = now();
+            profiling_time_point const started_time{now()};
+            times_.update([started_time](profiling_times &times) noexcept {
+                times.started_time = started_time;
+            });
         }
 
         void update_completed_time() noexcept {
-            completed_time_ = now();
+            profiling_time_point const completed_time{now()};
+            times_.update([completed_time](profiling_times &times) noexcept {
+                times.completed_time = completed_time;
+            });
         }
 
     private:
+        struct profiling_times {
+            //
+            // Time when work item is posted
+            //
+            profiling_time_point scheduled_time;
+            //
+            // time when work item was picked by a thread
+            // and started executing
+            //
+            profiling_time_point started_time;
+            //
+            // time when workitem completed execution
+            //
+            profiling_time_point completed_time;
+        };
         //
-        // Time when work item is posted
-        //
-        profiling_time_point scheduled_time_{};
-        //
-        // time when work item was picked by a thread
-        // and started executing
-        //
-        profiling_time_point started_time_{};
-        //
-        // time when workitem completed execution
+        // Timestamps are updated by the thread that posts work item and
+        // by the threads that run it. A re-post can overlap the update
+        // from the run that is still finishing, so writes are
+        // serialized by the seqlock.
         //
-        profiling_time_point completed_time_{};
+        seqlock<profiling_times> times_{};
     };
 
     class work_item_base
@@ -829,6 +850,111 @@ namespace ac::tp {
         DWORD callback_thread_id_{0};
     };
 
+    namespace details {
+        class io_context_slab;
+    } // namespace details
+
+    //
+    // OVERLAPPED with a slot for the caller's per IO state. io_handler
+    // that completes IOs to an io_context_callback keeps a slab of
+    // these and hands them out from start_io_context, so starting an
+    // IO does not allocate.
+    //
+    struct io_context final : OVERLAPPED {
+        void set_offset(ULONGLONG offset) noexcept {
+            Offset = get_low_dword(offset);
+            OffsetHigh = get_high_dword(offset);
+        }
+
+        [[nodiscard]] ULONGLONG get_offset() const noexcept {
+            return make_ulonglong(Offset, OffsetHigh);
+        }
+
+        void *payload{nullptr};
+
+    private:
+        friend class details::io_context_slab;
+
+        std::atomic<uint32_t> next_free_{0};
+    };
+
+    namespace details {
+        //
+        // Fixed array of io_context with a lock free free list. Head
+        // keeps index of the first free context in the low half and a
+        // counter in the high half, so a context that was popped and
+        // pushed back between our load and CAS does not fool us.
+        //
+        class io_context_slab final {
+        public:
+            explicit io_context_slab(uint32_t capacity)
+                : contexts_{std::make_unique<io_context[]>(capacity)}
+                , capacity_{capacity} {
+                AC_CODDING_ERROR_IF(0 == capacity || end_of_list == capacity);
+                for (uint32_t i = 0; i < capacity; ++i) {
+                    contexts_[i].next_free_.store(i + 1 < capacity ? i + 1 : end_of_list,
+                                                  std::memory_order_relaxed);
+                }
+                head_.store(0, std::memory_order_relaxed);
+            }
+
+            io_context_slab(io_context_slab const &) = delete;
+            io_context_slab(io_context_slab &&) = delete;
+
+            io_context_slab &operator=(io_context_slab const &) = delete;
+            io_context_slab &operator=(io_context_slab &&) = delete;
+
+            [[nodiscard]] uint32_t capacity() const noexcept {
+                return capacity_;
+            }
+
+            //
+            // Returns nullptr when all contexts are in use
+            //
+            [[nodiscard]] io_context *try_pop() noexcept {
+                uint64_t head{head_.load(std::memory_order_acquire)};
+                for (;;) {
+                    uint32_t const index{static_cast<uint32_t>(head)};
+                    if (end_of_list == index) {
+                        return nullptr;
+                    }
+                    uint32_t const next{contexts_[index].next_free_.load(std::memory_order_relaxed)};
+                    if (head_.compare_exchange_weak(
+                            head, make_head(head, next), std::memory_order_acquire, std::memory_order_acquire)) {
+                        io_context *const context{&contexts_[index]};
+                        static_cast<OVERLAPPED &>(*context) = OVERLAPPED{};
+                        context->payload = nullptr;
+                        return context;
+                    }
+                }
+            }
+
+            void push(io_context *context) noexcept {
+                uint32_t const index{static_cast<uint32_t>(context - contexts_.get())};
+                AC_CODDING_ERROR_IF(index >= capacity_);
+                uint64_t head{head_.load(std::memory_order_relaxed)};
+                for (;;) {
+                    context->next_free_.store(static_cast<uint32_t>(head), std::memory_order_relaxed);
+                    if (head_.compare_exchange_weak(
+                            head, make_head(head, index), std::memory_order_release, std::memory_order_relaxed)) {
+                        return;
+                    }
+                }
+            }
+
+        private:
+            static constexpr uint32_t end_of_list{0xFFFFFFFF};
+
+            [[nodiscard]] static uint64_t make_head(uint64_t previous, uint32_t index) noexcept {
+                return ((previous >> 32) + 1) << 32 | index;
+            }
+
+            std::unique_ptr<io_context[]> contexts_;
+            uint32_t const capacity_;
+            alignas(cache_line_size) std::atomic<uint64_t> head_;
+        };
+    } // namespace details
+
     class io_guard final {
     public:
         io_guard() {
@@ -871,9 +997,80 @@ namespace ac::tp {
         }
 
     private:
+        friend class io_operation;
+
         io_handler *handler_{nullptr};
     };
 
+    //
+    // IO context together with the guard that started IO for it.
+    // If IO was not started, destructor cancels it and returns
+    // context to the io_handler. Call disarm once IO is pending or
+    // completed, from then on completion callback owns the context.
+    //
+    class io_operation final {
+    public:
+        io_operation() noexcept {
+        }
+
+        io_operation(io_operation const &) = delete;
+        io_operation &operator=(io_operation const &) = delete;
+
+        io_operation(io_operation &&other) noexcept
+            : guard_{std::move(other.guard_)}
+            , context_{other.context_} {
+            other.context_ = nullptr;
+        }
+
+        io_operation &operator=(io_operation &&other) noexcept {
+            if (&other != this) {
+                reset();
+                guard_ = std::move(other.guard_);
+                context_ = other.context_;
+                other.context_ = nullptr;
+            }
+            return *this;
+        }
+
+        ~io_operation() noexcept {
+            reset();
+        }
+
+        [[nodiscard]] bool is_armed() const noexcept {
+            return nullptr != context_;
+        }
+
+        operator bool() const noexcept {
+            return is_armed();
+        }
+
+        [[nodiscard]] io_context *context() const noexcept {
+            return context_;
+        }
+
+        [[nodiscard]] OVERLAPPED *overlapped() const noexcept {
+            return context_;
+        }
+
+        void disarm() noexcept {
+            guard_.disarm();
+            context_ = nullptr;
+        }
+
+    private:
+        friend class io_handler;
+
+        io_operation(io_guard &&guard, io_context *context) noexcept
+            : guard_{std::move(guard)}
+            , context_{context} {
+        }
+
+        void reset() noexcept;
+
+        io_guard guard_;
+        io_context *context_{nullptr};
+    };
+
     //
     // This method provides access to the thread pool's completion port
     // Pleaser note that it does not use work_item_base state machine to
@@ -883,11 +1080,26 @@ namespace ac::tp {
     //
     class io_handler final {
         friend class io_guard;
+        friend class io_operation;
 
     public:
+        //
+        // Number of io_context in the slab of a handler with
+        // io_context_callback, and so the limit of IOs it can have
+        // pending at a time
+        //
+        static constexpr uint32_t io_contexts_count{1024};
+
+        //
+        // Callback takes either OVERLAPPED * that caller allocated
+        // for the IO, or io_context & that came from start_io_context.
+        // Context goes back to the slab once callback returns.
+        //
         template<typename C>
         explicit io_handler(HANDLE handle, C &&callback, callback_environment *environment = nullptr)
-            : callback_(std::forward<C>(callback))
+            : contexts_(uses_io_context<C> ? std::make_unique<details::io_context_slab>(io_contexts_count)
+                                           : nullptr)
+            , callback_(make_callback(std::forward<C>(callback)))
             , io_(nullptr) {
             io_ = CreateThreadpoolIo(handle,
                                      &io_handler::run_callback,
@@ -933,6 +1145,21 @@ namespace ac::tp {
             return io_guard{this};
         }
 
+        //
+        // Same as start_io, but also takes a zeroed io_context from
+        // the slab. Returns an empty operation if all contexts are in
+        // use. Can be called only if handler was created with
+        // io_context_callback.
+        //
+        [[nodiscard]] io_operation start_io_context() noexcept {
+            AC_CODDING_ERROR_IF(nullptr == contexts_);
+            io_context *const context{contexts_->try_pop()};
+            if (nullptr == context) {
+                return io_operation{};
+            }
+            return io_operation{io_guard{this}, context};
+        }
+
         //
         // According to MSDN you MUST call this method whenever
         // IO operation has completed synchronously with an error
@@ -970,6 +1197,27 @@ namespace ac::tp {
             return state_.exchange(new_state);
         }
 
+        template<typename C>
+        static constexpr bool uses_io_context{
+            std::is_invocable_v<C &, callback_instance &, io_context &, ULONG, ULONG_PTR>};
+
+        template<typename C>
+        [[nodiscard]] io_callback make_callback(C &&callback) {
+            if constexpr (uses_io_context<C>) {
+                return io_callback{[this, callback = io_context_callback{std::forward<C>(callback)}](
+                                       callback_instance &instance,
+                                       OVERLAPPED *overlapped,
+                                       ULONG result,
+                                       ULONG_PTR bytes_transferred) mutable {
+                    io_context *const context{static_cast<io_context *>(overlapped)};
+                    callback(instance, *context, result, bytes_transferred);
+                    contexts_->push(context);
+                }};
+            } else {
+                return io_callback{std::forward<C>(callback)};
+            }
+        }
+
         void internal_start_io() noexcept {
             AC_CODDING_ERROR_IF(is_closed());
 
@@ -1006,6 +1254,7 @@ namespace ac::tp {
         }
 
         std::atomic<state_t> state_{state_t::initialized};
+        std::unique_ptr<details::io_context_slab> contexts_;
         io_callback callback_;
         PTP_IO io_;
     };
@@ -1031,6 +1280,24 @@ namespace ac::tp {
         handler_ = nullptr;
     }
 
+    inline void io_operation::reset() noexcept {
+        if (context_) {
+            io_handler *const handler{guard_.handler_};
+            guard_.failed_start_io();
+            handler->contexts_->push(context_);
+            context_ = nullptr;
+        }
+    }
+
+    namespace details {
+        template<typename R>
+        inline void post_on_rundown_complete(R &rundown, work_item_ptr work_item) {
+            rundown.join_async(rundown_continuation{[work_item = std::move(work_item)]() {
+                work_item->post();
+            }});
+        }
+    } // namespace details
+
     class thread_pool final: public std::enable_shared_from_this<thread_pool> {
     public:
         explicit thread_pool(unsigned long max_threads = ULONG_MAX,
@@ -1193,6 +1460,23 @@ namespace ac::tp {
             return wait_work_item;
         }
 
+        //
+        // Starts rundown, and posts callback to this pool once
+        // rundown completes. Work item is created here, so the
+        // thread that releases the last reference only does a post
+        // that cannot fail.
+        //
+        template<typename R, typename C>
+        void join_async(R &rundown,
+                        C &&callback,
+                        optional_callback_parameters const *params = nullptr) {
+            details::post_on_rundown_complete(
+                rundown, make_work_item(std::forward<C>(callback), params));
+        }
+
+        template<typename R>
+        [[nodiscard]] join_async_awaiter<R> join_async(R &rundown) noexcept;
+
         void get_stack_information(PTP_POOL_STACK_INFORMATION stack_information) noexcept {
             QueryThreadpoolStackInformation(pool_, stack_information);
         }
@@ -1393,6 +1677,61 @@ namespace ac::tp {
         return wait_work_item;
     }
 
+    template<typename R, typename C>
+    inline void join_async(R &rundown, C &&callback) {
+        details::post_on_rundown_complete(rundown, make_work_item(std::forward<C>(callback)));
+    }
+
+    template<typename R, typename C>
+    inline void join_async(R &rundown, C &&callback, optional_callback_parameters const *params) {
+        details::post_on_rundown_complete(rundown,
+                                          make_work_item(std::forward<C>(callback), params));
+    }
+
+    //
+    // co_await ac::tp::join_async(rundown) starts rundown and resumes
+    // coroutine on a thread pool thread once rundown completes.
+    // Does not suspend if rundown is already complete.
+    //
+    template<typename R>
+    class join_async_awaiter {
+    public:
+        explicit join_async_awaiter(R *rundown, thread_pool *pool = nullptr) noexcept
+            : rundown_(rundown)
+            , pool_(pool) {
+        }
+
+        [[nodiscard]] bool await_ready() const noexcept {
+            return false;
+        }
+
+        [[nodiscard]] bool await_suspend(std::coroutine_handle<> handle) {
+            auto resume{[handle](callback_instance &) { handle.resume(); }};
+            work_item_ptr work_item{pool_ ? pool_->make_work_item(resume) : make_work_item(resume)};
+            rundown_continuation continuation{[work_item = std::move(work_item)]() {
+                work_item->post();
+            }};
+            return rundown_->try_join_async(continuation);
+        }
+
+        void await_resume() const noexcept {
+        }
+
+    private:
+        R *rundown_;
+        thread_pool *pool_;
+    };
+
+    template<typename R>
+    [[nodiscard]] inline join_async_awaiter<R> join_async(R &rundown) noexcept {
+        return join_async_awaiter<R>{&rundown};
+    }
+
+    template<typename R>
+    [[nodiscard]] inline join_async_awaiter<R> thread_pool::join_async(R &rundown) noexcept {
+        return join_async_awaiter<R>{&rundown, this};
+    }
+
     template<typename T>
     class scoped_join {
     public:
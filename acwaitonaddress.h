@@ -3,14 +3,152 @@
 
 #pragma once
 
-#include <windows.h>
 #include "accommon.h"
 
+#if AC_PLATFORM_WINDOWS
+#include <windows.h>
 #pragma comment(lib, "Synchronization.lib")
+#else
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <time.h>
+#include <climits>
+#include <cstring>
+#endif
 
 namespace ac {
 
-#if (_WIN32_WINNT >= 0x0600)
+#if AC_PLATFORM_LINUX
+
+    namespace details {
+
+        [[nodiscard]] inline long futex(uint32_t const volatile *address,
+                                        int op,
+                                        uint32_t value,
+                                        timespec const *timeout = nullptr) noexcept {
+            return syscall(SYS_futex,
+                           const_cast<uint32_t *>(address),
+                           op | FUTEX_PRIVATE_FLAG,
+                           value,
+                           timeout,
+                           nullptr,
+                           0);
+        }
+
+        //
+        // Returns false only if wait timed out. Value mismatch and
+        // signals are reported as a wake, same as spurious wakes
+        // of WaitOnAddress, and callers are expected to recheck.
+        //
+        [[nodiscard]] inline bool futex_wait(uint32_t const volatile *address,
+                                             uint32_t undesired_value,
+                                             DWORD milliseconds) noexcept {
+            timespec timeout{};
+            timespec *timeout_ptr{nullptr};
+            if (INFINITE != milliseconds) {
+                timeout.tv_sec = milliseconds / 1000;
+                timeout.tv_nsec = static_cast<long>(milliseconds % 1000) * 1'000'000L;
+                timeout_ptr = &timeout;
+            }
+            if (-1 == futex(address, FUTEX_WAIT, undesired_value, timeout_ptr)) {
+                return ETIMEDOUT != errno;
+            }
+            return true;
+        }
+
+        //
+        // Returns number of woken threads
+        //
+        inline long futex_wake(uint32_t const volatile *address, int count) noexcept {
+            long const result{futex(address, FUTEX_WAKE, static_cast<uint32_t>(count))};
+            return result < 0 ? 0 : result;
+        }
+
+        //
+        // If address still holds expected value wakes up to wake_count
+        // waiters, and moves the rest to the target address without
+        // waking them. Returns number of woken plus moved threads, or
+        // -1 if value did not match.
+        //
+        inline long futex_requeue(uint32_t const volatile *address,
+                                  int wake_count,
+                                  uint32_t const volatile *target,
+                                  uint32_t expected_value) noexcept {
+            return syscall(SYS_futex,
+                           const_cast<uint32_t *>(address),
+                           FUTEX_CMP_REQUEUE | FUTEX_PRIVATE_FLAG,
+                           wake_count,
+                           static_cast<uintptr_t>(INT_MAX),
+                           const_cast<uint32_t *>(target),
+                           expected_value);
+        }
+
+        //
+        // Futex works only on 4 bytes values. Waits on values of other
+        // sizes are hashed by address onto a bucket with a sequence word
+        // that serves as the futex. Waker bumps sequence so waiter
+        // that sampled sequence before it compared value either sees
+        // the new value or fails futex wait on the changed sequence.
+        // Several addresses can share a bucket, so every wake wakes
+        // all waiters of the bucket and they recheck their values.
+        //
+        struct alignas(cache_line_size) wait_on_address_bucket {
+            std::atomic<uint32_t> sequence{0};
+            std::atomic<uint32_t> waiters{0};
+        };
+
+        inline constexpr size_t wait_on_address_buckets_count{256};
+
+        [[nodiscard]] inline wait_on_address_bucket &wait_on_address_bucket_for(
+            void const volatile *address) noexcept {
+            static wait_on_address_bucket buckets[wait_on_address_buckets_count];
+            uintptr_t const key{reinterpret_cast<uintptr_t>(address)};
+            return buckets[((key >> 3) * 0x9E3779B97F4A7C15ULL >> 56) % wait_on_address_buckets_count];
+        }
+
+        template<size_t S>
+        struct wait_on_address_word;
+
+        template<>
+        struct wait_on_address_word<1> {
+            using type = uint8_t;
+        };
+
+        template<>
+        struct wait_on_address_word<2> {
+            using type = uint16_t;
+        };
+
+        template<>
+        struct wait_on_address_word<4> {
+            using type = uint32_t;
+        };
+
+        template<>
+        struct wait_on_address_word<8> {
+            using type = uint64_t;
+        };
+
+        template<typename T>
+        [[nodiscard]] inline typename wait_on_address_word<sizeof(T)>::type wait_on_address_load(
+            T const volatile *address) noexcept {
+            using word_t = typename wait_on_address_word<sizeof(T)>::type;
+            return __atomic_load_n(reinterpret_cast<word_t const volatile *>(address), __ATOMIC_RELAXED);
+        }
+
+        template<typename T>
+        [[nodiscard]] inline typename wait_on_address_word<sizeof(T)>::type wait_on_address_bits(
+            T const &value) noexcept {
+            typename wait_on_address_word<sizeof(T)>::type bits;
+            memcpy(&bits, &value, sizeof(T));
+            return bits;
+        }
+    } // namespace details
+
+#endif // AC_PLATFORM_LINUX
+
+#if AC_PLATFORM_LINUX || (_WIN32_WINNT >= 0x0600)
 
     class wait_on_address {
     public:
@@ -21,38 +159,93 @@ namespace ac {
         wait_on_address &operator=(wait_on_address &&) = delete;
 
         template<typename T>
-        static [[nodiscard]] bool try_wait(T const volatile *address, T undesired_value, DWORD milliseconds = INFINITE) noexcept {
+        [[nodiscard]] static bool try_wait(T const volatile *address, T undesired_value, DWORD milliseconds = INFINITE) noexcept {
             static_assert(sizeof(T) == 1 || sizeof(T) == 2 || sizeof(T) == 4 ||
                               sizeof(T) == 8,
                           "Only 1, 2 4 or 8 bytes values are supported");
 
             static_assert(std::is_trivially_copyable<T>::value, "Only POD types are supported");
 
+#if AC_PLATFORM_WINDOWS
             return WaitOnAddress(
                        const_cast<T volatile *>(address), &undesired_value, sizeof(T), milliseconds)
                        ? true
                        : false;
+#else
+            if constexpr (sizeof(T) == 4) {
+                return details::futex_wait(reinterpret_cast<uint32_t const volatile *>(address),
+                                           details::wait_on_address_bits(undesired_value),
+                                           milliseconds);
+            } else {
+                details::wait_on_address_bucket &bucket{details::wait_on_address_bucket_for(address)};
+                bucket.waiters.fetch_add(1, std::memory_order_seq_cst);
+                uint32_t const sequence{bucket.sequence.load(std::memory_order_seq_cst)};
+                bool woken{true};
+                if (details::wait_on_address_load(address) ==
+                    details::wait_on_address_bits(undesired_value)) {
+                    woken = details::futex_wait(
+                        reinterpret_cast<uint32_t const volatile *>(&bucket.sequence), sequence, milliseconds);
+                }
+                bucket.waiters.fetch_sub(1, std::memory_order_relaxed);
+                return woken;
+            }
+#endif
         }
 
         template<typename T>
         static void wait(T const volatile *address, T undesired_value, DWORD milliseconds = INFINITE) {
             if (!try_wait(address, undesired_value, milliseconds)) {
+#if AC_PLATFORM_WINDOWS
                 AC_THROW(GetLastError(), "WaitOnAddress");
+#else
+                AC_THROW(ERROR_TIMEOUT, "futex");
+#endif
             }
         }
 
         template<typename T>
         static void wake_single(T const volatile *address) noexcept {
+#if AC_PLATFORM_WINDOWS
             WakeByAddressSingle(reinterpret_cast<void *>(const_cast<T *>(address)));
+#else
+            wake(address, 1);
+#endif
         }
 
         template<typename T>
         static void wake_all(T const volatile *address) noexcept {
+#if AC_PLATFORM_WINDOWS
             WakeByAddressAll(reinterpret_cast<void *>(const_cast<T *>(address)));
+#else
+            wake(address, INT_MAX);
+#endif
+        }
+
+#if AC_PLATFORM_LINUX
+    private:
+        template<typename T>
+        static void wake(T const volatile *address, int count) noexcept {
+            if constexpr (sizeof(T) == 4) {
+                details::futex_wake(reinterpret_cast<uint32_t const volatile *>(address), count);
+            } else {
+                //
+                // Bucket can be shared with other addresses, so we
+                // cannot wake just one waiter. Order the store of the
+                // new value that caller did before this call with
+                // the load of the waiters count.
+                //
+                details::wait_on_address_bucket &bucket{details::wait_on_address_bucket_for(address)};
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+                bucket.sequence.fetch_add(1, std::memory_order_seq_cst);
+                if (0 != bucket.waiters.load(std::memory_order_seq_cst)) {
+                    details::futex_wake(reinterpret_cast<uint32_t const volatile *>(&bucket.sequence), INT_MAX);
+                }
+            }
         }
+#endif // AC_PLATFORM_LINUX
     };
 
-#endif //(_WIN32_WINNT >= 0x0600)
+#endif // AC_PLATFORM_LINUX || (_WIN32_WINNT >= 0x0600)
 
 } // namespace ac
 
@@ -0,0 +1,645 @@
+#include "ac_test_file_object.h"
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <thread>
+#include <vector>
+
+#include "..\acfileobject.h"
+#include "..\acmappedfile.h"
+#include "..\acbufferpool.h"
+
+namespace {
+
+#if AC_PLATFORM_WINDOWS
+#define AC_TEST_FILE_BEGIN FILE_BEGIN
+
+    wchar_t const *const test_file_name{L"ac_test_file_object.tmp"};
+
+    ac::file_object open_test_file() {
+        return ac::file_object{test_file_name,
+                               GENERIC_READ | GENERIC_WRITE,
+                               FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+                               OPEN_ALWAYS};
+    }
+
+    ac::file_object create_test_file() {
+        return ac::file_object{test_file_name,
+                               GENERIC_READ | GENERIC_WRITE,
+                               FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+                               CREATE_ALWAYS};
+    }
+
+    [[nodiscard]] DWORD try_create_unbuffered_test_file(ac::file_object &fo) {
+        return fo.try_create(test_file_name,
+                             GENERIC_READ | GENERIC_WRITE,
+                             FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+                             CREATE_ALWAYS,
+                             FILE_ATTRIBUTE_NORMAL | FILE_FLAG_NO_BUFFERING);
+    }
+#else
+#define AC_TEST_FILE_BEGIN SEEK_SET
+
+    char const *const test_file_name{"ac_test_file_object.tmp"};
+
+    ac::file_object open_test_file() {
+        return ac::file_object{test_file_name, O_RDWR | O_CREAT};
+    }
+
+    ac::file_object create_test_file() {
+        return ac::file_object{test_file_name, O_RDWR | O_CREAT | O_TRUNC};
+    }
+
+    [[nodiscard]] DWORD try_create_unbuffered_test_file(ac::file_object &fo) {
+        return fo.try_create(test_file_name, O_RDWR | O_CREAT | O_TRUNC | O_DIRECT);
+    }
+#endif
+
+    //
+    // Every block starts with its index so a read from a wrong
+    // offset is noticed
+    //
+    constexpr DWORD test_block_size{4096};
+
+    void fill_block(std::vector<char> &block, unsigned index) {
+        block.assign(test_block_size, static_cast<char>('a' + index % 26));
+        memcpy(block.data(), &index, sizeof(index));
+    }
+
+    [[nodiscard]] bool is_block_valid(std::vector<char> const &block, unsigned index) {
+        unsigned stored_index{0};
+        memcpy(&stored_index, block.data(), sizeof(stored_index));
+        return stored_index == index && static_cast<char>('a' + index % 26) == block.back();
+    }
+
+    void write_test_blocks(ac::file_object &fo, unsigned blocks_count) {
+        std::vector<char> block;
+        for (unsigned i = 0; i < blocks_count; ++i) {
+            fill_block(block, i);
+            AC_CODDING_ERROR_IF_NOT(test_block_size ==
+                                    fo.write_sync(block.data(), LONGLONG{i} * test_block_size, test_block_size));
+        }
+    }
+
+} // namespace
+
+void test_file_object() {
+    printf("\n---- test_file_object started\n");
+
+    try {
+        constexpr unsigned blocks_count{64};
+        {
+            ac::file_object fo{create_test_file()};
+            AC_CODDING_ERROR_IF_NOT(0 == fo.get_size());
+            //
+            // Write blocks in reverse order, positional writes do not
+            // depend on where previous one ended
+            //
+            std::vector<char> block;
+            for (unsigned i = blocks_count; i-- > 0;) {
+                fill_block(block, i);
+                AC_CODDING_ERROR_IF_NOT(test_block_size ==
+                                        fo.write_sync(block.data(), LONGLONG{i} * test_block_size, test_block_size));
+            }
+            fo.flush();
+            AC_CODDING_ERROR_IF_NOT(LONGLONG{blocks_count} * test_block_size == fo.get_size());
+
+            bool is_eof{false};
+            std::vector<char> buffer(test_block_size);
+            AC_CODDING_ERROR_IF_NOT(test_block_size ==
+                                    fo.read_sync(buffer.data(), 5 * test_block_size, test_block_size, &is_eof));
+            AC_CODDING_ERROR_IF(is_eof);
+            AC_CODDING_ERROR_IF_NOT(is_block_valid(buffer, 5));
+            //
+            // Read across the end of file
+            //
+            DWORD const tail_size{100};
+            AC_CODDING_ERROR_IF_NOT(tail_size == fo.read_sync(buffer.data(),
+                                                              LONGLONG{blocks_count} * test_block_size - tail_size,
+                                                              test_block_size,
+                                                              &is_eof));
+            AC_CODDING_ERROR_IF_NOT(is_eof);
+#if AC_PLATFORM_LINUX
+            //
+            // Positional I/O does not move file pointer. On Windows it
+            // does for handles opened without FILE_FLAG_OVERLAPPED.
+            //
+            DWORD bytes_read{0};
+            AC_CODDING_ERROR_IF_NOT(fo.read(buffer.data(), test_block_size, &bytes_read));
+            AC_CODDING_ERROR_IF_NOT(test_block_size == bytes_read);
+            AC_CODDING_ERROR_IF_NOT(is_block_valid(buffer, 0));
+#endif
+
+            fo.resize(2 * test_block_size);
+            AC_CODDING_ERROR_IF_NOT(2 * test_block_size == fo.get_size());
+        }
+        {
+            //
+            // Byte range locks conflict between two opens of the file
+            //
+            ac::file_object first{open_test_file()};
+            ac::file_object second{open_test_file()};
+            first.byte_range_lock(0, test_block_size);
+            bool lock_failed{false};
+            try {
+                second.byte_range_lock(0, 1);
+            } catch (std::system_error const &) {
+                lock_failed = true;
+            }
+            AC_CODDING_ERROR_IF_NOT(lock_failed);
+            second.byte_range_lock(test_block_size, test_block_size);
+            second.byte_range_unlock(test_block_size, test_block_size);
+            first.byte_range_unlock(0, test_block_size);
+            second.byte_range_lock(0, 1);
+            second.byte_range_unlock(0, 1);
+        }
+        {
+            //
+            // Many threads read one file object at different offsets
+            //
+            ac::file_object fo{create_test_file()};
+            write_test_blocks(fo, blocks_count);
+
+            std::vector<std::thread> readers;
+            std::atomic<int> errors_count{0};
+            for (unsigned t = 0; t < 4; ++t) {
+                readers.emplace_back([&fo, &errors_count, t]() {
+                    std::vector<char> buffer(test_block_size);
+                    for (int pass = 0; pass < 16; ++pass) {
+                        for (unsigned i = t; i < blocks_count; i += 4) {
+                            bool is_eof{false};
+                            if (test_block_size !=
+                                    fo.read_sync(buffer.data(), LONGLONG{i} * test_block_size, test_block_size, &is_eof) ||
+                                !is_block_valid(buffer, i)) {
+                                errors_count.fetch_add(1);
+                            }
+                        }
+                    }
+                });
+            }
+            for (auto &t : readers) {
+                t.join();
+            }
+            AC_CODDING_ERROR_IF_NOT(0 == errors_count.load());
+        }
+        static_cast<void>(ac::file_object::try_erase(test_file_name));
+    } catch (std::exception const &ex) {
+        printf("---- test_file_object failed %s\n", ex.what());
+    }
+    printf("---- test_file_object complete\n");
+}
+
+void test_file_object_vectored() {
+    printf("\n---- test_file_object_vectored started\n");
+
+    try {
+        ac::file_object fo{create_test_file()};
+        //
+        // Record is assembled from header, payload and padding
+        // without copying them into one buffer
+        //
+        struct record_header {
+            unsigned size;
+            unsigned sequence;
+        };
+        char const payload[]{"scatter gather payload"};
+        char const padding[10]{};
+        record_header const header{sizeof(payload), 7};
+
+        ac::io_segment const record[]{
+            {&header, sizeof(header)},
+            {payload, sizeof(payload)},
+            {padding, sizeof(padding)},
+        };
+        DWORD const record_size{sizeof(header) + sizeof(payload) + sizeof(padding)};
+        AC_CODDING_ERROR_IF_NOT(record_size == fo.write_vectored_sync(record, 100));
+        AC_CODDING_ERROR_IF_NOT(100 + record_size == fo.get_size());
+
+        record_header read_header{};
+        char read_payload[sizeof(payload)]{};
+        char read_padding[sizeof(padding) + 8]{};
+        ac::io_segment const read_record[]{
+            {&read_header, sizeof(read_header)},
+            {read_payload, sizeof(read_payload)},
+            {read_padding, sizeof(read_padding)},
+        };
+        bool is_eof{false};
+        AC_CODDING_ERROR_IF_NOT(record_size == fo.read_vectored_sync(read_record, 100, &is_eof));
+        AC_CODDING_ERROR_IF_NOT(is_eof);
+        AC_CODDING_ERROR_IF_NOT(header.size == read_header.size && header.sequence == read_header.sequence);
+        AC_CODDING_ERROR_IF_NOT(0 == memcmp(payload, read_payload, sizeof(payload)));
+        //
+        // More segments than one system call takes, with short
+        // segments and empty ones in between
+        //
+        std::vector<std::vector<char>> pieces;
+        std::vector<ac::io_segment> segments;
+        DWORD total_size{0};
+        for (unsigned i = 0; i < 300; ++i) {
+            pieces.emplace_back(i % 7, static_cast<char>('a' + i % 26));
+            segments.emplace_back(pieces.back().data(), static_cast<DWORD>(pieces.back().size()));
+            total_size += static_cast<DWORD>(pieces.back().size());
+        }
+        AC_CODDING_ERROR_IF_NOT(total_size == fo.write_vectored_sync(segments, 0));
+
+        std::vector<char> flat(total_size);
+        is_eof = false;
+        AC_CODDING_ERROR_IF_NOT(total_size == fo.read_sync(flat.data(), 0, total_size, &is_eof));
+        size_t position{0};
+        for (auto const &piece : pieces) {
+            AC_CODDING_ERROR_IF_NOT(0 == memcmp(piece.data(), flat.data() + position, piece.size()));
+            position += piece.size();
+        }
+
+        std::vector<std::vector<char>> read_pieces;
+        std::vector<ac::io_segment> read_segments;
+        for (auto const &piece : pieces) {
+            read_pieces.emplace_back(piece.size());
+            read_segments.emplace_back(read_pieces.back().data(), static_cast<DWORD>(piece.size()));
+        }
+        is_eof = false;
+        AC_CODDING_ERROR_IF_NOT(total_size == fo.read_vectored_sync(read_segments, 0, &is_eof));
+        AC_CODDING_ERROR_IF(is_eof);
+        AC_CODDING_ERROR_IF_NOT(pieces == read_pieces);
+        //
+        // Sequential variants move file pointer
+        //
+        fo.resize(0);
+        static_cast<void>(fo.set_file_pointer(0, AC_TEST_FILE_BEGIN));
+        AC_CODDING_ERROR_IF_NOT(record_size == fo.write_vectored(record));
+        AC_CODDING_ERROR_IF_NOT(record_size == fo.write_vectored(record));
+        static_cast<void>(fo.set_file_pointer(record_size, AC_TEST_FILE_BEGIN));
+        DWORD bytes_read{0};
+        AC_CODDING_ERROR_IF_NOT(fo.read_vectored(read_record, &bytes_read));
+        AC_CODDING_ERROR_IF_NOT(record_size == bytes_read);
+        AC_CODDING_ERROR_IF_NOT(header.sequence == read_header.sequence);
+        AC_CODDING_ERROR_IF(fo.read_vectored(read_record, &bytes_read));
+        fo.close();
+        static_cast<void>(ac::file_object::try_erase(test_file_name));
+    } catch (std::exception const &ex) {
+        printf("---- test_file_object_vectored failed %s\n", ex.what());
+    }
+    printf("---- test_file_object_vectored complete\n");
+}
+
+void test_mapped_file() {
+    printf("\n---- test_mapped_file started\n");
+
+    try {
+        constexpr unsigned blocks_count{64};
+        {
+            ac::file_object fo{create_test_file()};
+            write_test_blocks(fo, blocks_count);
+
+            ac::mapped_file mapping{fo};
+            AC_CODDING_ERROR_IF_NOT(LONGLONG{blocks_count} * test_block_size == mapping.get_size());
+            //
+            // Whole file in one view
+            //
+            ac::file_view view{mapping.map(0, 0, ac::view_advice::sequential)};
+            AC_CODDING_ERROR_IF_NOT(static_cast<size_t>(mapping.get_size()) == view.size());
+            std::vector<char> block(test_block_size);
+            for (unsigned i = 0; i < blocks_count; ++i) {
+                memcpy(block.data(), view.data() + size_t{i} * test_block_size, test_block_size);
+                AC_CODDING_ERROR_IF_NOT(is_block_valid(block, i));
+            }
+            view.prefetch();
+            view.advise(ac::view_advice::random | ac::view_advice::huge_pages);
+            //
+            // Unaligned window sliding over the file. Each window
+            // starts in the middle of a block.
+            //
+            size_t const window_size{3 * test_block_size};
+            ac::file_view window{mapping.map(test_block_size / 2, window_size, ac::view_advice::sequential)};
+            for (unsigned i = 1; i + 3 < blocks_count; i += 3) {
+                window.slide(LONGLONG{i} * test_block_size - test_block_size / 2, window_size);
+                AC_CODDING_ERROR_IF_NOT(window.offset() == LONGLONG{i} * test_block_size - test_block_size / 2);
+                AC_CODDING_ERROR_IF_NOT(window.contains(LONGLONG{i} * test_block_size, test_block_size));
+                AC_CODDING_ERROR_IF(window.contains(window.offset() + window_size, 1));
+                memcpy(block.data(), window.data() + test_block_size / 2, test_block_size);
+                AC_CODDING_ERROR_IF_NOT(is_block_valid(block, i));
+            }
+            //
+            // View is good after mapping is closed
+            //
+            mapping.close();
+            memcpy(block.data(), view.data(), test_block_size);
+            AC_CODDING_ERROR_IF_NOT(is_block_valid(block, 0));
+        }
+        {
+            //
+            // Read-write mapping grows the file, and writes through
+            // view are seen by file reads
+            //
+            ac::file_object fo{create_test_file()};
+            LONGLONG const size{LONGLONG{blocks_count} * test_block_size};
+            ac::mapped_file mapping{fo, ac::map_access::read_write, size};
+            AC_CODDING_ERROR_IF_NOT(size == fo.get_size());
+
+            ac::file_view view{mapping.map(0)};
+            std::vector<char> block;
+            for (unsigned i = 0; i < blocks_count; ++i) {
+                fill_block(block, i);
+                memcpy(view.data() + size_t{i} * test_block_size, block.data(), test_block_size);
+            }
+            view.flush();
+
+            bool is_eof{false};
+            std::vector<char> buffer(test_block_size);
+            AC_CODDING_ERROR_IF_NOT(test_block_size ==
+                                    fo.read_sync(buffer.data(), 9 * test_block_size, test_block_size, &is_eof));
+            AC_CODDING_ERROR_IF_NOT(is_block_valid(buffer, 9));
+
+            bool map_failed{false};
+            try {
+                static_cast<void>(mapping.map(size));
+            } catch (std::system_error const &) {
+                map_failed = true;
+            }
+            AC_CODDING_ERROR_IF_NOT(map_failed);
+        }
+        static_cast<void>(ac::file_object::try_erase(test_file_name));
+    } catch (std::exception const &ex) {
+        printf("---- test_mapped_file failed %s\n", ex.what());
+    }
+    printf("---- test_mapped_file complete\n");
+}
+
+void perftest_mapped_file() {
+    printf("\n---- perftest_mapped_file started\n");
+
+    try {
+        constexpr unsigned blocks_count{16 * 1024};
+        constexpr size_t window_size{16 * 1024 * 1024};
+        LONGLONG const file_size{LONGLONG{blocks_count} * test_block_size};
+
+        ac::file_object fo{create_test_file()};
+        write_test_blocks(fo, blocks_count);
+
+        auto const sum = [](char const *data, size_t size, unsigned long long checksum) {
+            for (size_t i = 0; i < size; i += sizeof(unsigned)) {
+                unsigned value;
+                memcpy(&value, data + i, sizeof(value));
+                checksum += value;
+            }
+            return checksum;
+        };
+
+        for (int pass = 0; pass < 3; ++pass) {
+            auto start{std::chrono::steady_clock::now()};
+            unsigned long long read_checksum{0};
+            std::vector<char> buffer(window_size);
+            for (LONGLONG offset = 0; offset < file_size; offset += window_size) {
+                bool is_eof{false};
+                DWORD const bytes_read{
+                    fo.read_sync(buffer.data(), offset, static_cast<DWORD>(window_size), &is_eof)};
+                read_checksum = sum(buffer.data(), bytes_read, read_checksum);
+            }
+            double const read_seconds{
+                std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count()};
+
+            start = std::chrono::steady_clock::now();
+            unsigned long long mapped_checksum{0};
+            ac::mapped_file mapping{fo};
+            ac::file_view window;
+            for (LONGLONG offset = 0; offset < file_size; offset += window_size) {
+                size_t const size{static_cast<size_t>((std::min)(LONGLONG{window_size}, file_size - offset))};
+                if (window) {
+                    window.slide(offset, size);
+                } else {
+                    window = mapping.map(offset, size, ac::view_advice::sequential);
+                }
+                mapped_checksum = sum(window.data(), window.size(), mapped_checksum);
+            }
+            double const mapped_seconds{
+                std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count()};
+
+            AC_CODDING_ERROR_IF_NOT(read_checksum == mapped_checksum);
+            printf("---- perftest_mapped_file %lld MB, read_sync %.0f MB/s, mapped %.0f MB/s\n",
+                   file_size / (1024 * 1024),
+                   file_size / (1024.0 * 1024.0) / read_seconds,
+                   file_size / (1024.0 * 1024.0) / mapped_seconds);
+        }
+        fo.close();
+        static_cast<void>(ac::file_object::try_erase(test_file_name));
+    } catch (std::exception const &ex) {
+        printf("---- perftest_mapped_file failed %s\n", ex.what());
+    }
+    printf("---- perftest_mapped_file complete\n");
+}
+
+void perftest_file_object_reads() {
+    printf("\n---- perftest_file_object_reads started\n");
+
+    try {
+        constexpr unsigned blocks_count{1024};
+        constexpr int reads_per_thread{100000};
+
+        ac::file_object fo{create_test_file()};
+        write_test_blocks(fo, blocks_count);
+
+        for (unsigned threads_count = 1; threads_count <= 8; threads_count *= 2) {
+            std::vector<std::thread> readers;
+            auto const start{std::chrono::steady_clock::now()};
+            for (unsigned t = 0; t < threads_count; ++t) {
+                readers.emplace_back([&fo, t]() {
+                    std::vector<char> buffer(test_block_size);
+                    unsigned block{t};
+                    for (int i = 0; i < reads_per_thread; ++i) {
+                        bool is_eof{false};
+                        static_cast<void>(fo.read_sync(
+                            buffer.data(), LONGLONG{block} * test_block_size, test_block_size, &is_eof));
+                        block = (block * 7 + 1) % blocks_count;
+                    }
+                });
+            }
+            for (auto &t : readers) {
+                t.join();
+            }
+            double const seconds{
+                std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count()};
+            printf("---- perftest_file_object_reads threads %u, %.0f reads/s\n",
+                   threads_count,
+                   threads_count * reads_per_thread / seconds);
+        }
+        fo.close();
+        static_cast<void>(ac::file_object::try_erase(test_file_name));
+    } catch (std::exception const &ex) {
+        printf("---- perftest_file_object_reads failed %s\n", ex.what());
+    }
+    printf("---- perftest_file_object_reads complete\n");
+}
+
+void test_io_buffer_pool() {
+    printf("\n---- test_io_buffer_pool started\n");
+
+    try {
+        {
+            ac::io_buffer_pool pool{{4096, 100, 64 * 1024}, 1024 * 1024};
+            AC_CODDING_ERROR_IF_NOT(ac::system_page_size() == pool.alignment());
+            AC_CODDING_ERROR_IF_NOT(64 * 1024 == pool.max_buffer_size());
+            //
+            // 100 is rounded up to the alignment and becomes same class
+            // as 4096 on systems with 4K pages
+            //
+            ac::io_buffer small{pool.allocate(1)};
+            AC_CODDING_ERROR_IF_NOT(small);
+            AC_CODDING_ERROR_IF_NOT(pool.alignment() == small.size());
+            AC_CODDING_ERROR_IF_NOT(0 == reinterpret_cast<uintptr_t>(small.data()) % pool.alignment());
+            ac::io_buffer large{pool.allocate(4097)};
+            AC_CODDING_ERROR_IF_NOT(64 * 1024 == large.size());
+            AC_CODDING_ERROR_IF_NOT(0 == reinterpret_cast<uintptr_t>(large.data()) % pool.alignment());
+            memset(large.data(), 0xcc, large.size());
+
+            AC_CODDING_ERROR_IF(pool.try_allocate(64 * 1024 + 1));
+            bool allocate_failed{false};
+            try {
+                static_cast<void>(pool.allocate(64 * 1024 + 1));
+            } catch (std::system_error const &) {
+                allocate_failed = true;
+            }
+            AC_CODDING_ERROR_IF_NOT(allocate_failed);
+            //
+            // Released buffer goes to the cache of current processor,
+            // and next allocation on the same processor is likely to
+            // get it back
+            //
+            char *const released{small.data()};
+            small.release();
+            AC_CODDING_ERROR_IF(small);
+            ac::io_buffer moved{std::move(large)};
+            AC_CODDING_ERROR_IF(large);
+            AC_CODDING_ERROR_IF_NOT(moved);
+            small = pool.allocate(10);
+            printf("---- test_io_buffer_pool buffer reused %s\n", released == small.data() ? "yes" : "no");
+        }
+        {
+            //
+            // Once slabs cover peak number of buffers in use, threads
+            // keep recycling them and pool does not grow
+            //
+            constexpr unsigned threads_count{8};
+            constexpr unsigned buffers_per_thread{16};
+            ac::io_buffer_pool pool{{16 * 1024}, 1024 * 1024};
+            auto const run = [&pool](unsigned iterations) {
+                std::vector<std::thread> threads;
+                for (unsigned t = 0; t < threads_count; ++t) {
+                    threads.emplace_back([&pool, t, iterations]() {
+                        std::vector<ac::io_buffer> buffers(buffers_per_thread);
+                        for (unsigned i = 0; i < iterations; ++i) {
+                            ac::io_buffer &buffer{buffers[i % buffers_per_thread]};
+                            buffer = pool.allocate(16 * 1024);
+                            memset(buffer.data(), static_cast<int>(t), 64);
+                            AC_CODDING_ERROR_IF_NOT(static_cast<char>(t) == buffer.data()[63]);
+                        }
+                    });
+                }
+                for (auto &t : threads) {
+                    t.join();
+                }
+            };
+            run(buffers_per_thread * 4);
+            size_t const slabs_count{pool.slabs_count()};
+            run(100000);
+            printf("---- test_io_buffer_pool slabs after warm up %zu, after stress %zu\n",
+                   slabs_count,
+                   pool.slabs_count());
+        }
+        {
+            ac::io_buffer_pool pool{{2 * 1024 * 1024}, 4 * 1024 * 1024, ac::io_buffer_pages::huge};
+            ac::io_buffer buffer{pool.allocate(2 * 1024 * 1024)};
+            memset(buffer.data(), 0, buffer.size());
+            printf("---- test_io_buffer_pool huge pages %s\n", pool.has_huge_pages() ? "yes" : "no");
+        }
+        {
+            //
+            // Unbuffered I/O takes buffers straight from the pool. Some
+            // file systems, like tmpfs, do not support it.
+            //
+            ac::file_object fo;
+            DWORD const error{try_create_unbuffered_test_file(fo)};
+            if (ERROR_SUCCESS == error) {
+                ac::io_buffer_pool pool{{test_block_size}, 256 * 1024};
+                std::vector<char> block;
+                for (unsigned i = 0; i < 16; ++i) {
+                    fill_block(block, i);
+                    ac::io_buffer buffer{pool.allocate(test_block_size)};
+                    memcpy(buffer.data(), block.data(), test_block_size);
+                    AC_CODDING_ERROR_IF_NOT(test_block_size ==
+                                            fo.write_sync(buffer.data(), LONGLONG{i} * test_block_size, test_block_size));
+                }
+                for (unsigned i = 0; i < 16; ++i) {
+                    ac::io_buffer buffer{pool.allocate(test_block_size)};
+                    bool is_eof{false};
+                    AC_CODDING_ERROR_IF_NOT(test_block_size ==
+                                            fo.read_sync(buffer.data(), LONGLONG{i} * test_block_size, test_block_size, &is_eof));
+                    block.assign(buffer.data(), buffer.data() + test_block_size);
+                    AC_CODDING_ERROR_IF_NOT(is_block_valid(block, i));
+                }
+                fo.close();
+                static_cast<void>(ac::file_object::try_erase(test_file_name));
+            } else {
+                printf("---- test_io_buffer_pool unbuffered I/O skipped, open failed %u\n", static_cast<unsigned>(error));
+            }
+        }
+    } catch (std::exception const &ex) {
+        printf("---- test_io_buffer_pool failed %s\n", ex.what());
+    }
+    printf("---- test_io_buffer_pool complete\n");
+}
+
+void perftest_io_buffer_pool() {
+    printf("\n---- perftest_io_buffer_pool started\n");
+
+    try {
+        constexpr size_t buffer_size{64 * 1024};
+        constexpr int allocations_per_thread{1000000};
+        ac::io_buffer_pool pool{{buffer_size}};
+
+        for (unsigned threads_count = 1; threads_count <= 8; threads_count *= 2) {
+            std::vector<std::thread> threads;
+            auto start{std::chrono::steady_clock::now()};
+            for (unsigned t = 0; t < threads_count; ++t) {
+                threads.emplace_back([&pool]() {
+                    for (int i = 0; i < allocations_per_thread; ++i) {
+                        ac::io_buffer buffer{pool.allocate(buffer_size)};
+                        buffer.data()[0] = static_cast<char>(i);
+                    }
+                });
+            }
+            for (auto &t : threads) {
+                t.join();
+            }
+            double const pool_seconds{
+                std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count()};
+
+            threads.clear();
+            start = std::chrono::steady_clock::now();
+            for (unsigned t = 0; t < threads_count; ++t) {
+                threads.emplace_back([]() {
+                    std::align_val_t const alignment{ac::system_page_size()};
+                    for (int i = 0; i < allocations_per_thread; ++i) {
+                        char *const buffer{static_cast<char *>(::operator new(buffer_size, alignment))};
+                        static_cast<char volatile *>(buffer)[0] = static_cast<char>(i);
+                        ::operator delete(buffer, alignment);
+                    }
+                });
+            }
+            for (auto &t : threads) {
+                t.join();
+            }
+            double const new_seconds{
+                std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count()};
+
+            printf("---- perftest_io_buffer_pool threads %u, pool %.0f ns, aligned new %.0f ns\n",
+                   threads_count,
+                   pool_seconds * 1e9 / allocations_per_thread,
+                   new_seconds * 1e9 / allocations_per_thread);
+        }
+    } catch (std::exception const &ex) {
+        printf("---- perftest_io_buffer_pool failed %s\n", ex.what());
+    }
+    printf("---- perftest_io_buffer_pool complete\n");
+}
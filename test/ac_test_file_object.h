@@ -0,0 +1,18 @@
+#ifndef _AC_HELPERS_WIN32_LIBRARY_TEST_FILE_OBJECT_HEADER_
+#define _AC_HELPERS_WIN32_LIBRARY_TEST_FILE_OBJECT_HEADER_
+
+void test_file_object();
+
+void test_file_object_vectored();
+
+void perftest_file_object_reads();
+
+void test_mapped_file();
+
+void perftest_mapped_file();
+
+void test_io_buffer_pool();
+
+void perftest_io_buffer_pool();
+
+#endif //_AC_HELPERS_WIN32_LIBRARY_TEST_FILE_OBJECT_HEADER_
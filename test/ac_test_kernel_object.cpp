@@ -0,0 +1,632 @@
+#include "ac_test_kernel_object.h"
+
+#include <stdlib.h>
+#include <stdio.h>
+
+#include <thread>
+#include <vector>
+
+#include "..\ackernelobject.h"
+#include "..\acslimevent.h"
+#include "..\acrundown.h"
+
+namespace {
+
+    //
+    // Runs test for every kind of object the platform has
+    //
+    template<typename F>
+    void for_each_kernel_object_kind(F &&f) {
+#if AC_PLATFORM_LINUX
+        f(ac::kernel_object_kind::pollable, "pollable");
+        f(ac::kernel_object_kind::in_process, "in process");
+#else
+        f(0, "kernel");
+#endif
+    }
+
+#if AC_PLATFORM_LINUX
+    ac::event make_event(ac::kernel_object_kind kind,
+                         ac::event::event_type_t type,
+                         ac::event::event_state_t state = ac::event::unsignaled) {
+        return ac::event{type, state, kind};
+    }
+
+    ac::semaphore make_semaphore(ac::kernel_object_kind kind, long initial_count, long max_count) {
+        return ac::semaphore{initial_count, max_count, kind};
+    }
+
+    ac::mutex make_mutex(ac::kernel_object_kind kind, bool initial_owner = false) {
+        return ac::mutex{initial_owner, kind};
+    }
+#else
+    ac::event make_event(int, ac::event::event_type_t type, ac::event::event_state_t state = ac::event::unsignaled) {
+        return ac::event{type, state};
+    }
+
+    ac::semaphore make_semaphore(int, long initial_count, long max_count) {
+        return ac::semaphore{initial_count, max_count};
+    }
+
+    ac::mutex make_mutex(int, bool initial_owner = false) {
+        return ac::mutex{initial_owner};
+    }
+#endif
+
+} // namespace
+
+void test_event() {
+    printf("\n---- test_event started\n");
+
+    try {
+        for_each_kernel_object_kind([](auto kind, char const *kind_name) {
+            printf("---- test_event %s\n", kind_name);
+
+            ac::event manual{make_event(kind, ac::event::manuel)};
+            AC_CODDING_ERROR_IF_NOT(WAIT_TIMEOUT == manual.wait(0));
+            manual.set();
+            AC_CODDING_ERROR_IF_NOT(WAIT_OBJECT_0 == manual.wait(0));
+            AC_CODDING_ERROR_IF_NOT(WAIT_OBJECT_0 == manual.wait(0));
+            manual.reset();
+            AC_CODDING_ERROR_IF_NOT(WAIT_TIMEOUT == manual.wait(0));
+            //
+            // Duplicate refers to the same event
+            //
+            ac::event copy{manual.duplicate()};
+            AC_CODDING_ERROR_IF_NOT(copy.is_valid());
+            copy.set();
+            AC_CODDING_ERROR_IF_NOT(WAIT_OBJECT_0 == manual.wait(0));
+            manual.reset();
+
+            ac::event automatic{make_event(kind, ac::event::automatic, ac::event::signaled)};
+            AC_CODDING_ERROR_IF_NOT(WAIT_OBJECT_0 == automatic.wait(0));
+            AC_CODDING_ERROR_IF_NOT(WAIT_TIMEOUT == automatic.wait(0));
+            //
+            // Several sets release only one waiter
+            //
+            automatic.set();
+            automatic.set();
+            AC_CODDING_ERROR_IF_NOT(WAIT_OBJECT_0 == automatic.wait(0));
+            AC_CODDING_ERROR_IF_NOT(WAIT_TIMEOUT == automatic.wait(0));
+
+            auto const start{std::chrono::steady_clock::now()};
+            AC_CODDING_ERROR_IF_NOT(WAIT_TIMEOUT == automatic.wait(50));
+            AC_CODDING_ERROR_IF(std::chrono::steady_clock::now() - start < std::chrono::milliseconds{40});
+
+            constexpr int waiters_count{4};
+            std::atomic<int> released{0};
+            std::vector<std::thread> waiters;
+            for (int i = 0; i < waiters_count; ++i) {
+                waiters.emplace_back([&manual, &released]() {
+                    AC_CODDING_ERROR_IF_NOT(WAIT_OBJECT_0 == manual.wait());
+                    released.fetch_add(1);
+                });
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds{20});
+            AC_CODDING_ERROR_IF_NOT(0 == released.load());
+            manual.set();
+            for (auto &t : waiters) {
+                t.join();
+            }
+            AC_CODDING_ERROR_IF_NOT(waiters_count == released.load());
+            waiters.clear();
+            released = 0;
+            //
+            // Each set releases one waiter of auto reset event
+            //
+            for (int i = 0; i < waiters_count; ++i) {
+                waiters.emplace_back([&automatic, &released]() {
+                    AC_CODDING_ERROR_IF_NOT(WAIT_OBJECT_0 == automatic.wait());
+                    released.fetch_add(1);
+                });
+            }
+            while (released.load() < waiters_count) {
+                automatic.set();
+                std::this_thread::sleep_for(std::chrono::milliseconds{1});
+            }
+            for (auto &t : waiters) {
+                t.join();
+            }
+            automatic.reset();
+        });
+
+#if AC_PLATFORM_LINUX
+        for_each_kernel_object_kind([](auto kind, char const *kind_name) {
+            printf("---- test_event pulse %s\n", kind_name);
+            //
+            // Pulse releases threads that wait, and leaves event
+            // unsignaled
+            //
+            ac::event pulsed{make_event(kind, ac::event::manuel)};
+            for (int round = 0; round < 8; ++round) {
+                std::atomic<int> released{0};
+                std::vector<std::thread> waiters;
+                for (int i = 0; i < 2; ++i) {
+                    waiters.emplace_back([&pulsed, &released]() {
+                        AC_CODDING_ERROR_IF_NOT(WAIT_OBJECT_0 == pulsed.wait(5000));
+                        released.fetch_add(1);
+                    });
+                }
+                std::this_thread::sleep_for(std::chrono::milliseconds{50});
+                pulsed.pulse();
+                for (auto &t : waiters) {
+                    t.join();
+                }
+                AC_CODDING_ERROR_IF_NOT(2 == released.load());
+                AC_CODDING_ERROR_IF_NOT(WAIT_TIMEOUT == pulsed.wait(0));
+            }
+            //
+            // Pulse of auto reset event releases one of the waiters
+            //
+            ac::event pulsed_automatic{make_event(kind, ac::event::automatic)};
+            constexpr int pulse_waiters_count{4};
+            std::atomic<int> pulse_released{0};
+            std::vector<std::thread> pulse_waiters;
+            for (int i = 0; i < pulse_waiters_count; ++i) {
+                pulse_waiters.emplace_back([&pulsed_automatic, &pulse_released]() {
+                    AC_CODDING_ERROR_IF_NOT(WAIT_OBJECT_0 == pulsed_automatic.wait());
+                    pulse_released.fetch_add(1);
+                });
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds{50});
+            for (int pulses = 1; pulse_released.load() < pulse_waiters_count; ++pulses) {
+                pulsed_automatic.pulse();
+                std::this_thread::sleep_for(std::chrono::milliseconds{20});
+                AC_CODDING_ERROR_IF(pulses < pulse_released.load());
+            }
+            for (auto &t : pulse_waiters) {
+                t.join();
+            }
+            AC_CODDING_ERROR_IF_NOT(WAIT_TIMEOUT == pulsed_automatic.wait(0));
+        });
+#endif
+    } catch (std::exception const &ex) {
+        printf("---- test_event failed %s\n", ex.what());
+    }
+    printf("---- test_event complete\n");
+}
+
+void test_semaphore() {
+    printf("\n---- test_semaphore started\n");
+
+    try {
+        for_each_kernel_object_kind([](auto kind, char const *kind_name) {
+            printf("---- test_semaphore %s\n", kind_name);
+
+            ac::semaphore semaphore{make_semaphore(kind, 2, 3)};
+            AC_CODDING_ERROR_IF_NOT(WAIT_OBJECT_0 == semaphore.wait(0));
+            AC_CODDING_ERROR_IF_NOT(WAIT_OBJECT_0 == semaphore.wait(0));
+            AC_CODDING_ERROR_IF_NOT(WAIT_TIMEOUT == semaphore.wait(0));
+            long previous_count{-1};
+            AC_CODDING_ERROR_IF_NOT(semaphore.release(3, &previous_count));
+            AC_CODDING_ERROR_IF_NOT(0 == previous_count);
+            for (int i = 0; i < 3; ++i) {
+                AC_CODDING_ERROR_IF_NOT(WAIT_OBJECT_0 == semaphore.wait(0));
+            }
+            AC_CODDING_ERROR_IF_NOT(WAIT_TIMEOUT == semaphore.wait(10));
+
+            constexpr int consumers_count{4};
+            constexpr int waits_per_consumer{1000};
+            ac::semaphore items{make_semaphore(kind, 0, consumers_count * waits_per_consumer)};
+            std::atomic<int> consumed{0};
+            std::vector<std::thread> consumers;
+            for (int i = 0; i < consumers_count; ++i) {
+                consumers.emplace_back([&items, &consumed]() {
+                    for (int j = 0; j < waits_per_consumer; ++j) {
+                        AC_CODDING_ERROR_IF_NOT(WAIT_OBJECT_0 == items.wait());
+                        consumed.fetch_add(1);
+                    }
+                });
+            }
+            for (int i = 0; i < consumers_count * waits_per_consumer; i += 10) {
+                items.release(10);
+                if (0 == (i % 1000)) {
+                    std::this_thread::sleep_for(std::chrono::milliseconds{1});
+                }
+            }
+            for (auto &t : consumers) {
+                t.join();
+            }
+            AC_CODDING_ERROR_IF_NOT(consumers_count * waits_per_consumer == consumed.load());
+            AC_CODDING_ERROR_IF_NOT(WAIT_TIMEOUT == items.wait(0));
+        });
+    } catch (std::exception const &ex) {
+        printf("---- test_semaphore failed %s\n", ex.what());
+    }
+    printf("---- test_semaphore complete\n");
+}
+
+void test_mutex() {
+    printf("\n---- test_mutex started\n");
+
+    try {
+        for_each_kernel_object_kind([](auto kind, char const *kind_name) {
+            printf("---- test_mutex %s\n", kind_name);
+
+            ac::mutex mutex{make_mutex(kind)};
+            //
+            // Owner can acquire mutex recursively, others cannot
+            //
+            AC_CODDING_ERROR_IF_NOT(WAIT_OBJECT_0 == mutex.wait(0));
+            AC_CODDING_ERROR_IF_NOT(WAIT_OBJECT_0 == mutex.wait(0));
+            std::thread{[&mutex]() {
+                AC_CODDING_ERROR_IF_NOT(WAIT_TIMEOUT == mutex.wait(10));
+            }}.join();
+            mutex.release();
+            std::thread{[&mutex]() {
+                AC_CODDING_ERROR_IF_NOT(WAIT_TIMEOUT == mutex.wait(0));
+            }}.join();
+            mutex.release();
+
+            ac::mutex owned{make_mutex(kind, true)};
+            std::thread{[&owned]() {
+                AC_CODDING_ERROR_IF_NOT(WAIT_TIMEOUT == owned.wait(0));
+            }}.join();
+            owned.release();
+
+            constexpr int threads_count{4};
+            constexpr int iterations_count{10000};
+            long long counter{0};
+            std::vector<std::thread> threads;
+            for (int i = 0; i < threads_count; ++i) {
+                threads.emplace_back([&mutex, &counter]() {
+                    for (int j = 0; j < iterations_count; ++j) {
+                        AC_CODDING_ERROR_IF_NOT(WAIT_OBJECT_0 == mutex.wait());
+                        ++counter;
+                        mutex.release();
+                    }
+                });
+            }
+            for (auto &t : threads) {
+                t.join();
+            }
+            AC_CODDING_ERROR_IF_NOT(threads_count * iterations_count == counter);
+            //
+            // Thread exits without releasing the mutex
+            //
+            std::thread{[&mutex]() {
+                AC_CODDING_ERROR_IF_NOT(WAIT_OBJECT_0 == mutex.wait());
+            }}.join();
+            AC_CODDING_ERROR_IF_NOT(WAIT_ABANDONED_0 == mutex.wait());
+            mutex.release();
+            AC_CODDING_ERROR_IF_NOT(WAIT_OBJECT_0 == mutex.wait(0));
+            mutex.release();
+        });
+    } catch (std::exception const &ex) {
+        printf("---- test_mutex failed %s\n", ex.what());
+    }
+    printf("---- test_mutex complete\n");
+}
+
+void test_wait_multiple_objects() {
+    printf("\n---- test_wait_multiple_objects started\n");
+
+    try {
+#if AC_PLATFORM_LINUX
+        constexpr ac::kernel_object_kind kind{ac::kernel_object_kind::pollable};
+#else
+        constexpr int kind{0};
+#endif
+        ac::event events[3]{make_event(kind, ac::event::automatic),
+                            make_event(kind, ac::event::automatic),
+                            make_event(kind, ac::event::automatic)};
+        HANDLE handles[3]{events[0].get_handle(), events[1].get_handle(), events[2].get_handle()};
+        //
+        // Wait for any object returns the lowest signaled index
+        //
+        AC_CODDING_ERROR_IF_NOT(WAIT_TIMEOUT == ac::wait_multiple_objects(handles, 0));
+        events[2].set();
+        AC_CODDING_ERROR_IF_NOT(2 == ac::wait_result_to_idx(ac::wait_multiple_objects(handles, 0)));
+        events[1].set();
+        events[2].set();
+        AC_CODDING_ERROR_IF_NOT(1 == ac::wait_result_to_idx(ac::wait_multiple_objects(handles, 0)));
+        AC_CODDING_ERROR_IF_NOT(2 == ac::wait_result_to_idx(ac::wait_multiple_objects(handles, 0)));
+        AC_CODDING_ERROR_IF_NOT(WAIT_TIMEOUT == ac::wait_multiple_objects(handles, 10));
+
+        std::thread setter{[&events]() {
+            std::this_thread::sleep_for(std::chrono::milliseconds{20});
+            events[1].set();
+        }};
+        AC_CODDING_ERROR_IF_NOT(WAIT_OBJECT_0 + 1 == ac::wait_multiple_objects(handles));
+        setter.join();
+        //
+        // Wait for all objects takes nothing until it can take all
+        //
+        ac::event manual{make_event(kind, ac::event::manuel)};
+        ac::semaphore semaphore{make_semaphore(kind, 0, 10)};
+        ac::mutex mutex{make_mutex(kind)};
+        HANDLE all[3]{manual.get_handle(), semaphore.get_handle(), mutex.get_handle()};
+        manual.set();
+        AC_CODDING_ERROR_IF_NOT(WAIT_TIMEOUT == ac::wait_multiple_objects(all, 10, true));
+        std::thread{[&mutex]() {
+            AC_CODDING_ERROR_IF_NOT(WAIT_OBJECT_0 == mutex.wait(0));
+            mutex.release();
+        }}.join();
+
+        std::thread releaser{[&semaphore]() {
+            std::this_thread::sleep_for(std::chrono::milliseconds{20});
+            semaphore.release();
+        }};
+        AC_CODDING_ERROR_IF_NOT(WAIT_OBJECT_0 == ac::wait_multiple_objects(all, INFINITE, true));
+        releaser.join();
+        AC_CODDING_ERROR_IF_NOT(WAIT_TIMEOUT == semaphore.wait(0));
+        std::thread{[&mutex]() {
+            AC_CODDING_ERROR_IF_NOT(WAIT_TIMEOUT == mutex.wait(0));
+        }}.join();
+        mutex.release();
+        //
+        // Abandoned mutex is reported with its index
+        //
+        std::thread{[&mutex]() {
+            AC_CODDING_ERROR_IF_NOT(WAIT_OBJECT_0 == mutex.wait());
+        }}.join();
+        HANDLE with_mutex[2]{events[0].get_handle(), mutex.get_handle()};
+        AC_CODDING_ERROR_IF_NOT(WAIT_ABANDONED_0 + 1 == ac::wait_multiple_objects(with_mutex));
+        mutex.release();
+        //
+        // Owner acquires mutex recursively even though nothing in the
+        // set is readable
+        //
+        AC_CODDING_ERROR_IF_NOT(WAIT_OBJECT_0 + 1 == ac::wait_multiple_objects(with_mutex));
+        AC_CODDING_ERROR_IF_NOT(WAIT_OBJECT_0 + 1 == ac::wait_multiple_objects(with_mutex));
+        AC_CODDING_ERROR_IF_NOT(WAIT_OBJECT_0 + 1 == ac::wait_multiple_objects(with_mutex, 0));
+        std::thread{[&mutex]() {
+            AC_CODDING_ERROR_IF_NOT(WAIT_TIMEOUT == mutex.wait(0));
+        }}.join();
+        mutex.release();
+        mutex.release();
+        mutex.release();
+        std::thread{[&mutex]() {
+            AC_CODDING_ERROR_IF_NOT(WAIT_OBJECT_0 == mutex.wait(0));
+            mutex.release();
+        }}.join();
+
+        AC_CODDING_ERROR_IF_NOT(WAIT_OBJECT_0 == ac::signale_and_wait(events[0].get_handle(), events[0].get_handle(), 0));
+
+#if AC_PLATFORM_LINUX
+        //
+        // Set built once and waited on many times
+        //
+        ac::wait_set set{handles};
+        AC_CODDING_ERROR_IF_NOT(3 == set.size());
+        AC_CODDING_ERROR_IF_NOT(set.is_same(handles, 3));
+        constexpr DWORD waits_count{1000};
+        ac::event ack{make_event(kind, ac::event::automatic)};
+        std::thread producer{[&events, &ack]() {
+            for (DWORD i = 0; i < waits_count; ++i) {
+                events[i % 3].set();
+                AC_CODDING_ERROR_IF_NOT(WAIT_OBJECT_0 == ack.wait());
+            }
+        }};
+        for (DWORD i = 0; i < waits_count; ++i) {
+            AC_CODDING_ERROR_IF_NOT(WAIT_OBJECT_0 + (i % 3) == set.wait(1000));
+            ack.set();
+        }
+        producer.join();
+#endif
+    } catch (std::exception const &ex) {
+        printf("---- test_wait_multiple_objects failed %s\n", ex.what());
+    }
+    printf("---- test_wait_multiple_objects complete\n");
+}
+
+void test_slim_event() {
+    printf("\n---- test_slim_event started\n");
+
+    try {
+        static_assert(sizeof(ac::slim_event) == sizeof(uint32_t));
+
+        ac::slim_event manual{ac::slim_event::manuel};
+        AC_CODDING_ERROR_IF_NOT(manual.is_manual_reset());
+        AC_CODDING_ERROR_IF_NOT(WAIT_TIMEOUT == manual.wait(0));
+        manual.set();
+        AC_CODDING_ERROR_IF_NOT(WAIT_OBJECT_0 == manual.wait(0));
+        AC_CODDING_ERROR_IF_NOT(WAIT_OBJECT_0 == manual.wait(0));
+        manual.reset();
+        AC_CODDING_ERROR_IF(manual.is_set());
+
+        ac::slim_event automatic{ac::slim_event::automatic, ac::slim_event::signaled};
+        AC_CODDING_ERROR_IF(automatic.is_manual_reset());
+        AC_CODDING_ERROR_IF_NOT(WAIT_OBJECT_0 == automatic.wait(0));
+        AC_CODDING_ERROR_IF_NOT(WAIT_TIMEOUT == automatic.wait(0));
+        automatic.set();
+        automatic.set();
+        AC_CODDING_ERROR_IF_NOT(WAIT_OBJECT_0 == automatic.wait(0));
+        AC_CODDING_ERROR_IF_NOT(WAIT_TIMEOUT == automatic.wait(20));
+
+        constexpr int waiters_count{4};
+        std::atomic<int> released{0};
+        std::vector<std::thread> waiters;
+        for (int i = 0; i < waiters_count; ++i) {
+            waiters.emplace_back([&manual, &released]() {
+                AC_CODDING_ERROR_IF_NOT(WAIT_OBJECT_0 == manual.wait());
+                released.fetch_add(1);
+            });
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds{20});
+        AC_CODDING_ERROR_IF_NOT(0 == released.load());
+        manual.set();
+        for (auto &t : waiters) {
+            t.join();
+        }
+        AC_CODDING_ERROR_IF_NOT(waiters_count == released.load());
+        waiters.clear();
+        released = 0;
+
+        for (int i = 0; i < waiters_count; ++i) {
+            waiters.emplace_back([&automatic, &released]() {
+                AC_CODDING_ERROR_IF_NOT(WAIT_OBJECT_0 == automatic.wait());
+                released.fetch_add(1);
+            });
+        }
+        while (released.load() < waiters_count) {
+            automatic.set();
+            std::this_thread::sleep_for(std::chrono::milliseconds{1});
+        }
+        for (auto &t : waiters) {
+            t.join();
+        }
+        automatic.reset();
+        //
+        // Rundown waits on slim_event for the last reference
+        //
+        ac::rundown rundown;
+        ac::rundown_lock lock{&rundown};
+        std::thread holder{[lock = std::move(lock)]() mutable {
+            std::this_thread::sleep_for(std::chrono::milliseconds{20});
+            lock.release();
+        }};
+        rundown.join();
+        holder.join();
+        AC_CODDING_ERROR_IF_NOT(rundown.is_rundown_complete());
+        rundown.restart();
+        {
+            ac::rundown_lock relock{&rundown};
+            AC_CODDING_ERROR_IF_NOT(relock);
+        }
+    } catch (std::exception const &ex) {
+        printf("---- test_slim_event failed %s\n", ex.what());
+    }
+    printf("---- test_slim_event complete\n");
+}
+
+void perftest_slim_event() {
+    printf("\n---- perftest_slim_event started\n");
+
+    try {
+        constexpr int iterations_count{1000000};
+
+        auto const measure = [](auto &&f) {
+            auto const start{std::chrono::steady_clock::now()};
+            for (int i = 0; i < iterations_count; ++i) {
+                f();
+            }
+            return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() /
+                   iterations_count;
+        };
+
+        ac::slim_event slim{ac::slim_event::manuel};
+        double const slim_set_reset{measure([&slim]() {
+            slim.set();
+            slim.reset();
+        })};
+        ac::event kernel{ac::event::manuel, ac::event::unsignaled};
+        double const kernel_set_reset{measure([&kernel]() {
+            kernel.set();
+            kernel.reset();
+        })};
+        double const slim_construct{measure([]() {
+            ac::slim_event e{ac::slim_event::manuel};
+            static_cast<void>(e.is_set());
+        })};
+        double const kernel_construct{measure([]() {
+            ac::event e{ac::event::manuel, ac::event::unsignaled};
+        })};
+        printf("---- perftest_slim_event set and reset: slim_event %.1f ns, event %.1f ns\n",
+               slim_set_reset,
+               kernel_set_reset);
+        printf("---- perftest_slim_event create and destroy: slim_event %.1f ns, event %.1f ns\n",
+               slim_construct,
+               kernel_construct);
+    } catch (std::exception const &ex) {
+        printf("---- perftest_slim_event failed %s\n", ex.what());
+    }
+    printf("---- perftest_slim_event complete\n");
+}
+
+void test_shared_kernel_object() {
+    printf("\n---- test_shared_kernel_object started\n");
+
+    try {
+        for_each_kernel_object_kind([](auto kind, char const *kind_name) {
+            printf("---- test_shared_kernel_object %s\n", kind_name);
+            //
+            // Duplicate is a separate handle to the same object
+            //
+            ac::event original{make_event(kind, ac::event::manuel)};
+            ac::event duplicate{original.duplicate()};
+            AC_CODDING_ERROR_IF_NOT(duplicate.is_valid());
+            duplicate.set();
+            AC_CODDING_ERROR_IF_NOT(WAIT_OBJECT_0 == original.wait(0));
+            duplicate.close();
+            original.reset();
+            AC_CODDING_ERROR_IF_NOT(WAIT_TIMEOUT == original.wait(0));
+            AC_CODDING_ERROR_IF(ac::event{}.duplicate().is_valid());
+
+            ac::semaphore semaphore{make_semaphore(kind, 0, 2)};
+            ac::semaphore semaphore_duplicate{semaphore.duplicate()};
+            semaphore_duplicate.release();
+            AC_CODDING_ERROR_IF_NOT(WAIT_OBJECT_0 == semaphore.wait(0));
+
+            ac::mutex mutex{make_mutex(kind)};
+            ac::mutex mutex_duplicate{mutex.duplicate()};
+            AC_CODDING_ERROR_IF_NOT(WAIT_OBJECT_0 == mutex_duplicate.wait(0));
+            mutex.release();
+            //
+            // Copies of shared object use the same handle
+            //
+            ac::shared_kernel_object<ac::event> shared{make_event(kind, ac::event::automatic)};
+            AC_CODDING_ERROR_IF_NOT(1 == shared.use_count());
+            HANDLE const h{shared.get_handle()};
+            std::thread signaller{[copy = shared]() {
+                copy->set();
+            }};
+            AC_CODDING_ERROR_IF_NOT(WAIT_OBJECT_0 == shared.wait());
+            signaller.join();
+            AC_CODDING_ERROR_IF_NOT(1 == shared.use_count());
+
+            ac::shared_kernel_object<ac::event> copy{shared};
+            AC_CODDING_ERROR_IF_NOT(2 == shared.use_count());
+            AC_CODDING_ERROR_IF_NOT(h == copy.get_handle());
+            shared.reset();
+            AC_CODDING_ERROR_IF(shared);
+            AC_CODDING_ERROR_IF_NOT(1 == copy.use_count());
+            copy->set();
+            AC_CODDING_ERROR_IF_NOT(WAIT_OBJECT_0 == copy.wait(0));
+            AC_CODDING_ERROR_IF_NOT(WAIT_TIMEOUT == copy.wait(0));
+
+            ac::shared_kernel_object<ac::event> moved{std::move(copy)};
+            AC_CODDING_ERROR_IF(copy.is_valid());
+            AC_CODDING_ERROR_IF_NOT(h == moved.get_handle());
+        });
+
+        auto made{ac::make_shared_kernel_object<ac::event>(ac::event::manuel, ac::event::signaled)};
+        auto made_copy{made};
+        AC_CODDING_ERROR_IF_NOT(WAIT_OBJECT_0 == made_copy.wait(0));
+    } catch (std::exception const &ex) {
+        printf("---- test_shared_kernel_object failed %s\n", ex.what());
+    }
+    printf("---- test_shared_kernel_object complete\n");
+}
+
+void perftest_shared_kernel_object() {
+    printf("\n---- perftest_shared_kernel_object started\n");
+
+    try {
+        constexpr int iterations_count{1000000};
+
+        auto const measure = [](auto &&f) {
+            auto const start{std::chrono::steady_clock::now()};
+            for (int i = 0; i < iterations_count; ++i) {
+                f();
+            }
+            return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() /
+                   iterations_count;
+        };
+
+        auto shared{ac::make_shared_kernel_object<ac::event>(ac::event::manuel, ac::event::unsignaled)};
+        double const shared_copy{measure([&shared]() {
+            ac::shared_kernel_object<ac::event> copy{shared};
+            static_cast<void>(copy.get_handle());
+        })};
+        double const duplicate{measure([&shared]() {
+            ac::event copy{shared->duplicate()};
+        })};
+        printf("---- perftest_shared_kernel_object copy and destroy: shared_kernel_object %.1f ns, duplicate %.1f ns\n",
+               shared_copy,
+               duplicate);
+    } catch (std::exception const &ex) {
+        printf("---- perftest_shared_kernel_object failed %s\n", ex.what());
+    }
+    printf("---- perftest_shared_kernel_object complete\n");
+}
@@ -0,0 +1,20 @@
+#ifndef _AC_HELPERS_WIN32_LIBRARY_TEST_KERNEL_OBJECT_HEADER_
+#define _AC_HELPERS_WIN32_LIBRARY_TEST_KERNEL_OBJECT_HEADER_
+
+void test_event();
+
+void test_semaphore();
+
+void test_mutex();
+
+void test_wait_multiple_objects();
+
+void test_slim_event();
+
+void perftest_slim_event();
+
+void test_shared_kernel_object();
+
+void perftest_shared_kernel_object();
+
+#endif //_AC_HELPERS_WIN32_LIBRARY_TEST_KERNEL_OBJECT_HEADER_
@@ -0,0 +1,805 @@
+#include "ac_test_locks.h"
+
+#include <stdlib.h>
+#include <stdio.h>
+
+#include <thread>
+#include <vector>
+#include <shared_mutex>
+#include <mutex>
+#include <algorithm>
+
+#include "..\acparkinglot.h"
+#include "..\acrundown.h"
+#include "..\acresourceowner.h"
+#include "..\aclockprofiler.h"
+#include "..\acmutex.h"
+#include "..\acseqlock.h"
+
+namespace {
+
+    void wait_for_parked(void const volatile *address, size_t count) {
+        //
+        // There is no way to ask how many threads are parked, so
+        // keep unparking nobody until filter has seen all of them
+        //
+        for (;;) {
+            size_t seen{0};
+            ac::parking_lot::unpark_filter(address, [&seen](uintptr_t) noexcept {
+                ++seen;
+                return ac::unpark_filter_result::skip;
+            });
+            if (seen == count) {
+                break;
+            }
+            std::this_thread::yield();
+        }
+    }
+
+    //
+    // Exclusive lock whose try acquire takes number of attempts
+    //
+    class spin_lock {
+    public:
+        void acquire_exclusive() noexcept {
+            while (!try_acquire_exclusive()) {
+                std::this_thread::yield();
+            }
+        }
+
+        [[nodiscard]] bool try_acquire_exclusive() noexcept {
+            return !locked_.exchange(true, std::memory_order_acquire);
+        }
+
+        [[nodiscard]] bool try_acquire_exclusive(int attempts) noexcept {
+            for (int i = 0; i < attempts; ++i) {
+                if (try_acquire_exclusive()) {
+                    return true;
+                }
+                std::this_thread::yield();
+            }
+            return false;
+        }
+
+        void release_exclusive() noexcept {
+            locked_.store(false, std::memory_order_release);
+        }
+
+    private:
+        std::atomic<bool> locked_{false};
+    };
+
+} // namespace
+
+void test_parking_lot() {
+    printf("\n---- test_parking_lot started\n");
+
+    try {
+        constexpr int threads_count{8};
+
+        std::atomic<uint8_t> state{0};
+        //
+        // Validation fails so thread must not park
+        //
+        AC_CODDING_ERROR_IF_NOT(ac::park_result::invalid ==
+                                ac::parking_lot::park(&state, []() noexcept { return false; }));
+        //
+        // Nobody unparks us so park must time out
+        //
+        AC_CODDING_ERROR_IF_NOT(ac::park_result::timed_out ==
+                                ac::parking_lot::park(&state, []() noexcept { return true; }, 10));
+
+        std::atomic<int> handoffs{0};
+        std::atomic<int> unparked{0};
+        std::vector<std::thread> threads;
+        for (int i = 0; i < threads_count; ++i) {
+            threads.emplace_back([&state, &handoffs, &unparked, i]() {
+                uintptr_t token{0};
+                ac::park_result const result{ac::parking_lot::park(
+                    &state,
+                    [&state]() noexcept { return 0 == state.load(); },
+                    INFINITE,
+                    static_cast<uintptr_t>(i),
+                    &token)};
+                AC_CODDING_ERROR_IF_NOT(ac::park_result::unparked == result);
+                if (42 == token) {
+                    handoffs.fetch_add(1);
+                }
+                unparked.fetch_add(1);
+            });
+        }
+
+        wait_for_parked(&state, threads_count);
+        //
+        // Wake up one thread and hand off a token to it
+        //
+        ac::unpark_result const one{ac::parking_lot::unpark_one(&state, [](ac::unpark_result result) noexcept {
+            AC_CODDING_ERROR_IF_NOT(1 == result.unparked_count && result.have_more);
+            return uintptr_t{42};
+        })};
+        AC_CODDING_ERROR_IF_NOT(1 == one.unparked_count);
+        wait_for_parked(&state, threads_count - 1);
+        //
+        // Wake up threads that parked with an odd token
+        //
+        ac::unpark_result const odd{ac::parking_lot::unpark_filter(&state, [](uintptr_t token) noexcept {
+            return (token % 2) ? ac::unpark_filter_result::unpark : ac::unpark_filter_result::skip;
+        })};
+        wait_for_parked(&state, threads_count - 1 - odd.unparked_count);
+
+        state = 1;
+        ac::parking_lot::unpark_all(&state);
+
+        for (auto &t : threads) {
+            t.join();
+        }
+
+        AC_CODDING_ERROR_IF_NOT(1 == handoffs.load());
+        AC_CODDING_ERROR_IF_NOT(threads_count == unparked.load());
+        //
+        // Several joiners wait for the same rundown, and are
+        // woken up one after another when it completes
+        //
+        ac::slim_rundown rundown;
+        ac::slim_rundown_lock lock{&rundown};
+        std::vector<std::thread> joiners;
+        for (int i = 0; i < threads_count; ++i) {
+            joiners.emplace_back([&rundown]() {
+                rundown.join();
+                AC_CODDING_ERROR_IF_NOT(rundown.is_rundown_complete());
+            });
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds{100});
+        lock.release();
+        for (auto &t : joiners) {
+            t.join();
+        }
+    } catch (std::exception const &ex) {
+        printf("---- test_parking_lot failed %s\n", ex.what());
+    }
+    printf("---- test_parking_lot complete\n");
+}
+
+namespace {
+
+    //
+    // Two counters that writers keep equal, so a reader that sees
+    // them different has run concurrently with a writer
+    //
+    struct lock_test_data {
+        long long first{0};
+        long long second{0};
+    };
+
+    template<typename L>
+    void lock_stress(L &lock, lock_test_data &data, int threads_count, int iterations_count) {
+        std::vector<std::thread> threads;
+        for (int i = 0; i < threads_count; ++i) {
+            threads.emplace_back([&lock, &data, iterations_count, i]() {
+                for (int j = 0; j < iterations_count; ++j) {
+                    if (0 == (i + j) % 4) {
+                        lock.acquire_exclusive();
+                        ++data.first;
+                        ++data.second;
+                        lock.release_exclusive();
+                    } else {
+                        lock.acquire_shared();
+                        AC_CODDING_ERROR_IF_NOT(data.first == data.second);
+                        lock.release_shared();
+                    }
+                }
+            });
+        }
+        for (auto &t : threads) {
+            t.join();
+        }
+    }
+
+    //
+    // std::shared_mutex with the same interface as srw_lock
+    //
+    class std_shared_mutex_adapter {
+    public:
+        void acquire_exclusive() {
+            lock_.lock();
+        }
+
+        void release_exclusive() {
+            lock_.unlock();
+        }
+
+        void acquire_shared() {
+            lock_.lock_shared();
+        }
+
+        void release_shared() {
+            lock_.unlock_shared();
+        }
+
+    private:
+        std::shared_mutex lock_;
+    };
+
+    template<typename L>
+    double lock_throughput(int threads_count, int reads_per_write, std::chrono::milliseconds duration) {
+        L lock;
+        lock_test_data data;
+        std::atomic<bool> done{false};
+        std::atomic<long long> operations{0};
+        std::vector<std::thread> threads;
+        for (int i = 0; i < threads_count; ++i) {
+            threads.emplace_back([&lock, &data, &done, &operations, reads_per_write]() {
+                long long local_operations{0};
+                long long sum{0};
+                while (!done.load(std::memory_order_relaxed)) {
+                    if (0 == local_operations % (reads_per_write + 1)) {
+                        lock.acquire_exclusive();
+                        ++data.first;
+                        ++data.second;
+                        lock.release_exclusive();
+                    } else {
+                        lock.acquire_shared();
+                        sum += data.first;
+                        lock.release_shared();
+                    }
+                    ++local_operations;
+                }
+                AC_CODDING_ERROR_IF(sum < 0);
+                operations.fetch_add(local_operations);
+            });
+        }
+        std::this_thread::sleep_for(duration);
+        done = true;
+        for (auto &t : threads) {
+            t.join();
+        }
+        return static_cast<double>(operations.load()) * 1000.0 / static_cast<double>(duration.count());
+    }
+
+} // namespace
+
+void test_srw_lock() {
+    printf("\n---- test_srw_lock started\n");
+
+    try {
+        constexpr int threads_count{8};
+        constexpr int iterations_count{100000};
+
+        ac::srw_lock lock;
+        {
+            ac::srw_lock::exclusive_lock_guard exclusive{&lock};
+            AC_CODDING_ERROR_IF(lock.try_acquire_shared());
+            AC_CODDING_ERROR_IF(lock.try_acquire_exclusive());
+            {
+                ac::srw_lock::anti_exclusive_lock_guard unlocked{&lock};
+                AC_CODDING_ERROR_IF_NOT(lock.try_acquire_shared());
+                AC_CODDING_ERROR_IF_NOT(lock.try_acquire_shared());
+                AC_CODDING_ERROR_IF(lock.try_acquire_exclusive());
+                lock.release_shared();
+                lock.release_shared();
+            }
+        }
+        {
+            ac::srw_lock::shared_lock_guard shared{&lock};
+            ac::srw_lock::shared_lock_guard shared2{&lock};
+            AC_CODDING_ERROR_IF(lock.try_acquire_exclusive());
+        }
+
+        lock_test_data data;
+        lock_stress(lock, data, threads_count, iterations_count);
+        AC_CODDING_ERROR_IF_NOT(data.first == data.second);
+        AC_CODDING_ERROR_IF_NOT(threads_count * iterations_count / 4 == data.first);
+
+        ac::rw_lock checked_lock;
+        {
+            ac::rw_lock::exclusive_lock_guard exclusive{&checked_lock};
+            AC_CODDING_ERROR_IF_NOT(checked_lock.i_have_lock());
+        }
+        AC_CODDING_ERROR_IF(checked_lock.i_have_lock());
+        lock_test_data checked_data;
+        lock_stress(checked_lock, checked_data, threads_count, iterations_count / 10);
+        AC_CODDING_ERROR_IF_NOT(checked_data.first == checked_data.second);
+    } catch (std::exception const &ex) {
+        printf("---- test_srw_lock failed %s\n", ex.what());
+    }
+    printf("---- test_srw_lock complete\n");
+}
+
+void perftest_srw_lock() {
+    printf("\n---- perftest_srw_lock started\n");
+
+    try {
+        constexpr std::chrono::milliseconds duration{1000};
+        int const threads_count{static_cast<int>((std::max)(4U, std::thread::hardware_concurrency()))};
+
+        for (int reads_per_write : {1, 10, 100}) {
+            double const srw{lock_throughput<ac::srw_lock>(threads_count, reads_per_write, duration)};
+            double const std_mutex{
+                lock_throughput<std_shared_mutex_adapter>(threads_count, reads_per_write, duration)};
+            printf("---- perftest_srw_lock %i threads, %i:1 reads:writes, srw_lock %.0f ops/sec, std::shared_mutex %.0f ops/sec, %.2fx\n",
+                   threads_count,
+                   reads_per_write,
+                   srw,
+                   std_mutex,
+                   srw / std_mutex);
+        }
+    } catch (std::exception const &ex) {
+        printf("---- perftest_srw_lock failed %s\n", ex.what());
+    }
+    printf("---- perftest_srw_lock complete\n");
+}
+
+void test_bravo_lock() {
+    printf("\n---- test_bravo_lock started\n");
+
+    try {
+        constexpr int threads_count{8};
+        constexpr int iterations_count{100000};
+
+        ac::bravo_lock<> lock;
+        AC_CODDING_ERROR_IF_NOT(lock.is_reader_biased());
+        {
+            //
+            // Nested shared acquire on the fast path
+            //
+            ac::bravo_lock<>::shared_lock_guard shared{&lock};
+            ac::bravo_lock<>::shared_lock_guard shared2{&lock};
+            AC_CODDING_ERROR_IF(lock.try_acquire_exclusive());
+        }
+        {
+            ac::bravo_lock<>::exclusive_lock_guard exclusive{&lock};
+            AC_CODDING_ERROR_IF(lock.is_reader_biased());
+            AC_CODDING_ERROR_IF(lock.try_acquire_shared());
+        }
+
+        lock_test_data data;
+        lock_stress(lock, data, threads_count, iterations_count);
+        AC_CODDING_ERROR_IF_NOT(data.first == data.second);
+        AC_CODDING_ERROR_IF_NOT(threads_count * iterations_count / 4 == data.first);
+        //
+        // Bias comes back once writes stop
+        //
+        std::this_thread::sleep_for(std::chrono::milliseconds{10});
+        {
+            ac::bravo_lock<>::shared_lock_guard shared{&lock};
+        }
+        AC_CODDING_ERROR_IF_NOT(lock.is_reader_biased());
+    } catch (std::exception const &ex) {
+        printf("---- test_bravo_lock failed %s\n", ex.what());
+    }
+    printf("---- test_bravo_lock complete\n");
+}
+
+void perftest_bravo_lock() {
+    printf("\n---- perftest_bravo_lock started\n");
+
+    try {
+        constexpr std::chrono::milliseconds duration{1000};
+        int const max_threads_count{static_cast<int>((std::max)(4U, std::thread::hardware_concurrency()))};
+
+        for (int threads_count = 1; threads_count <= max_threads_count; threads_count *= 2) {
+            for (int reads_per_write : {100, 10000}) {
+                double const srw{lock_throughput<ac::srw_lock>(threads_count, reads_per_write, duration)};
+                double const bravo{
+                    lock_throughput<ac::bravo_lock<>>(threads_count, reads_per_write, duration)};
+                printf("---- perftest_bravo_lock %i threads, %i:1 reads:writes, srw_lock %.0f ops/sec, bravo_lock %.0f ops/sec, %.2fx\n",
+                       threads_count,
+                       reads_per_write,
+                       srw,
+                       bravo,
+                       bravo / srw);
+            }
+        }
+    } catch (std::exception const &ex) {
+        printf("---- perftest_bravo_lock failed %s\n", ex.what());
+    }
+    printf("---- perftest_bravo_lock complete\n");
+}
+
+void test_condition_variable() {
+    printf("\n---- test_condition_variable started\n");
+
+    try {
+        constexpr int consumers_count{8};
+        constexpr int items_count{100000};
+
+        ac::srw_lock lock;
+        ac::condition_variable cv;
+        //
+        // Nobody notifies so wait must time out
+        //
+        {
+            ac::srw_lock::exclusive_lock_guard guard{&lock};
+            AC_CODDING_ERROR_IF(cv.try_wait_exclusive(lock, []() { return false; }, 10));
+        }
+        {
+            ac::srw_lock::shared_lock_guard guard{&lock};
+            AC_CODDING_ERROR_IF(cv.try_wait_shared(lock, []() { return false; }, 10));
+        }
+        //
+        // Producer and consumers waiting exclusive
+        //
+        std::vector<int> queue;
+        bool done{false};
+        long long consumed{0};
+        std::vector<std::thread> consumers;
+        for (int i = 0; i < consumers_count; ++i) {
+            consumers.emplace_back([&]() {
+                ac::srw_lock::exclusive_lock_guard guard{&lock};
+                for (;;) {
+                    cv.wait_exclusive(lock, [&]() { return !queue.empty() || done; });
+                    if (queue.empty()) {
+                        break;
+                    }
+                    consumed += queue.back();
+                    queue.pop_back();
+                }
+            });
+        }
+        for (int i = 1; i <= items_count; ++i) {
+            {
+                ac::srw_lock::exclusive_lock_guard guard{&lock};
+                queue.push_back(i);
+            }
+            if (0 == i % 1000) {
+                cv.notify_all();
+            } else {
+                cv.notify_one();
+            }
+        }
+        {
+            ac::srw_lock::exclusive_lock_guard guard{&lock};
+            done = true;
+        }
+        cv.notify_all();
+        for (auto &t : consumers) {
+            t.join();
+        }
+        AC_CODDING_ERROR_IF_NOT(static_cast<long long>(items_count) * (items_count + 1) / 2 == consumed);
+        //
+        // Readers waiting shared on a checked lock for a generation
+        // to change
+        //
+        ac::rw_lock checked_lock;
+        int generation{0};
+        std::atomic<int> observed{0};
+        std::vector<std::thread> readers;
+        for (int i = 0; i < consumers_count; ++i) {
+            readers.emplace_back([&]() {
+                ac::rw_lock::shared_lock_guard guard{&checked_lock};
+                cv.wait_shared(checked_lock, [&]() { return 0 != generation; });
+                observed.fetch_add(1);
+            });
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds{50});
+        {
+            ac::rw_lock::exclusive_lock_guard guard{&checked_lock};
+            generation = 1;
+        }
+        cv.notify_all();
+        for (auto &t : readers) {
+            t.join();
+        }
+        AC_CODDING_ERROR_IF_NOT(consumers_count == observed.load());
+    } catch (std::exception const &ex) {
+        printf("---- test_condition_variable failed %s\n", ex.what());
+    }
+    printf("---- test_condition_variable complete\n");
+}
+
+void test_lock_profiler() {
+    printf("\n---- test_lock_profiler started\n");
+
+    try {
+        constexpr int threads_count{4};
+        constexpr int iterations_count{10000};
+
+        using contended_guard = ac::profiled_exclusive_lock_guard<ac::srw_lock>;
+        using quiet_guard = ac::profiled_shared_lock_guard<ac::srw_lock>;
+
+        ac::srw_lock contended_lock;
+        ac::srw_lock quiet_lock;
+        ac::lock_profiler &profiler{ac::lock_profiler::instance()};
+        {
+            //
+            // Profile is created by the first acquire
+            //
+            contended_guard contended{&contended_lock};
+            quiet_guard quiet{&quiet_lock};
+        }
+        profiler.reset();
+        profiler.name_lock(&contended_lock, "contended_lock");
+        profiler.name_lock(&quiet_lock, "quiet_lock");
+
+        long long counter{0};
+        std::vector<std::thread> threads;
+        for (int i = 0; i < threads_count; ++i) {
+            threads.emplace_back([&]() {
+                for (int j = 0; j < iterations_count; ++j) {
+                    {
+                        quiet_guard quiet{&quiet_lock};
+                    }
+                    contended_guard contended{&contended_lock};
+                    for (int k = 0; k < 100; ++k) {
+                        ++counter;
+                    }
+                    if (0 == j % 1000) {
+                        std::this_thread::sleep_for(std::chrono::milliseconds{1});
+                    }
+                }
+            });
+        }
+        for (auto &t : threads) {
+            t.join();
+        }
+        AC_CODDING_ERROR_IF_NOT(100LL * threads_count * iterations_count == counter);
+
+        std::vector<ac::lock_profile_snapshot> const top{profiler.top_contended(2)};
+        AC_CODDING_ERROR_IF_NOT(2 <= top.size());
+        for (ac::lock_profile_snapshot const &s : top) {
+            AC_CODDING_ERROR_IF_NOT(s.lock == &contended_lock || s.lock == &quiet_lock);
+            AC_CODDING_ERROR_IF_NOT(threads_count * iterations_count == s.acquires);
+        }
+        AC_CODDING_ERROR_IF_NOT(&contended_lock == top[0].lock);
+        AC_CODDING_ERROR_IF_NOT(0 < top[0].contended_acquires);
+        AC_CODDING_ERROR_IF_NOT(top[0].max_hold_ns >= 1'000'000);
+        AC_CODDING_ERROR_IF_NOT(0 == top[1].contended_acquires);
+        //
+        // Try acquire that takes parameters is recorded like the
+        // plain one
+        //
+        spin_lock spinning_lock;
+        ac::lock_profile *spinning_profile{profiler.find(&spinning_lock)};
+        AC_CODDING_ERROR_IF_NOT(spinning_profile);
+        {
+            ac::profiled_exclusive_lock_guard<spin_lock> guard{&spinning_lock, 10};
+            AC_CODDING_ERROR_IF_NOT(guard);
+            ac::profiled_exclusive_lock_guard<spin_lock> other{nullptr};
+            AC_CODDING_ERROR_IF(other.try_acquire(&spinning_lock, 10));
+        }
+        AC_CODDING_ERROR_IF_NOT(1 == spinning_profile->acquires.load());
+        AC_CODDING_ERROR_IF_NOT(0 == ac::details::current_lock_hold_stack().size);
+
+        profiler.dump_report(stdout, 2);
+    } catch (std::exception const &ex) {
+        printf("---- test_lock_profiler failed %s\n", ex.what());
+    }
+    printf("---- test_lock_profiler complete\n");
+}
+
+namespace {
+
+    template<typename M>
+    void fast_mutex_stress(M &lock, long long &counter, int threads_count, int iterations_count) {
+        std::vector<std::thread> threads;
+        for (int i = 0; i < threads_count; ++i) {
+            threads.emplace_back([&lock, &counter, iterations_count]() {
+                for (int j = 0; j < iterations_count; ++j) {
+                    typename M::guard guard{&lock};
+                    ++counter;
+                }
+            });
+        }
+        for (auto &t : threads) {
+            t.join();
+        }
+    }
+
+    //
+    // std::mutex with the same interface as fast_mutex
+    //
+    class std_mutex_adapter {
+    public:
+        using guard = ac::resource_owner<std_mutex_adapter>;
+
+        void acquire() {
+            lock_.lock();
+        }
+
+        [[nodiscard]] bool try_acquire() {
+            return lock_.try_lock();
+        }
+
+        void release() {
+            lock_.unlock();
+        }
+
+    private:
+        std::mutex lock_;
+    };
+
+    template<typename M, typename... A>
+    double mutex_throughput(int threads_count, std::chrono::milliseconds duration, A &&...args) {
+        M lock{std::forward<A>(args)...};
+        long long counter{0};
+        std::atomic<bool> done{false};
+        std::atomic<long long> operations{0};
+        std::vector<std::thread> threads;
+        for (int i = 0; i < threads_count; ++i) {
+            threads.emplace_back([&lock, &counter, &done, &operations]() {
+                long long local_operations{0};
+                while (!done.load(std::memory_order_relaxed)) {
+                    typename M::guard guard{&lock};
+                    ++counter;
+                    ++local_operations;
+                }
+                operations.fetch_add(local_operations);
+            });
+        }
+        std::this_thread::sleep_for(duration);
+        done = true;
+        for (auto &t : threads) {
+            t.join();
+        }
+        AC_CODDING_ERROR_IF_NOT(counter == operations.load());
+        return static_cast<double>(operations.load()) * 1000.0 / static_cast<double>(duration.count());
+    }
+
+} // namespace
+
+void test_fast_mutex() {
+    printf("\n---- test_fast_mutex started\n");
+
+    try {
+        constexpr int threads_count{8};
+        constexpr int iterations_count{100000};
+
+        for (ac::fast_mutex_policy policy :
+             {ac::fast_mutex_policy::barging, ac::fast_mutex_policy::fair_handoff}) {
+            ac::fast_mutex lock{policy};
+            {
+                ac::fast_mutex::guard guard{&lock};
+                AC_CODDING_ERROR_IF_NOT(lock.is_locked());
+                AC_CODDING_ERROR_IF(lock.try_acquire());
+            }
+            AC_CODDING_ERROR_IF(lock.is_locked());
+
+            long long counter{0};
+            fast_mutex_stress(lock, counter, threads_count, iterations_count);
+            AC_CODDING_ERROR_IF_NOT(static_cast<long long>(threads_count) * iterations_count == counter);
+            AC_CODDING_ERROR_IF(lock.is_locked());
+        }
+        //
+        // Waiter that parked while lock was held for long
+        //
+        ac::fast_mutex lock{ac::fast_mutex_policy::fair_handoff};
+        ac::fast_mutex::guard held{&lock};
+        std::thread waiter{[&lock]() {
+            ac::fast_mutex::guard guard{&lock};
+        }};
+        std::this_thread::sleep_for(std::chrono::milliseconds{50});
+        held.release();
+        waiter.join();
+        AC_CODDING_ERROR_IF(lock.is_locked());
+    } catch (std::exception const &ex) {
+        printf("---- test_fast_mutex failed %s\n", ex.what());
+    }
+    printf("---- test_fast_mutex complete\n");
+}
+
+void perftest_fast_mutex() {
+    printf("\n---- perftest_fast_mutex started\n");
+
+    try {
+        constexpr std::chrono::milliseconds duration{1000};
+        int const max_threads_count{static_cast<int>((std::max)(4U, std::thread::hardware_concurrency()))};
+
+        for (int threads_count = 1; threads_count <= max_threads_count; threads_count *= 2) {
+            double const barging{mutex_throughput<ac::fast_mutex>(threads_count, duration)};
+            double const fair{mutex_throughput<ac::fast_mutex>(
+                threads_count, duration, ac::fast_mutex_policy::fair_handoff)};
+            double const std_mutex{mutex_throughput<std_mutex_adapter>(threads_count, duration)};
+            printf("---- perftest_fast_mutex %i threads, fast_mutex %.0f ops/sec, fair handoff %.0f ops/sec, std::mutex %.0f ops/sec\n",
+                   threads_count,
+                   barging,
+                   fair,
+                   std_mutex);
+        }
+    } catch (std::exception const &ex) {
+        printf("---- perftest_fast_mutex failed %s\n", ex.what());
+    }
+    printf("---- perftest_fast_mutex complete\n");
+}
+
+void test_seqlock() {
+    printf("\n---- test_seqlock started\n");
+
+    try {
+        struct sample {
+            long long first;
+            long long second;
+            long long third;
+        };
+
+        ac::seqlock<sample> value{sample{0, 0, 0}};
+        AC_CODDING_ERROR_IF_NOT(0 == value.load().first);
+
+        constexpr long long updates_count{1000000};
+        constexpr int readers_count{4};
+        std::atomic<bool> done{false};
+        std::atomic<long long> reads_count{0};
+
+        std::vector<std::thread> readers;
+        for (int i = 0; i < readers_count; ++i) {
+            readers.emplace_back([&value, &done, &reads_count]() {
+                long long local_reads_count{0};
+                long long last{0};
+                while (!done.load(std::memory_order_relaxed)) {
+                    sample const current{value.load()};
+                    //
+                    // Torn read would mix fields from different updates
+                    //
+                    AC_CODDING_ERROR_IF_NOT(current.second == current.first * 2);
+                    AC_CODDING_ERROR_IF_NOT(current.third == current.first * 3);
+                    //
+                    // Single writer only moves forward
+                    //
+                    AC_CODDING_ERROR_IF(current.first < last);
+                    last = current.first;
+                    ++local_reads_count;
+                }
+                reads_count.fetch_add(local_reads_count);
+            });
+        }
+
+        for (long long i = 1; i <= updates_count; ++i) {
+            if (i & 1) {
+                value.store(sample{i, i * 2, i * 3});
+            } else {
+                value.update([i](sample &current) noexcept {
+                    current.first = i;
+                    current.second = i * 2;
+                    current.third = i * 3;
+                });
+            }
+        }
+        done = true;
+        for (auto &t : readers) {
+            t.join();
+        }
+
+        AC_CODDING_ERROR_IF_NOT(updates_count == value.load().first);
+        AC_CODDING_ERROR_IF_NOT(static_cast<uint32_t>(updates_count * 2) == value.sequence());
+
+        printf("---- test_seqlock %lli updates, %lli reads\n", updates_count, reads_count.load());
+
+        {
+            //
+            // Several writers. Updates are read-modify-write, so a lost
+            // update shows up in the final value.
+            //
+            constexpr int writers_count{4};
+            constexpr long long updates_per_writer{200000};
+            ac::seqlock<sample> counters{sample{0, 0, 0}};
+            std::atomic<bool> writers_done{false};
+            std::thread reader{[&counters, &writers_done]() {
+                while (!writers_done.load(std::memory_order_relaxed)) {
+                    sample const current{counters.load()};
+                    AC_CODDING_ERROR_IF_NOT(current.second == current.first * 2);
+                    AC_CODDING_ERROR_IF_NOT(current.third == current.first * 3);
+                }
+            }};
+            std::vector<std::thread> writers;
+            for (int i = 0; i < writers_count; ++i) {
+                writers.emplace_back([&counters]() {
+                    for (long long j = 0; j < updates_per_writer; ++j) {
+                        counters.update([](sample &current) noexcept {
+                            current.first += 1;
+                            current.second += 2;
+                            current.third += 3;
+                        });
+                    }
+                });
+            }
+            for (auto &t : writers) {
+                t.join();
+            }
+            writers_done = true;
+            reader.join();
+            AC_CODDING_ERROR_IF_NOT(writers_count * updates_per_writer == counters.load().first);
+        }
+    } catch (std::exception const &ex) {
+        printf("---- test_seqlock failed %s\n", ex.what());
+    }
+    printf("---- test_seqlock complete\n");
+}
@@ -0,0 +1,24 @@
+#ifndef _AC_HELPERS_WIN32_LIBRARY_TEST_LOCKS_HEADER_
+#define _AC_HELPERS_WIN32_LIBRARY_TEST_LOCKS_HEADER_
+
+void test_parking_lot();
+
+void test_srw_lock();
+
+void perftest_srw_lock();
+
+void test_bravo_lock();
+
+void perftest_bravo_lock();
+
+void test_condition_variable();
+
+void test_lock_profiler();
+
+void test_fast_mutex();
+
+void perftest_fast_mutex();
+
+void test_seqlock();
+
+#endif //_AC_HELPERS_WIN32_LIBRARY_TEST_LOCKS_HEADER_
@@ -0,0 +1,301 @@
+#include "ac_test_queue.h"
+
+#include <stdlib.h>
+#include <stdio.h>
+
+#include <thread>
+#include <vector>
+#include <deque>
+#include <memory>
+#include <algorithm>
+
+#include "..\acqueue.h"
+#include "..\acresourceowner.h"
+
+namespace {
+
+    struct queue_test_entry : public ac::mpsc_queue_entry {
+        int producer{0};
+        long long sequence{0};
+    };
+
+    struct queue_test_value {
+        int producer{0};
+        long long sequence{0};
+    };
+
+    constexpr size_t queue_test_ring_capacity{1024};
+
+    using queue_test_ring = ac::mpmc_ring<queue_test_value, queue_test_ring_capacity>;
+
+    //
+    // What producer/consumer pipelines did before these queues
+    //
+    class locked_deque {
+    public:
+        bool try_push(queue_test_value const &value) {
+            ac::srw_lock::exclusive_lock_guard guard{&lock_};
+            values_.push_back(value);
+            return true;
+        }
+
+        bool try_pop(queue_test_value &value) {
+            ac::srw_lock::exclusive_lock_guard guard{&lock_};
+            if (values_.empty()) {
+                return false;
+            }
+            value = values_.front();
+            values_.pop_front();
+            return true;
+        }
+
+    private:
+        ac::srw_lock lock_;
+        std::deque<queue_test_value> values_;
+    };
+
+    template<typename Q>
+    double queue_throughput(Q &queue, int producers_count, long long items_count) {
+        long long const items_per_producer{items_count / producers_count};
+        std::atomic<bool> go{false};
+        std::vector<std::thread> producers;
+        for (int producer = 0; producer < producers_count; ++producer) {
+            producers.emplace_back([&queue, &go, producer, items_per_producer]() {
+                while (!go.load(std::memory_order_acquire)) {
+                    std::this_thread::yield();
+                }
+                for (long long i = 0; i < items_per_producer; ++i) {
+                    while (!queue.try_push(queue_test_value{producer, i})) {
+                        std::this_thread::yield();
+                    }
+                }
+            });
+        }
+        long long const total{items_per_producer * producers_count};
+        auto const start{std::chrono::steady_clock::now()};
+        go.store(true, std::memory_order_release);
+        queue_test_value value;
+        for (long long popped = 0; popped < total;) {
+            if (queue.try_pop(value)) {
+                ++popped;
+            } else {
+                std::this_thread::yield();
+            }
+        }
+        auto const elapsed{std::chrono::steady_clock::now() - start};
+        for (auto &t : producers) {
+            t.join();
+        }
+        return static_cast<double>(total) /
+               (std::max)(std::chrono::duration<double>(elapsed).count(), 0.000001);
+    }
+
+    double mpsc_queue_throughput(int producers_count, long long items_count) {
+        long long const items_per_producer{items_count / producers_count};
+        std::vector<std::unique_ptr<queue_test_entry[]>> entries;
+        for (int producer = 0; producer < producers_count; ++producer) {
+            entries.emplace_back(std::make_unique<queue_test_entry[]>(items_per_producer));
+        }
+        ac::mpsc_queue<queue_test_entry> queue;
+        std::atomic<bool> go{false};
+        std::vector<std::thread> producers;
+        for (int producer = 0; producer < producers_count; ++producer) {
+            producers.emplace_back([&queue, &go, &entries, producer, items_per_producer]() {
+                while (!go.load(std::memory_order_acquire)) {
+                    std::this_thread::yield();
+                }
+                queue_test_entry *const producer_entries{entries[producer].get()};
+                for (long long i = 0; i < items_per_producer; ++i) {
+                    queue.push(&producer_entries[i]);
+                }
+            });
+        }
+        long long const total{items_per_producer * producers_count};
+        auto const start{std::chrono::steady_clock::now()};
+        go.store(true, std::memory_order_release);
+        for (long long popped = 0; popped < total; ++popped) {
+            AC_CODDING_ERROR_IF(nullptr == queue.pop());
+        }
+        auto const elapsed{std::chrono::steady_clock::now() - start};
+        for (auto &t : producers) {
+            t.join();
+        }
+        return static_cast<double>(total) /
+               (std::max)(std::chrono::duration<double>(elapsed).count(), 0.000001);
+    }
+
+} // namespace
+
+void test_mpsc_queue() {
+    printf("\n---- test_mpsc_queue started\n");
+
+    try {
+        ac::mpsc_queue<queue_test_entry> queue;
+        AC_CODDING_ERROR_IF_NOT(nullptr == queue.try_pop());
+        AC_CODDING_ERROR_IF_NOT(nullptr == queue.pop(10));
+
+        queue_test_entry single;
+        queue.push(&single);
+        AC_CODDING_ERROR_IF_NOT(&single == queue.try_pop());
+        AC_CODDING_ERROR_IF_NOT(nullptr == queue.try_pop());
+        //
+        // Entry can be pushed again once it was popped
+        //
+        queue.push(&single);
+        AC_CODDING_ERROR_IF_NOT(&single == queue.pop(0));
+
+        constexpr int producers_count{4};
+        constexpr long long items_per_producer{100000};
+
+        std::vector<std::unique_ptr<queue_test_entry[]>> entries;
+        for (int producer = 0; producer < producers_count; ++producer) {
+            entries.emplace_back(std::make_unique<queue_test_entry[]>(items_per_producer));
+        }
+
+        std::vector<std::thread> producers;
+        for (int producer = 0; producer < producers_count; ++producer) {
+            producers.emplace_back([&queue, &entries, producer]() {
+                queue_test_entry *const producer_entries{entries[producer].get()};
+                for (long long i = 0; i < items_per_producer; ++i) {
+                    producer_entries[i].producer = producer;
+                    producer_entries[i].sequence = i;
+                    queue.push(&producer_entries[i]);
+                    if (0 == (i % 10000)) {
+                        //
+                        // Let consumer drain the queue and go to sleep
+                        //
+                        std::this_thread::sleep_for(std::chrono::milliseconds{1});
+                    }
+                }
+            });
+        }
+
+        std::vector<long long> next_sequence(producers_count, 0);
+        for (long long popped = 0; popped < producers_count * items_per_producer; ++popped) {
+            queue_test_entry *const entry{queue.pop()};
+            AC_CODDING_ERROR_IF(nullptr == entry);
+            //
+            // Elements of each producer come out in FIFO order
+            //
+            AC_CODDING_ERROR_IF_NOT(next_sequence[entry->producer] == entry->sequence);
+            ++next_sequence[entry->producer];
+        }
+        for (auto &t : producers) {
+            t.join();
+        }
+        AC_CODDING_ERROR_IF_NOT(nullptr == queue.try_pop());
+    } catch (std::exception const &ex) {
+        printf("---- test_mpsc_queue failed %s\n", ex.what());
+    }
+    printf("---- test_mpsc_queue complete\n");
+}
+
+void test_mpmc_ring() {
+    printf("\n---- test_mpmc_ring started\n");
+
+    try {
+        {
+            ac::mpmc_ring<std::unique_ptr<int>, 4> ring;
+            std::unique_ptr<int> value;
+            AC_CODDING_ERROR_IF(ring.try_pop(value));
+            AC_CODDING_ERROR_IF(ring.pop(value, 10));
+            for (int i = 0; i < 4; ++i) {
+                AC_CODDING_ERROR_IF_NOT(ring.try_push(std::make_unique<int>(i)));
+            }
+            AC_CODDING_ERROR_IF_NOT(4 == ring.size());
+            AC_CODDING_ERROR_IF(ring.try_push(std::make_unique<int>(4)));
+            AC_CODDING_ERROR_IF_NOT(ring.try_pop(value));
+            AC_CODDING_ERROR_IF_NOT(0 == *value);
+            AC_CODDING_ERROR_IF_NOT(ring.try_push(std::make_unique<int>(4)));
+            //
+            // Ring destroys elements that are left in it
+            //
+        }
+
+        constexpr int producers_count{4};
+        constexpr int consumers_count{4};
+        constexpr long long items_per_producer{100000};
+
+        auto ring{std::make_unique<queue_test_ring>()};
+        std::atomic<long long> popped_count{0};
+        std::atomic<long long> popped_sum{0};
+
+        std::vector<std::thread> consumers;
+        for (int consumer = 0; consumer < consumers_count; ++consumer) {
+            consumers.emplace_back([&ring, &popped_count, &popped_sum]() {
+                std::vector<long long> last_sequence(producers_count, -1);
+                long long local_sum{0};
+                queue_test_value value;
+                while (ring->pop(value)) {
+                    if (value.producer < 0) {
+                        break;
+                    }
+                    //
+                    // Each consumer sees elements of a producer in order
+                    //
+                    AC_CODDING_ERROR_IF_NOT(last_sequence[value.producer] < value.sequence);
+                    last_sequence[value.producer] = value.sequence;
+                    local_sum += value.sequence;
+                    popped_count.fetch_add(1, std::memory_order_relaxed);
+                }
+                popped_sum.fetch_add(local_sum);
+            });
+        }
+
+        std::vector<std::thread> producers;
+        for (int producer = 0; producer < producers_count; ++producer) {
+            producers.emplace_back([&ring, producer]() {
+                for (long long i = 0; i < items_per_producer; ++i) {
+                    while (!ring->try_push(queue_test_value{producer, i})) {
+                        std::this_thread::yield();
+                    }
+                    if (0 == (i % 10000)) {
+                        std::this_thread::sleep_for(std::chrono::milliseconds{1});
+                    }
+                }
+            });
+        }
+        for (auto &t : producers) {
+            t.join();
+        }
+        for (int consumer = 0; consumer < consumers_count; ++consumer) {
+            while (!ring->try_push(queue_test_value{-1, 0})) {
+                std::this_thread::yield();
+            }
+        }
+        for (auto &t : consumers) {
+            t.join();
+        }
+        AC_CODDING_ERROR_IF_NOT(producers_count * items_per_producer == popped_count.load());
+        AC_CODDING_ERROR_IF_NOT(producers_count * (items_per_producer * (items_per_producer - 1) / 2) ==
+                                popped_sum.load());
+        AC_CODDING_ERROR_IF_NOT(0 == ring->size());
+    } catch (std::exception const &ex) {
+        printf("---- test_mpmc_ring failed %s\n", ex.what());
+    }
+    printf("---- test_mpmc_ring complete\n");
+}
+
+void perftest_queues() {
+    printf("\n---- perftest_queues started\n");
+
+    try {
+        constexpr long long items_count{1 << 20};
+
+        for (int producers_count = 1; producers_count <= 64; producers_count *= 2) {
+            double const mpsc{mpsc_queue_throughput(producers_count, items_count)};
+            auto ring{std::make_unique<queue_test_ring>()};
+            double const mpmc{queue_throughput(*ring, producers_count, items_count)};
+            locked_deque deque;
+            double const locked{queue_throughput(deque, producers_count, items_count)};
+            printf("---- perftest_queues %i producers, mpsc_queue %.0f items/sec, mpmc_ring %.0f items/sec, srw_lock deque %.0f items/sec\n",
+                   producers_count,
+                   mpsc,
+                   mpmc,
+                   locked);
+        }
+    } catch (std::exception const &ex) {
+        printf("---- perftest_queues failed %s\n", ex.what());
+    }
+    printf("---- perftest_queues complete\n");
+}
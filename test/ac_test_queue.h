@@ -0,0 +1,10 @@
+#ifndef _AC_HELPERS_WIN32_LIBRARY_TEST_QUEUE_HEADER_
+#define _AC_HELPERS_WIN32_LIBRARY_TEST_QUEUE_HEADER_
+
+void test_mpsc_queue();
+
+void test_mpmc_ring();
+
+void perftest_queues();
+
+#endif //_AC_HELPERS_WIN32_LIBRARY_TEST_QUEUE_HEADER_
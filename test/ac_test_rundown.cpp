@@ -0,0 +1,712 @@
+#include "ac_test_rundown.h"
+
+#include <stdlib.h>
+#include <stdio.h>
+
+#include <thread>
+#include <vector>
+#include <algorithm>
+
+#include "..\acrundown.h"
+
+namespace {
+
+    template<typename R>
+    void run_rundown_holders(R &rundown, int threads_count, std::atomic<int> &inside, std::atomic<bool> &stop) {
+        std::vector<std::thread> threads;
+        for (int i = 0; i < threads_count; ++i) {
+            threads.emplace_back([&rundown, &inside, &stop]() {
+                while (!stop.load(std::memory_order_relaxed)) {
+                    ac::resource_owner<R> lock{nullptr};
+                    if (lock.try_acquire(&rundown)) {
+                        inside.fetch_add(1);
+                        inside.fetch_sub(1);
+                    }
+                }
+            });
+        }
+        for (auto &t : threads) {
+            t.join();
+        }
+    }
+
+    template<typename R>
+    [[nodiscard]] double measure_rundown_contention(int threads_count, int iterations_per_thread) {
+        R rundown;
+        std::atomic<int> ready_count{0};
+        std::atomic<bool> go{false};
+        std::vector<std::thread> threads;
+
+        for (int i = 0; i < threads_count; ++i) {
+            threads.emplace_back([&rundown, &ready_count, &go, iterations_per_thread]() {
+                ready_count.fetch_add(1);
+                while (!go.load(std::memory_order_acquire)) {
+                    std::this_thread::yield();
+                }
+                for (int j = 0; j < iterations_per_thread; ++j) {
+                    ac::resource_owner<R> lock{&rundown};
+                }
+            });
+        }
+
+        while (ready_count.load() != threads_count) {
+            std::this_thread::yield();
+        }
+
+        auto start{std::chrono::steady_clock::now()};
+        go.store(true, std::memory_order_release);
+        for (auto &t : threads) {
+            t.join();
+        }
+        auto elapsed{std::chrono::steady_clock::now() - start};
+
+        rundown.join();
+
+        return static_cast<double>(
+                   std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()) /
+               (static_cast<double>(iterations_per_thread) * threads_count);
+    }
+
+} // namespace
+
+namespace {
+
+    template<typename T>
+    void test_wait_on_address_value(T initial_value, T new_value) {
+        T volatile value{initial_value};
+        std::atomic<bool> woken{false};
+        //
+        // Nobody changes the value, so wait must time out
+        //
+        AC_CODDING_ERROR_IF(ac::wait_on_address::try_wait(&value, initial_value, 10));
+        //
+        // Value does not match, so wait must return right away
+        //
+        AC_CODDING_ERROR_IF_NOT(ac::wait_on_address::try_wait(&value, new_value, 10));
+
+        std::thread waiter{[&value, &woken, initial_value]() {
+            while (value == initial_value) {
+                ac::wait_on_address::wait(&value, initial_value);
+            }
+            woken = true;
+        }};
+
+        std::this_thread::sleep_for(std::chrono::milliseconds{50});
+        AC_CODDING_ERROR_IF(woken.load());
+
+        value = new_value;
+        ac::wait_on_address::wake_single(&value);
+        waiter.join();
+
+        AC_CODDING_ERROR_IF_NOT(woken.load());
+    }
+
+} // namespace
+
+void test_wait_on_address() {
+    printf("\n---- test_wait_on_address started\n");
+
+    try {
+        test_wait_on_address_value<uint8_t>(1, 2);
+        test_wait_on_address_value<uint16_t>(1, 2);
+        test_wait_on_address_value<uint32_t>(1, 2);
+        test_wait_on_address_value<uint64_t>(1, 0x100000001ULL);
+    } catch (std::exception const &ex) {
+        printf("---- test_wait_on_address failed %s\n", ex.what());
+    }
+    printf("---- test_wait_on_address complete\n");
+}
+
+void test_striped_rundown() {
+    printf("\n---- test_striped_rundown started\n");
+
+    try {
+        constexpr int threads_count{8};
+
+        ac::striped_rundown rundown;
+        std::atomic<int> inside{0};
+        std::atomic<bool> stop{false};
+
+        AC_CODDING_ERROR_IF_NOT(rundown.is_running());
+        {
+            ac::striped_rundown_lock lock{&rundown};
+            AC_CODDING_ERROR_IF_NOT(1 == rundown.count());
+            //
+            // Rundown must not complete while we hold a reference
+            //
+            AC_CODDING_ERROR_IF(rundown.start_rundown());
+            AC_CODDING_ERROR_IF_NOT(rundown.is_running_down());
+
+            ac::striped_rundown_lock lock2{nullptr};
+            AC_CODDING_ERROR_IF(lock2.try_acquire(&rundown));
+        }
+        AC_CODDING_ERROR_IF_NOT(rundown.is_rundown_complete());
+        rundown.restart();
+
+        std::thread holders{[&rundown, &inside, &stop]() {
+            run_rundown_holders(rundown, threads_count, inside, stop);
+        }};
+
+        std::this_thread::sleep_for(std::chrono::milliseconds{200});
+
+        printf("---- test_striped_rundown waiting to complete\n");
+
+        rundown.join();
+
+        printf("---- test_striped_rundown validating\n");
+
+        AC_CODDING_ERROR_IF_NOT(0 == inside.load());
+        AC_CODDING_ERROR_IF_NOT(rundown.is_rundown_complete());
+
+        stop = true;
+        holders.join();
+
+        AC_CODDING_ERROR_IF_NOT(0 == rundown.count());
+    } catch (std::exception const &ex) {
+        printf("---- test_striped_rundown failed %s\n", ex.what());
+    }
+    printf("---- test_striped_rundown complete\n");
+}
+
+void stresstest_striped_rundown_join() {
+    printf("\n---- stresstest_striped_rundown_join started\n");
+
+    try {
+        constexpr int threads_count{4};
+        constexpr int rounds_count{20000};
+
+        std::atomic<ac::striped_rundown *> current{nullptr};
+        std::atomic<int> round{0};
+        std::atomic<int> released_count{0};
+        std::vector<std::thread> threads;
+        //
+        // Every round each thread drops one reference on a fresh
+        // rundown, while main thread joins and destroys it. Releases
+        // must not touch the rundown once join has returned.
+        //
+        for (int i = 0; i < threads_count; ++i) {
+            threads.emplace_back([&current, &round, &released_count]() {
+                for (int r = 1; r <= rounds_count; ++r) {
+                    while (round.load(std::memory_order_acquire) != r) {
+                        std::this_thread::yield();
+                    }
+                    current.load(std::memory_order_relaxed)->release();
+                    released_count.fetch_add(1, std::memory_order_release);
+                }
+            });
+        }
+
+        for (int r = 1; r <= rounds_count; ++r) {
+            auto rundown{std::make_unique<ac::striped_rundown>()};
+            rundown->acquire_n(threads_count);
+            current.store(rundown.get(), std::memory_order_relaxed);
+            released_count.store(0, std::memory_order_relaxed);
+            round.store(r, std::memory_order_release);
+            //
+            // On even rounds releases get a head start, on odd rounds
+            // join races them from the start
+            //
+            if (0 == r % 2) {
+                std::this_thread::yield();
+            }
+            rundown.reset();
+            while (released_count.load(std::memory_order_acquire) != threads_count) {
+                std::this_thread::yield();
+            }
+        }
+
+        for (auto &t : threads) {
+            t.join();
+        }
+    } catch (std::exception const &ex) {
+        printf("---- stresstest_striped_rundown_join failed %s\n", ex.what());
+    }
+    printf("---- stresstest_striped_rundown_join complete\n");
+}
+
+void test_rundown_batch_lock() {
+    printf("\n---- test_rundown_batch_lock started\n");
+
+    try {
+        constexpr int items_count{10'000};
+        constexpr int workers_count{8};
+        constexpr int items_per_worker{items_count / workers_count};
+
+        ac::slim_rundown rundown;
+        std::atomic<int> processed{0};
+        //
+        // Single acquire covers all items
+        //
+        ac::slim_rundown_batch batch{&rundown, items_count};
+        AC_CODDING_ERROR_IF_NOT(items_count == rundown.count());
+
+        std::vector<std::thread> workers;
+        for (int i = 0; i < workers_count; ++i) {
+            workers.emplace_back([share = batch.split(items_per_worker), &processed]() mutable {
+                //
+                // Worker hands each item its own share, and
+                // collects them back once items are processed,
+                // so the shared counter is touched once on exit.
+                //
+                ac::slim_rundown_batch done;
+                while (share) {
+                    ac::slim_rundown_batch item{share.split(1)};
+                    processed.fetch_add(1, std::memory_order_relaxed);
+                    done.merge(std::move(item));
+                }
+                AC_CODDING_ERROR_IF_NOT(items_per_worker == done.count());
+            });
+        }
+        for (auto &w : workers) {
+            w.join();
+        }
+
+        //
+        // All shares were handed out to workers
+        //
+        AC_CODDING_ERROR_IF(batch);
+        AC_CODDING_ERROR_IF_NOT(0 == rundown.count());
+        AC_CODDING_ERROR_IF_NOT(items_count == processed.load());
+
+        AC_CODDING_ERROR_IF_NOT(rundown.start_rundown());
+        ac::slim_rundown_batch late;
+        AC_CODDING_ERROR_IF(late.try_acquire(&rundown, 2));
+        AC_CODDING_ERROR_IF_NOT(rundown.is_rundown_complete());
+
+        ac::striped_rundown striped;
+        {
+            ac::striped_rundown_batch striped_batch{&striped, 4};
+            AC_CODDING_ERROR_IF_NOT(4 == striped.count());
+            ac::striped_rundown_batch half{striped_batch.split(2)};
+            half.release(1);
+            AC_CODDING_ERROR_IF_NOT(3 == striped.count());
+            striped_batch.merge(std::move(half));
+            AC_CODDING_ERROR_IF_NOT(3 == striped_batch.count());
+            AC_CODDING_ERROR_IF(half);
+        }
+        AC_CODDING_ERROR_IF_NOT(0 == striped.count());
+    } catch (std::exception const &ex) {
+        printf("---- test_rundown_batch_lock failed %s\n", ex.what());
+    }
+    printf("---- test_rundown_batch_lock complete\n");
+}
+
+namespace {
+
+    //
+    // Minimal coroutine type that is enough to co_await
+    // on the rundown
+    //
+    struct fire_and_forget {
+        struct promise_type {
+            fire_and_forget get_return_object() noexcept {
+                return {};
+            }
+
+            std::suspend_never initial_suspend() noexcept {
+                return {};
+            }
+
+            std::suspend_never final_suspend() noexcept {
+                return {};
+            }
+
+            void return_void() noexcept {
+            }
+
+            void unhandled_exception() noexcept {
+                AC_CRASH_APPLICATION();
+            }
+        };
+    };
+
+    fire_and_forget await_rundown(ac::slim_rundown &rundown, std::atomic<int> &resumed) {
+        co_await rundown.join_async();
+        AC_CODDING_ERROR_IF_NOT(rundown.is_rundown_complete());
+        resumed.fetch_add(1);
+    }
+
+} // namespace
+
+void test_rundown_join_async() {
+    printf("\n---- test_rundown_join_async started\n");
+
+    try {
+        std::atomic<int> fired{0};
+        {
+            //
+            // Already complete, so continuation runs right away
+            //
+            ac::slim_rundown rundown;
+            rundown.join_async([&fired]() { fired.fetch_add(1); });
+            AC_CODDING_ERROR_IF_NOT(1 == fired.load());
+        }
+        {
+            //
+            // Continuation runs on the thread that releases last reference
+            //
+            ac::slim_rundown rundown;
+            ac::slim_rundown_lock lock{&rundown};
+            std::thread::id continuation_thread;
+            rundown.join_async([&fired, &continuation_thread]() {
+                continuation_thread = std::this_thread::get_id();
+                fired.fetch_add(1);
+            });
+            AC_CODDING_ERROR_IF_NOT(1 == fired.load());
+            std::thread releaser{[&lock]() { lock.release(); }};
+            std::thread::id const releaser_id{releaser.get_id()};
+            releaser.join();
+            AC_CODDING_ERROR_IF_NOT(2 == fired.load());
+            AC_CODDING_ERROR_IF_NOT(releaser_id == continuation_thread);
+        }
+        {
+            //
+            // Last release races with join_async, continuation must
+            // fire exactly once every time
+            //
+            constexpr int iterations{10'000};
+            ac::slim_rundown rundown;
+            for (int i = 0; i < iterations; ++i) {
+                ac::slim_rundown_lock lock{&rundown};
+                std::atomic<int> count{0};
+                std::thread releaser{[&lock]() { lock.release(); }};
+                rundown.join_async([&count]() { count.fetch_add(1); });
+                releaser.join();
+                AC_CODDING_ERROR_IF_NOT(1 == count.load());
+                rundown.restart();
+            }
+        }
+        {
+            std::atomic<int> resumed{0};
+            ac::slim_rundown rundown;
+            ac::slim_rundown_lock lock{&rundown};
+            await_rundown(rundown, resumed);
+            AC_CODDING_ERROR_IF_NOT(0 == resumed.load());
+            lock.release();
+            AC_CODDING_ERROR_IF_NOT(1 == resumed.load());
+        }
+    } catch (std::exception const &ex) {
+        printf("---- test_rundown_join_async failed %s\n", ex.what());
+    }
+    printf("---- test_rundown_join_async complete\n");
+}
+
+void test_rundown_tree() {
+    printf("\n---- test_rundown_tree started\n");
+
+    try {
+        constexpr int branches_count{4};
+        constexpr int leaves_per_branch{3};
+        constexpr std::chrono::milliseconds hold_time{100};
+
+        ac::rundown_tree root;
+        std::vector<std::unique_ptr<ac::rundown_tree>> branches;
+        std::vector<std::unique_ptr<ac::rundown_tree>> leaves;
+        std::vector<std::thread> holders;
+        std::atomic<int> leaves_completed{0};
+
+        for (int i = 0; i < branches_count; ++i) {
+            branches.push_back(std::make_unique<ac::rundown_tree>(&root));
+            for (int j = 0; j < leaves_per_branch; ++j) {
+                leaves.push_back(std::make_unique<ac::rundown_tree>(branches.back().get()));
+                ac::rundown_tree *leaf{leaves.back().get()};
+                //
+                // Branch i drains in (i + 1) * hold_time
+                //
+                holders.emplace_back([lock = ac::rundown_tree_lock{leaf}, hold_time, i]() mutable {
+                    std::this_thread::sleep_for(hold_time * (i + 1));
+                    lock.release();
+                });
+                leaf->join_async([&leaves_completed]() { leaves_completed.fetch_add(1); });
+            }
+        }
+        //
+        // Each child holds a reference on its parent
+        //
+        AC_CODDING_ERROR_IF_NOT(branches_count == root.count());
+        //
+        // join_async above already started rundown on leaves,
+        // so branch cannot get new children
+        //
+        bool thrown{false};
+        try {
+            ac::rundown_tree late_leaf{leaves.front().get()};
+        } catch (ac::rundown_exception const &) {
+            thrown = true;
+        }
+        AC_CODDING_ERROR_IF_NOT(thrown);
+
+        printf("---- test_rundown_tree waiting to complete\n");
+
+        auto const start{std::chrono::steady_clock::now()};
+        root.join();
+        auto const elapsed{std::chrono::steady_clock::now() - start};
+
+        printf("---- test_rundown_tree validating, joined in %lli ms\n",
+               static_cast<long long>(
+                   std::chrono::duration_cast<std::chrono::milliseconds>(elapsed).count()));
+
+        AC_CODDING_ERROR_IF_NOT(branches_count * leaves_per_branch == leaves_completed.load());
+        for (auto const &branch : branches) {
+            AC_CODDING_ERROR_IF_NOT(branch->is_rundown_complete());
+        }
+        //
+        // Joined in about the time of the slowest branch rather
+        // than the sum of all branches
+        //
+        AC_CODDING_ERROR_IF(elapsed >= hold_time * (branches_count * (branches_count + 1) / 2));
+
+        for (auto &t : holders) {
+            t.join();
+        }
+        //
+        // Restart goes top down, and children have to be destroyed
+        // before parents
+        //
+        AC_CODDING_ERROR_IF(leaves.front()->restart());
+        AC_CODDING_ERROR_IF_NOT(root.restart());
+        AC_CODDING_ERROR_IF_NOT(branches.front()->restart());
+        AC_CODDING_ERROR_IF_NOT(leaves.front()->restart());
+        AC_CODDING_ERROR_IF_NOT(1 == root.count());
+        leaves.clear();
+        branches.clear();
+        AC_CODDING_ERROR_IF_NOT(0 == root.count());
+    } catch (std::exception const &ex) {
+        printf("---- test_rundown_tree failed %s\n", ex.what());
+    }
+    printf("---- test_rundown_tree complete\n");
+}
+
+void stresstest_rundown_tree_add_child() {
+    printf("\n---- stresstest_rundown_tree_add_child started\n");
+
+    try {
+        constexpr int rounds_count{2000};
+        int constructed_count{0};
+        int rejected_count{0};
+        //
+        // Child is constructed while parent starts rundown. Child
+        // either fails to construct, or ends up running down.
+        //
+        for (int r = 0; r < rounds_count; ++r) {
+            ac::rundown_tree root;
+            std::atomic<bool> go{false};
+            std::atomic<bool> constructed{false};
+            std::thread builder{[&root, &go, &constructed]() {
+                while (!go.load(std::memory_order_acquire)) {
+                    std::this_thread::yield();
+                }
+                try {
+                    ac::rundown_tree child{&root};
+                    constructed = true;
+                    ac::wait_deadline const deadline{5000};
+                    while (child.is_running()) {
+                        AC_CODDING_ERROR_IF(0 == deadline.remaining());
+                        std::this_thread::yield();
+                    }
+                } catch (ac::rundown_exception const &) {
+                }
+            }};
+            go.store(true, std::memory_order_release);
+            if (0 == r % 2) {
+                std::this_thread::yield();
+            }
+            root.start_rundown();
+            builder.join();
+            root.join();
+            if (constructed.load()) {
+                ++constructed_count;
+            } else {
+                ++rejected_count;
+            }
+        }
+        printf("---- stresstest_rundown_tree_add_child constructed %i, rejected %i\n",
+               constructed_count,
+               rejected_count);
+    } catch (std::exception const &ex) {
+        printf("---- stresstest_rundown_tree_add_child failed %s\n", ex.what());
+    }
+    printf("---- stresstest_rundown_tree_add_child complete\n");
+}
+
+namespace {
+
+    std::atomic<long> epoch_test_live_configs{0};
+
+    struct epoch_test_config {
+        explicit epoch_test_config(long v)
+            : value{v}
+            , doubled{v * 2} {
+            epoch_test_live_configs.fetch_add(1);
+        }
+
+        ~epoch_test_config() {
+            value = -1;
+            doubled = 0;
+            epoch_test_live_configs.fetch_sub(1);
+        }
+
+        long value;
+        long doubled;
+    };
+} // namespace
+
+void test_epoch_domain() {
+    printf("\n---- test_epoch_domain started\n");
+
+    try {
+        constexpr int readers_count{4};
+        constexpr long updates_count{20000};
+
+        ac::epoch_domain domain;
+        {
+            ac::epoch_ptr<epoch_test_config> config{domain,
+                                                    std::make_unique<epoch_test_config>(0)};
+            std::atomic<bool> done{false};
+            std::vector<std::thread> readers;
+
+            for (int i = 0; i < readers_count; ++i) {
+                readers.emplace_back([&config, &done]() {
+                    long last{0};
+                    while (!done.load(std::memory_order_relaxed)) {
+                        ac::epoch_guard guard;
+                        epoch_test_config const *c{config.load()};
+                        //
+                        // Retired object must not be freed while we
+                        // are in critical region
+                        //
+                        AC_CODDING_ERROR_IF_NOT(c->value * 2 == c->doubled);
+                        AC_CODDING_ERROR_IF(c->value < last);
+                        {
+                            ac::epoch_guard nested;
+                            AC_CODDING_ERROR_IF_NOT(c->value * 2 == c->doubled);
+                        }
+                        last = c->value;
+                    }
+                });
+            }
+
+            for (long i = 1; i <= updates_count; ++i) {
+                config.reset(std::make_unique<epoch_test_config>(i));
+            }
+            done = true;
+            for (auto &t : readers) {
+                t.join();
+            }
+
+            printf("---- test_epoch_domain validating, %zu objects pending\n", domain.pending());
+            //
+            // Writer did not block, yet retired objects did not pile up
+            //
+            AC_CODDING_ERROR_IF_NOT(domain.pending() < updates_count);
+        }
+        domain.reclaim();
+        AC_CODDING_ERROR_IF_NOT(0 == domain.pending());
+        AC_CODDING_ERROR_IF_NOT(0 == epoch_test_live_configs.load());
+    } catch (std::exception const &ex) {
+        printf("---- test_epoch_domain failed %s\n", ex.what());
+    }
+    printf("---- test_epoch_domain complete\n");
+}
+
+void test_rundown_stats() {
+    printf("\n---- test_rundown_stats started\n");
+
+    try {
+        using instrumented_rundown = ac::rundown_counter<ac::details::noop_rundown_base, ac::rundown_stats>;
+#if !AC_RUNDOWN_INSTRUMENTED
+        //
+        // Default policy does not make rundown any bigger
+        //
+        static_assert(sizeof(ac::rundown_counter<>) == sizeof(ac::rundown_counter<>::counter_t));
+#endif
+
+        constexpr int threads_count{4};
+        constexpr int iterations_count{10000};
+
+        instrumented_rundown rundown;
+        std::vector<std::thread> threads;
+        for (int i = 0; i < threads_count; ++i) {
+            threads.emplace_back([&rundown]() {
+                for (int j = 0; j < iterations_count; ++j) {
+                    ac::rundown_site_lock<instrumented_rundown> lock{&rundown};
+                }
+            });
+        }
+        for (auto &t : threads) {
+            t.join();
+        }
+
+        ac::rundown_site_lock<instrumented_rundown> held{&rundown};
+        std::thread holder{[lock = ac::rundown_site_lock<instrumented_rundown>{&rundown}]() mutable {
+            std::this_thread::sleep_for(std::chrono::milliseconds{50});
+        }};
+
+        size_t sites{0};
+        int64_t outstanding{0};
+        rundown.stats().for_each_site(
+            [&sites, &outstanding](char const *file, uint32_t line, char const *function, int64_t site_outstanding, uint64_t acquires) {
+                printf("---- test_rundown_stats %s(%u) %s outstanding %lli, acquires %llu\n",
+                       file,
+                       line,
+                       function,
+                       static_cast<long long>(site_outstanding),
+                       static_cast<unsigned long long>(acquires));
+                ++sites;
+                outstanding += site_outstanding;
+            });
+        AC_CODDING_ERROR_IF_NOT(3 == sites);
+        AC_CODDING_ERROR_IF_NOT(2 == outstanding);
+
+        held.release();
+        AC_CODDING_ERROR_IF(rundown.start_rundown());
+        holder.join();
+        AC_CODDING_ERROR_IF_NOT(rundown.is_rundown_complete());
+
+        ac::rundown_stats_snapshot const stats{rundown.stats().snapshot()};
+        printf("---- test_rundown_stats acquires %llu, cas retries %llu, max cas retries %llu, peak %llu, rundown %lli us\n",
+               static_cast<unsigned long long>(stats.acquires),
+               static_cast<unsigned long long>(stats.cas_retries),
+               static_cast<unsigned long long>(stats.max_cas_retries),
+               static_cast<unsigned long long>(stats.peak_count),
+               static_cast<long long>(
+                   std::chrono::duration_cast<std::chrono::microseconds>(stats.last_rundown_duration).count()));
+
+        AC_CODDING_ERROR_IF_NOT(threads_count * iterations_count + 2 == stats.acquires);
+        AC_CODDING_ERROR_IF_NOT(0 == stats.failed_acquires);
+        AC_CODDING_ERROR_IF_NOT(2 <= stats.peak_count);
+        AC_CODDING_ERROR_IF_NOT(1 == stats.rundowns_started);
+        AC_CODDING_ERROR_IF_NOT(1 == stats.rundowns_completed);
+        AC_CODDING_ERROR_IF(stats.last_rundown_duration <= std::chrono::milliseconds{10});
+
+        AC_CODDING_ERROR_IF(rundown.try_acquire());
+        AC_CODDING_ERROR_IF_NOT(1 == rundown.stats().snapshot().failed_acquires);
+    } catch (std::exception const &ex) {
+        printf("---- test_rundown_stats failed %s\n", ex.what());
+    }
+    printf("---- test_rundown_stats complete\n");
+}
+
+void perftest_rundown_contention() {
+    printf("\n---- perftest_rundown_contention started\n");
+
+    try {
+        constexpr int iterations_per_thread{1'000'000};
+        int const max_threads_count{
+            static_cast<int>((std::max)(1U, std::thread::hardware_concurrency()))};
+
+        printf("---- %8s %24s %24s\n", "threads", "slim_rundown ns/op", "striped_rundown ns/op");
+
+        for (int threads_count = 1; threads_count <= max_threads_count; threads_count *= 2) {
+            double const slim_ns{
+                measure_rundown_contention<ac::slim_rundown>(threads_count, iterations_per_thread)};
+            double const striped_ns{
+                measure_rundown_contention<ac::striped_rundown>(threads_count, iterations_per_thread)};
+
+            printf("---- %8i %24.2f %24.2f\n", threads_count, slim_ns, striped_ns);
+        }
+    } catch (std::exception const &ex) {
+        printf("---- perftest_rundown_contention failed %s\n", ex.what());
+    }
+    printf("---- perftest_rundown_contention complete\n");
+}
@@ -0,0 +1,24 @@
+#ifndef _AC_HELPERS_WIN32_LIBRARY_TEST_RUNDOWN_HEADER_
+#define _AC_HELPERS_WIN32_LIBRARY_TEST_RUNDOWN_HEADER_
+
+void test_wait_on_address();
+
+void test_striped_rundown();
+
+void stresstest_striped_rundown_join();
+
+void test_rundown_batch_lock();
+
+void test_rundown_join_async();
+
+void test_rundown_tree();
+
+void stresstest_rundown_tree_add_child();
+
+void test_epoch_domain();
+
+void test_rundown_stats();
+
+void perftest_rundown_contention();
+
+#endif //_AC_HELPERS_WIN32_LIBRARY_TEST_RUNDOWN_HEADER_
@@ -1,11 +1,14 @@
 #include "ac_test_thread_pool.h"
 
 #include <stdlib.h>
+#include <string.h>
 
 #include "..\actp.h"
 #include "..\acrundown.h"
 #include "..\ackernelobject.h"
 #include "..\acfileobject.h"
+#include "..\acbufferpool.h"
+#include "..\acsequentialreader.h"
 
 void test_ft_to_timepoint_conversion() {
     FILETIME ft;
@@ -712,15 +715,19 @@ void test_default_tp_io_handler() {
                   FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
                   OPEN_ALWAYS,
                   FILE_FLAG_NO_BUFFERING | FILE_FLAG_OVERLAPPED);
+        //
+        // Unbuffered writes need a sector aligned buffer, and it must
+        // outlive io_handler, which waits for pending IOs to complete
+        //
+        ac::io_buffer_pool buffer_pool{{TEST_DEFAULT_TP_IO_HANDLER_FILE_IO_SIZE}};
+        ac::io_buffer buffer{buffer_pool.allocate(TEST_DEFAULT_TP_IO_HANDLER_FILE_IO_SIZE)};
         {
             printf("---- test_default_tp_io_handler constructing IO handler\n");
 
             ac::tp::io_handler_ptr io_handler{ac::tp::make_io_handler(
                 fo.get_handle(),
                 [&total_completed_count, &total_succeeded_count, &total_failed_count, &total_bytes_transfered, &io_failure](
-                    ac::tp::callback_instance &, OVERLAPPED *overlapped, ULONG error, ULONG_PTR bytes_transferred) {
-                    std::unique_ptr<OVERLAPPED> overlapped_ptr{overlapped};
-
+                    ac::tp::callback_instance &, ac::tp::io_context &context, ULONG error, ULONG_PTR bytes_transferred) {
                     ++total_completed_count;
                     total_bytes_transfered += bytes_transferred;
 
@@ -732,47 +739,39 @@ void test_default_tp_io_handler() {
                         printf("\n---- !!! test_default_tp_io_handler IO "
                                "failed !!!"
                                "error. "
-                               "0x%x, bytes transferred %u, overlapped 0x%p\n",
+                               "0x%x, bytes transferred %u, offset %I64u\n",
                                error,
                                static_cast<DWORD>(bytes_transferred),
-                               overlapped);
+                               context.get_offset());
                     }
                 })};
             {
-                ac::cbuffer buffer;
-                buffer.resize(TEST_DEFAULT_TP_IO_HANDLER_FILE_IO_SIZE);
-
                 printf("---- test_default_tp_io_handler starting IOs\n");
 
                 for (long long i = 0; i < io_to_start && io_failure != true; ++i) {
                     long long offset = (i * TEST_DEFAULT_TP_IO_HANDLER_FILE_IO_SIZE) %
                                        TEST_DEFAULT_TP_IO_HANDLER_FILE_SIZE;
-                    std::unique_ptr<OVERLAPPED> overlapped_ptr{
-                        std::make_unique<OVERLAPPED>()};
-                    overlapped_ptr->hEvent = nullptr;
-                    overlapped_ptr->Offset = ac::get_low_dword(offset);
-                    overlapped_ptr->OffsetHigh = ac::get_high_dword(offset);
+                    //
+                    // Context comes from the io_handler slab, and goes
+                    // back there after completion callback returns
+                    //
+                    auto io_operation{io_handler->start_io_context()};
+                    AC_CODDING_ERROR_IF_NOT(io_operation.is_armed());
+                    io_operation.context()->set_offset(offset);
 
                     total_started_count += 1;
 
-                    auto io_guard{io_handler->start_io()};
-                    AC_CODDING_ERROR_IF_NOT(io_guard.is_armed());
-
                     //
                     // throws on failure; on sucess of pending completion will go through io_handler
                     //
-                    (void) fo.write(&buffer[0],
-                                    static_cast<DWORD>(buffer.size()),
-                                    overlapped_ptr.get());
-                    //
-                    // If we successfully started IO then release ownership of the overlapped pointer.
-                    // io_handler on completion will take over ownership and will delete this structure
+                    (void) fo.write(buffer.data(),
+                                    static_cast<DWORD>(TEST_DEFAULT_TP_IO_HANDLER_FILE_IO_SIZE),
+                                    io_operation.overlapped());
                     //
-                    overlapped_ptr.release();
+                    // we successfully initiated IO so we can disarm IO operation,
+                    // from now on completion owns the context
                     //
-                    // we successfully initiated IO so we can disarm IO guard
-                    //
-                    io_guard.disarm();
+                    io_operation.disarm();
                 }
             }
 
@@ -818,15 +817,19 @@ void test_tp_io_handler() {
                   FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
                   OPEN_ALWAYS,
                   FILE_FLAG_NO_BUFFERING | FILE_FLAG_OVERLAPPED);
+        //
+        // Unbuffered writes need a sector aligned buffer, and it must
+        // outlive io_handler, which waits for pending IOs to complete
+        //
+        ac::io_buffer_pool buffer_pool{{TEST_DEFAULT_TP_IO_HANDLER_FILE_IO_SIZE}};
+        ac::io_buffer buffer{buffer_pool.allocate(TEST_DEFAULT_TP_IO_HANDLER_FILE_IO_SIZE)};
         {
             printf("---- test_tp_io_handler constructing IO handler\n");
 
             ac::tp::io_handler_ptr io_handler{tp->make_io_handler(
                 fo.get_handle(),
                 [&total_completed_count, &total_succeeded_count, &total_failed_count, &total_bytes_transfered, &io_failure](
-                    ac::tp::callback_instance &, OVERLAPPED *overlapped, ULONG error, ULONG_PTR bytes_transferred) {
-                    std::unique_ptr<OVERLAPPED> overlapped_ptr{overlapped};
-
+                    ac::tp::callback_instance &, ac::tp::io_context &context, ULONG error, ULONG_PTR bytes_transferred) {
                     ++total_completed_count;
                     total_bytes_transfered += bytes_transferred;
 
@@ -838,47 +841,39 @@ void test_tp_io_handler() {
                         printf("\n---- !!! test_tp_io_handler IO "
                                "failed !!!"
                                "error. "
-                               "0x%x, bytes transferred %u, overlapped 0x%p\n",
+                               "0x%x, bytes transferred %u, offset %I64u\n",
                                error,
                                static_cast<DWORD>(bytes_transferred),
-                               overlapped);
+                               context.get_offset());
                     }
                 })};
             {
-                ac::cbuffer buffer;
-                buffer.resize(TEST_DEFAULT_TP_IO_HANDLER_FILE_IO_SIZE);
-
                 printf("---- test_tp_io_handler starting IOs\n");
 
                 for (long long i = 0; i < io_to_start && io_failure != true; ++i) {
                     long long offset = (i * TEST_DEFAULT_TP_IO_HANDLER_FILE_IO_SIZE) %
                                        TEST_DEFAULT_TP_IO_HANDLER_FILE_SIZE;
-                    std::unique_ptr<OVERLAPPED> overlapped_ptr{
-                        std::make_unique<OVERLAPPED>()};
-                    overlapped_ptr->hEvent = nullptr;
-                    overlapped_ptr->Offset = ac::get_low_dword(offset);
-                    overlapped_ptr->OffsetHigh = ac::get_high_dword(offset);
+                    //
+                    // Context comes from the io_handler slab, and goes
+                    // back there after completion callback returns
+                    //
+                    auto io_operation{io_handler->start_io_context()};
+                    AC_CODDING_ERROR_IF_NOT(io_operation.is_armed());
+                    io_operation.context()->set_offset(offset);
 
                     total_started_count += 1;
 
-                    auto io_guard{io_handler->start_io()};
-                    AC_CODDING_ERROR_IF_NOT(io_guard.is_armed());
-
                     //
                     // throws on failure; on sucess of pending completion will go through io_handler
                     //
-                    (void) fo.write(&buffer[0],
-                                    static_cast<DWORD>(buffer.size()),
-                                    overlapped_ptr.get());
-                    //
-                    // If we successfully started IO then release ownership of the overlapped pointer.
-                    // io_handler on completion will take over ownership and will delete this structure
+                    (void) fo.write(buffer.data(),
+                                    static_cast<DWORD>(TEST_DEFAULT_TP_IO_HANDLER_FILE_IO_SIZE),
+                                    io_operation.overlapped());
                     //
-                    overlapped_ptr.release();
+                    // we successfully initiated IO so we can disarm IO operation,
+                    // from now on completion owns the context
                     //
-                    // we successfully initiated IO so we can disarm IO guard
-                    //
-                    io_guard.disarm();
+                    io_operation.disarm();
                 }
             }
 
@@ -899,3 +894,207 @@ void test_tp_io_handler() {
     }
     printf("---- test_tp_io_handler complete\n");
 }
+
+void test_tp_join_async() {
+    printf("\n---- test_tp_join_async started\n");
+
+    try {
+        auto tp{ac::tp::make_thread_pool(16, 8)};
+
+        constexpr int sessions_count{256};
+        constexpr int work_items_per_session{64};
+        std::atomic<int> executed_count{0};
+        std::atomic<int> completed_sessions{0};
+        ac::event all_sessions_complete{ac::event::manuel, ac::event::unsignaled};
+
+        std::vector<std::unique_ptr<ac::slim_rundown>> sessions;
+        for (int i = 0; i < sessions_count; ++i) {
+            sessions.push_back(std::make_unique<ac::slim_rundown>());
+        }
+
+        for (auto &session : sessions) {
+            for (int i = 0; i < work_items_per_session; ++i) {
+                tp->submit_work([&executed_count,
+                                 rundown_guard = std::move(ac::slim_rundown_lock{session.get()})](
+                                    ac::tp::callback_instance &instance) {
+                    executed_count.fetch_add(1);
+                });
+            }
+            //
+            // Nobody waits for the session, continuation is posted
+            // to the pool when the last work item releases rundown
+            //
+            tp->join_async(*session,
+                           [&session,
+                            &completed_sessions,
+                            &all_sessions_complete](ac::tp::callback_instance &instance) {
+                               AC_CODDING_ERROR_IF_NOT(session->is_rundown_complete());
+                               if (sessions_count == completed_sessions.fetch_add(1) + 1) {
+                                   all_sessions_complete.set();
+                               }
+                           });
+        }
+
+        printf("---- test_tp_join_async waiting to complete\n");
+
+        AC_CODDING_ERROR_IF_NOT(ERROR_SUCCESS == all_sessions_complete.wait());
+
+        printf("---- test_tp_join_async validating\n");
+
+        AC_CODDING_ERROR_IF_NOT(executed_count == sessions_count * work_items_per_session);
+        AC_CODDING_ERROR_IF_NOT(completed_sessions == sessions_count);
+    } catch (std::exception const &ex) {
+        printf("---- test_tp_join_async failed %s\n", ex.what());
+    }
+    printf("---- test_tp_join_async complete\n");
+}
+
+#define TEST_SEQUENTIAL_READER_FILE_NAME L"sequential_reader.tst"
+#define TEST_SEQUENTIAL_READER_BLOCK_SIZE 4096
+
+namespace {
+    //
+    // Every block starts with its index, so a chunk handed out of
+    // order or from a wrong offset is noticed
+    //
+    void create_sequential_reader_test_file(unsigned blocks_count) {
+        ac::file_object fo;
+        fo.create(TEST_SEQUENTIAL_READER_FILE_NAME,
+                  GENERIC_READ | GENERIC_WRITE,
+                  FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+                  CREATE_ALWAYS);
+        std::vector<char> blocks(256 * TEST_SEQUENTIAL_READER_BLOCK_SIZE);
+        for (unsigned i = 0; i < blocks_count;) {
+            DWORD size{0};
+            for (; size < blocks.size() && i < blocks_count; size += TEST_SEQUENTIAL_READER_BLOCK_SIZE, ++i) {
+                memcpy(blocks.data() + size, &i, sizeof(i));
+            }
+            AC_CODDING_ERROR_IF_NOT(size == fo.write(blocks.data(), size));
+        }
+    }
+
+    ac::file_object open_sequential_reader_test_file() {
+        //
+        // Every reader binds the handle to its thread pool, so each one
+        // needs its own handle
+        //
+        return ac::file_object{TEST_SEQUENTIAL_READER_FILE_NAME,
+                               GENERIC_READ,
+                               FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+                               OPEN_EXISTING,
+                               FILE_FLAG_NO_BUFFERING | FILE_FLAG_OVERLAPPED};
+    }
+} // namespace
+
+void test_sequential_reader() {
+    printf("\n---- test_sequential_reader started\n");
+
+    try {
+        //
+        // File size is not a multiple of chunk size, so last chunk
+        // is short
+        //
+        constexpr unsigned blocks_count{2600};
+        constexpr DWORD chunk_size{64 * TEST_SEQUENTIAL_READER_BLOCK_SIZE};
+
+        ac::scoped_file_delete scoped_delete{TEST_SEQUENTIAL_READER_FILE_NAME};
+        create_sequential_reader_test_file(blocks_count);
+
+        auto tp{ac::tp::make_thread_pool(16, 8)};
+
+        for (ac::tp::thread_pool *pool : {static_cast<ac::tp::thread_pool *>(nullptr), tp.get()}) {
+            ac::file_object fo{open_sequential_reader_test_file()};
+            ac::sequential_reader reader{fo, chunk_size, 8, pool};
+            AC_CODDING_ERROR_IF_NOT(ULONGLONG{blocks_count} * TEST_SEQUENTIAL_READER_BLOCK_SIZE ==
+                                    reader.file_size());
+
+            ULONGLONG expected_offset{0};
+            unsigned chunks_count{0};
+            reader.read_all([&expected_offset, &chunks_count](ac::sequential_reader::chunk const &c) {
+                AC_CODDING_ERROR_IF_NOT(expected_offset == c.offset);
+                AC_CODDING_ERROR_IF_NOT(0 == reinterpret_cast<uintptr_t>(c.data()) % TEST_SEQUENTIAL_READER_BLOCK_SIZE);
+                AC_CODDING_ERROR_IF_NOT(0 == c.size % TEST_SEQUENTIAL_READER_BLOCK_SIZE);
+                for (DWORD offset = 0; offset < c.size; offset += TEST_SEQUENTIAL_READER_BLOCK_SIZE) {
+                    unsigned index{0};
+                    memcpy(&index, c.data() + offset, sizeof(index));
+                    AC_CODDING_ERROR_IF_NOT((expected_offset + offset) / TEST_SEQUENTIAL_READER_BLOCK_SIZE == index);
+                }
+                expected_offset += c.size;
+                ++chunks_count;
+            });
+            AC_CODDING_ERROR_IF_NOT(reader.file_size() == expected_offset);
+            AC_CODDING_ERROR_IF_NOT((blocks_count * TEST_SEQUENTIAL_READER_BLOCK_SIZE + chunk_size - 1) / chunk_size ==
+                                    chunks_count);
+            //
+            // Reader at the end keeps returning false
+            //
+            ac::sequential_reader::chunk c;
+            AC_CODDING_ERROR_IF(reader.next(c));
+            AC_CODDING_ERROR_IF(c.buffer);
+
+            printf("---- test_sequential_reader %s pool, chunks %u, reads in flight %u, latency %.0f us\n",
+                   pool ? "custom" : "default",
+                   chunks_count,
+                   reader.reads_in_flight_target(),
+                   reader.average_read_latency().count() * 1e6);
+        }
+    } catch (std::exception const &ex) {
+        printf("---- test_sequential_reader failed %s\n", ex.what());
+    }
+    printf("---- test_sequential_reader complete\n");
+}
+
+void perftest_sequential_reader() {
+    printf("\n---- perftest_sequential_reader started\n");
+
+    try {
+        constexpr unsigned blocks_count{64 * 1024};
+        constexpr DWORD chunk_size{1024 * 1024};
+        double const file_size_mb{blocks_count * TEST_SEQUENTIAL_READER_BLOCK_SIZE / (1024.0 * 1024.0)};
+
+        ac::scoped_file_delete scoped_delete{TEST_SEQUENTIAL_READER_FILE_NAME};
+        create_sequential_reader_test_file(blocks_count);
+
+        {
+            //
+            // One blocking read at a time
+            //
+            ac::file_object fo{open_sequential_reader_test_file()};
+            ac::io_buffer_pool pool{{chunk_size}};
+            ac::io_buffer buffer{pool.allocate(chunk_size)};
+            LONGLONG const file_size{fo.get_size()};
+            auto const start{std::chrono::steady_clock::now()};
+            for (LONGLONG offset = 0; offset < file_size; offset += chunk_size) {
+                bool is_eof{false};
+                static_cast<void>(fo.read_sync(buffer.data(), offset, chunk_size, &is_eof));
+            }
+            double const seconds{
+                std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count()};
+            printf("---- perftest_sequential_reader read_sync %.0f MB/s\n", file_size_mb / seconds);
+        }
+
+        for (uint32_t max_reads_in_flight = 2; max_reads_in_flight <= 32; max_reads_in_flight *= 4) {
+            ac::file_object fo{open_sequential_reader_test_file()};
+            ac::sequential_reader reader{fo, chunk_size, max_reads_in_flight};
+            unsigned long long checksum{0};
+            auto const start{std::chrono::steady_clock::now()};
+            reader.read_all([&checksum](ac::sequential_reader::chunk const &c) {
+                unsigned index{0};
+                memcpy(&index, c.data(), sizeof(index));
+                checksum += index;
+            });
+            double const seconds{
+                std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count()};
+            printf("---- perftest_sequential_reader max reads in flight %u, %.0f MB/s, "
+                   "reads in flight %u, latency %.0f us, checksum %llu\n",
+                   max_reads_in_flight,
+                   file_size_mb / seconds,
+                   reader.reads_in_flight_target(),
+                   reader.average_read_latency().count() * 1e6,
+                   checksum);
+        }
+    } catch (std::exception const &ex) {
+        printf("---- perftest_sequential_reader failed %s\n", ex.what());
+    }
+    printf("---- perftest_sequential_reader complete\n");
+}
@@ -14,5 +14,9 @@ void test_tp_post();
 void test_tp_timer_work_item();
 void test_tp_wait_work_item();
 void test_tp_io_handler();
+void test_tp_join_async();
+
+void test_sequential_reader();
+void perftest_sequential_reader();
 
 #endif //_AC_HELPERS_WIN32_LIBRARY_TEST_DEFAULT_TP_HEADER_
\ No newline at end of file
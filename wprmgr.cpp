@@ -2,6 +2,11 @@
 //
 
 #include "test\ac_test_thread_pool.h"
+#include "test\ac_test_rundown.h"
+#include "test\ac_test_locks.h"
+#include "test\ac_test_queue.h"
+#include "test\ac_test_kernel_object.h"
+#include "test\ac_test_file_object.h"
 
 #include <memory>
 #include <atomic>
@@ -22,6 +27,10 @@ int main() {
     //test_tp_timer_work_item();
     //test_tp_wait_work_item();
     //test_tp_io_handler();
+    //test_tp_join_async();
+
+    //test_sequential_reader();
+    //perftest_sequential_reader();
 
     //test_default_thread_pool_cancelation_group();
     //test_thread_pool_cancelation_group();
@@ -29,5 +38,48 @@ int main() {
     //stresstest_default_thread_pool_cancelation_group();
     //stresstest_thread_pool_cancelation_group();
 
+    //test_wait_on_address();
+    //test_striped_rundown();
+    //stresstest_striped_rundown_join();
+    //test_rundown_batch_lock();
+    //test_rundown_join_async();
+    //test_rundown_tree();
+    //stresstest_rundown_tree_add_child();
+    //test_epoch_domain();
+    //test_rundown_stats();
+    //perftest_rundown_contention();
+
+    //test_parking_lot();
+    //test_srw_lock();
+    //perftest_srw_lock();
+    //test_bravo_lock();
+    //perftest_bravo_lock();
+    //test_condition_variable();
+    //test_lock_profiler();
+    //test_fast_mutex();
+    //perftest_fast_mutex();
+    //test_seqlock();
+
+    //test_mpsc_queue();
+    //test_mpmc_ring();
+    //perftest_queues();
+
+    //test_event();
+    //test_semaphore();
+    //test_mutex();
+    //test_wait_multiple_objects();
+    //test_slim_event();
+    //perftest_slim_event();
+    //test_shared_kernel_object();
+    //perftest_shared_kernel_object();
+
+    //test_file_object();
+    //test_file_object_vectored();
+    //perftest_file_object_reads();
+    //test_mapped_file();
+    //perftest_mapped_file();
+    //test_io_buffer_pool();
+    //perftest_io_buffer_pool();
+
     return 0;
 }